@@ -0,0 +1,144 @@
+#ifndef JSSON_ARENA_HPP
+#define JSSON_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace jsson {
+
+/**
+ * @brief Bump allocator for JSON nodes.
+ *
+ * Values, objects, arrays and their container storage allocate through
+ * allocateNode().  Normally that is the heap; while an ArenaScope is active
+ * on the thread, allocations are carved out of the scope's NodeArena
+ * instead, so a tree built inside the scope is laid out contiguously in
+ * allocation order.
+ *
+ * Arena blocks are reference counted by the nodes living in them and are
+ * freed when the last of those nodes dies, so the arena object itself can
+ * go away as soon as building is finished.  A document that dies as a
+ * whole costs one free per block.
+ */
+class NodeArena {
+public:
+    static constexpr size_t kDefaultBlockSize = 1 << 20;
+
+    explicit NodeArena(size_t blockSize = kDefaultBlockSize) noexcept;
+
+    /** Releases the arena's hold on its current block. */
+    ~NodeArena();
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /**
+     * @brief Carve @p size bytes (8-byte aligned) out of the arena.
+     * @throws std::bad_alloc if a new block cannot be allocated.
+     */
+    void* allocate(size_t size);
+
+    /** @return Bytes handed out so far, headers included. */
+    size_t bytesAllocated() const noexcept { return allocated_; }
+
+    /** @return Number of blocks obtained from the heap so far. */
+    size_t blockCount() const noexcept { return blocks_; }
+
+    /** Block header; public only for the allocation functions below. */
+    struct Block {
+        std::atomic<size_t> live;
+    };
+
+    /** @return The block the last allocate() carved from. */
+    Block* currentBlock() const noexcept { return current_; }
+
+private:
+    void newBlock(size_t minimum);
+
+    size_t blockSize_;
+    Block* current_ = nullptr;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+    size_t allocated_ = 0;
+    size_t blocks_ = 0;
+};
+
+/**
+ * @brief Routes node allocations on this thread into @p arena while alive.
+ *
+ * Scopes nest; the innermost one wins.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(NodeArena& arena) noexcept;
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    /** @return The arena of the innermost scope on this thread, or nullptr. */
+    static NodeArena* current() noexcept;
+
+private:
+    NodeArena* previous_;
+};
+
+/**
+ * @brief Routes node allocations on this thread back to the heap while alive.
+ *
+ * For long-lived nodes built in the middle of an ArenaScope, which would
+ * otherwise keep one of its blocks alive.
+ */
+class HeapScope {
+public:
+    HeapScope() noexcept;
+    ~HeapScope();
+
+    HeapScope(const HeapScope&) = delete;
+    HeapScope& operator=(const HeapScope&) = delete;
+
+private:
+    NodeArena* previous_;
+};
+
+/**
+ * @brief Allocate node storage from the current arena, or the heap.
+ *
+ * Every allocation carries an 8-byte header naming its arena block (or
+ * none), so deallocateNode() needs no other context and may run on any
+ * thread.
+ */
+void* allocateNode(size_t size);
+
+/** Release storage obtained from allocateNode(). */
+void deallocateNode(void* pointer) noexcept;
+
+/**
+ * @brief Standard allocator over allocateNode(), for node containers.
+ *
+ * Stateless: all instances compare equal, since the header on each
+ * allocation tells where it came from.
+ */
+template <typename T>
+struct NodeAllocator {
+    using value_type = T;
+
+    static_assert(alignof(T) <= 8, "node allocations are 8-byte aligned");
+
+    NodeAllocator() noexcept = default;
+    template <typename U>
+    NodeAllocator(const NodeAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(allocateNode(n * sizeof(T))); }
+    void deallocate(T* p, size_t) noexcept { deallocateNode(p); }
+
+    template <typename U>
+    bool operator==(const NodeAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const NodeAllocator<U>&) const noexcept { return false; }
+};
+
+} // namespace jsson
+
+#endif // JSSON_ARENA_HPP
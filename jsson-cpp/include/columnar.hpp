@@ -0,0 +1,174 @@
+#ifndef JSSON_COLUMNAR_HPP
+#define JSSON_COLUMNAR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "io.hpp"
+#include "json_value.hpp"
+#include "ndjson.hpp"
+
+namespace jsson {
+
+/** Value type of one column in a batch. */
+enum class ColumnType : uint8_t {
+    Null = 0,       ///< No values, only missing and null rows.
+    Int64 = 1,
+    Double = 2,     ///< Numbers, at least one of them not an int64.
+    Boolean = 3,
+    String = 4,
+    Json = 5        ///< Mixed types, arrays, empty objects: JSON text.
+};
+
+/** How a column's values are laid out. */
+enum class ColumnEncoding : uint8_t {
+    Plain = 0,      ///< 8-byte numbers after an is-int64 bitmap, packed booleans,
+                    ///< length-prefixed text.
+    Delta = 1,      ///< Int64: zigzag deltas, bit-packed at the widest delta.
+    Dictionary = 2  ///< String: distinct values once, rows as bit-packed indices.
+};
+
+/** @brief Directory entry for one column of the batch last read. */
+struct ColumnInfo {
+    /** JSON Pointer of the leaf within each record. */
+    std::string path;
+    ColumnType type;
+    ColumnEncoding encoding;
+    /** Encoded size of the column, bitmaps included. */
+    size_t bytes;
+};
+
+/**
+ * @brief Writes records as batches of typed columns.
+ *
+ * Every batch of up to batchSize records is transposed by leaf path:
+ * non-empty objects are flattened, so {"user": {"id": 1}} contributes 1
+ * to column "/user/id", while scalars, arrays and empty objects are
+ * leaves.  Each column stores a presence bitmap (is the path there), a
+ * null bitmap and its non-null values, typed from what the batch holds:
+ * integers as bit-packed zigzag deltas, other numbers as 8 bytes (any
+ * int64s among them flagged so they stay exact), booleans as bits,
+ * repetitive strings through a dictionary, anything mixed as JSON text.
+ * Readers decode only the columns they select.
+ *
+ * Layout: magic "JSCB" and a version byte, then per batch the varint
+ * length of the batch, varint row and column counts, the column
+ * directory (path, type, encoding, encoded size) and the column blocks.
+ */
+class ColumnarWriter {
+public:
+    static constexpr size_t kDefaultBatchSize = 4096;
+
+    explicit ColumnarWriter(std::unique_ptr<OutputSink> sink,
+                            size_t batchSize = kDefaultBatchSize);
+
+    /** Flushes and closes; call close() to observe errors. */
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    /** @brief Create @p filename, optionally compressed (see openOutput()). */
+    static std::unique_ptr<ColumnarWriter> open(const std::string& filename,
+                                                Compression format = Compression::None,
+                                                size_t batchSize = kDefaultBatchSize);
+
+    /**
+     * @brief Add @p record to the current batch.
+     *
+     * The record is referenced, not copied, until its batch is written.
+     */
+    void write(const ValuePtr& record);
+
+    /** @brief Encode and write the records buffered so far as one batch. */
+    void flush();
+
+    /** @return Number of records written so far. */
+    size_t count() const noexcept { return count_; }
+
+    /** @brief Flush the last batch and finish the sink. Idempotent. */
+    void close();
+
+private:
+    struct Column;
+
+    void flatten(const JsonValue& value, std::string& path, uint32_t row);
+
+    std::unique_ptr<OutputSink> sink_;
+    size_t batchSize_;
+    std::vector<ValuePtr> records_;
+    std::vector<Column> columns_;
+    std::unordered_map<std::string, size_t> index_;
+    size_t count_ = 0;
+    bool closed_ = false;
+};
+
+/**
+ * @brief Reads what ColumnarWriter wrote, decoding selected columns only.
+ *
+ * Records are rebuilt from the selected columns; paths absent from a
+ * record stay absent, so a selection yields records holding just those
+ * leaves.  A record none of whose selected leaves exist comes back as an
+ * empty object.
+ */
+class ColumnarReader {
+public:
+    explicit ColumnarReader(std::unique_ptr<InputSource> source);
+
+    /** @brief Open @p filename via openInput() (compressed files included). */
+    static ColumnarReader open(const std::string& filename);
+
+    /**
+     * @brief Decode only columns at or below these JSON Pointer paths.
+     *
+     * An empty list (the default) selects every column.
+     */
+    void select(std::vector<std::string> paths);
+
+    /**
+     * @brief Read the next batch.
+     * @param records Receives the batch's records (replacing its contents).
+     * @return false at end of input.
+     * @throws JsonError(InvalidFormat) on malformed input.
+     */
+    bool nextBatch(std::vector<ValuePtr>& records);
+
+    /**
+     * @brief Read the next record.
+     * @return false at end of input.
+     * @throws JsonError(InvalidFormat) on malformed input.
+     */
+    bool next(ValuePtr& record);
+
+    /** @return Directory of the batch last read, all columns included. */
+    const std::vector<ColumnInfo>& columns() const noexcept { return columns_; }
+
+private:
+    bool fill(size_t size);
+    bool selected(const std::string& path) const;
+
+    std::unique_ptr<InputSource> source_;
+    std::string buffer_;
+    size_t pos_ = 0;
+    std::vector<std::string> selection_;
+    std::vector<ColumnInfo> columns_;
+    std::vector<ValuePtr> pending_;
+    size_t next_ = 0;
+};
+
+/**
+ * @brief Stream every record of @p in into @p out.
+ * @return Number of records copied.
+ */
+size_t ndjsonToColumnar(NdjsonReader& in, ColumnarWriter& out);
+
+/** @copydoc ndjsonToColumnar(NdjsonReader&, ColumnarWriter&) */
+size_t columnarToNdjson(ColumnarReader& in, NdjsonWriter& out);
+
+} // namespace jsson
+
+#endif // JSSON_COLUMNAR_HPP
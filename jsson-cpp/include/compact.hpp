@@ -0,0 +1,76 @@
+#ifndef JSSON_COMPACT_HPP
+#define JSSON_COMPACT_HPP
+
+#include <cstddef>
+#include "arena.hpp"
+#include "json_value.hpp"
+
+namespace jsson {
+
+/**
+ * @brief How scattered a tree's nodes are in memory.
+ *
+ * Nodes are visited in depth-first (dump) order and their addresses
+ * compared with the previous node's.
+ */
+struct LayoutStats {
+    /** Number of values visited. */
+    size_t nodes = 0;
+
+    /** Distinct 4 KiB pages holding at least one value. */
+    size_t pages = 0;
+
+    /** Consecutive values (in DFS order) that sit on different pages. */
+    size_t pageSwitches = 0;
+
+    /** Consecutive values where the later one sits at a lower address. */
+    size_t backwardSteps = 0;
+
+    /**
+     * @return Fraction of DFS steps that leave the current page: near 0
+     *         for a packed tree, near 1 when every step misses.
+     */
+    double fragmentation() const noexcept {
+        return nodes > 1 ? static_cast<double>(pageSwitches) / static_cast<double>(nodes - 1) : 0.0;
+    }
+};
+
+/** @brief Result of compact(). */
+struct CompactionReport {
+    LayoutStats before;
+    LayoutStats after;
+
+    /** Arena bytes used by the rebuilt tree. */
+    size_t arenaBytes = 0;
+
+    /** Arena blocks used by the rebuilt tree. */
+    size_t arenaBlocks = 0;
+};
+
+/**
+ * @brief Measure the memory layout of the tree under @p root.
+ */
+LayoutStats analyzeLayout(const JsonValue& root);
+
+/**
+ * @brief Rebuild the tree under @p root into a fresh arena, in DFS order.
+ *
+ * Each value is followed by its container, the container's storage and
+ * then its children, so a traversal walks memory mostly forwards.  Short
+ * strings and object keys live inside the nodes and are packed with
+ * them.  The copy is built completely before it replaces the old tree in
+ * a single move-assignment, so an exception (e.g. std::bad_alloc) leaves
+ * @p root untouched.
+ *
+ * Subtrees that are also referenced from outside the tree are kept as
+ * they are, so every existing ValuePtr still sees the same value.
+ *
+ * @param root      Value to compact in place; it may live anywhere.
+ * @param blockSize Arena block size.
+ * @return Layout statistics before and after.
+ */
+CompactionReport compact(JsonValue& root, size_t blockSize = NodeArena::kDefaultBlockSize);
+
+} // namespace jsson
+
+#endif // JSSON_COMPACT_HPP
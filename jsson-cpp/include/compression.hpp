@@ -0,0 +1,199 @@
+#ifndef JSSON_COMPRESSION_HPP
+#define JSSON_COMPRESSION_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "io.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Detect the compression format from the first bytes of a stream.
+ *
+ * @param magic Leading bytes of the stream.
+ * @param size  Number of bytes available in @p magic (4 is enough).
+ */
+Compression detectCompression(const unsigned char* magic, size_t size) noexcept;
+
+/** @return true if this build can decode and encode @p format. */
+bool compressionSupported(Compression format) noexcept;
+
+/** @return Human-readable name of @p format ("none", "gzip", "zstd"). */
+const char* compressionName(Compression format) noexcept;
+
+/**
+ * @brief Bounded single-producer/single-consumer ring of fixed-size blocks.
+ *
+ * The producer fills the block returned by acquire() and hands it over
+ * with publish(); the consumer reads the block returned by front() and
+ * recycles it with pop().  Both sides block while the ring is full or
+ * empty, which bounds memory to `blocks * blockSize` bytes.
+ */
+class BlockRing {
+public:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    BlockRing(size_t blockSize, size_t blocks);
+
+    size_t blockSize() const noexcept { return blockSize_; }
+
+    /** @return Free block to fill, or nullptr if the ring was closed. */
+    Block* acquire();
+
+    /** Make the block returned by acquire() visible to the consumer. */
+    void publish();
+
+    /** @return Next filled block, or nullptr once closed and drained. */
+    Block* front();
+
+    /** Release the block returned by front() back to the producer. */
+    void pop();
+
+    /**
+     * @brief Close the ring; wakes both sides.
+     * @param error Exception to rethrow on the consumer side, if any.
+     */
+    void close(std::exception_ptr error = nullptr);
+
+    /** Rethrow the producer's error, if one was recorded. */
+    void rethrowIfFailed();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::vector<Block> blocks_;
+    size_t blockSize_;
+    size_t head_ = 0;   // next block to consume
+    size_t count_ = 0;  // filled blocks
+    bool closed_ = false;
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief InputSource that decompresses another source on a worker thread.
+ *
+ * The worker reads compressed bytes from the wrapped source, decodes them
+ * into fixed-size blocks and pushes those through a BlockRing, so
+ * decompression overlaps with whatever parser consumes this source.
+ * Concatenated gzip members and zstd frames are decoded back to back.
+ */
+class DecompressingSource : public InputSource {
+public:
+    static constexpr size_t kDefaultBlockSize = 256 * 1024;
+    static constexpr size_t kDefaultBlocks = 8;
+
+    /**
+     * @param raw       Source of compressed bytes; owned by this object.
+     * @param format    Gzip or Zstd.
+     * @param blockSize Size of each decompressed block.
+     * @param blocks    Number of blocks in the ring.
+     * @throws JsonError(InvalidFormat) if @p format is not supported.
+     */
+    DecompressingSource(std::unique_ptr<InputSource> raw, Compression format,
+                        size_t blockSize = kDefaultBlockSize,
+                        size_t blocks = kDefaultBlocks);
+    ~DecompressingSource() override;
+
+    DecompressingSource(const DecompressingSource&) = delete;
+    DecompressingSource& operator=(const DecompressingSource&) = delete;
+
+    size_t read(char* buf, size_t cap) override;
+
+    /** Decoder interface implemented by each codec backend. */
+    class Decoder;
+
+private:
+    void run();
+
+    std::unique_ptr<InputSource> raw_;
+    std::unique_ptr<Decoder> decoder_;
+    BlockRing ring_;
+    size_t offset_ = 0;  // read position inside the current front block
+    std::thread worker_;
+};
+
+/**
+ * @brief OutputSink that compresses blocks in parallel on worker threads.
+ *
+ * Written bytes are cut into independent blocks; each block is compressed
+ * on its own into a complete gzip member or zstd frame, so a pool of
+ * workers can run concurrently.  Finished blocks are written downstream in
+ * order, which yields a valid multi-member gzip file or multi-frame zstd
+ * stream that any standard decoder reads back as one stream.  At most
+ * `2 * threads` blocks are in flight, which bounds memory use.
+ */
+class CompressingSink : public OutputSink {
+public:
+    static constexpr size_t kDefaultBlockSize = 1024 * 1024;
+
+    /**
+     * @param downstream Receives the compressed bytes; owned by this object.
+     * @param format     Gzip or Zstd.
+     * @param threads    Worker threads (0 = hardware concurrency).
+     * @param level      Codec compression level (0 = codec default).
+     * @param blockSize  Uncompressed bytes per independent block.
+     * @throws JsonError(InvalidFormat) if @p format is not supported.
+     */
+    CompressingSink(std::unique_ptr<OutputSink> downstream, Compression format,
+                    unsigned threads = 0, int level = 0,
+                    size_t blockSize = kDefaultBlockSize);
+    ~CompressingSink() override;
+
+    CompressingSink(const CompressingSink&) = delete;
+    CompressingSink& operator=(const CompressingSink&) = delete;
+
+    void write(const char* data, size_t size) override;
+
+    /** Compress and write out the partial block (ends a member/frame). */
+    void flush() override;
+
+    void close() override;
+
+    /** Encoder interface implemented by each codec backend. */
+    class Encoder;
+
+private:
+    struct Job {
+        std::string input;
+        std::string output;
+        bool done = false;
+    };
+
+    void submit();
+    void writeCompleted(bool wait);
+    void worker();
+    void stopWorkers() noexcept;
+
+    std::unique_ptr<OutputSink> downstream_;
+    Compression format_;
+    int level_;
+    size_t blockSize_;
+    size_t maxInFlight_;
+    std::string current_;
+    bool wroteAny_ = false;
+    bool closed_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable workReady_;
+    std::condition_variable jobDone_;
+    std::deque<std::shared_ptr<Job>> pending_;  // submission order
+    std::deque<std::shared_ptr<Job>> queue_;    // awaiting a worker
+    std::exception_ptr error_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_COMPRESSION_HPP
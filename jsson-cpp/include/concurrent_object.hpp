@@ -0,0 +1,102 @@
+#ifndef JSSON_CONCURRENT_OBJECT_HPP
+#define JSSON_CONCURRENT_OBJECT_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "hashtable.hpp"
+#include "json_value.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Object that many threads read and update at once.
+ *
+ * Members live in a sharded HashTable, so operations on different keys
+ * mostly take different locks and reads share theirs.  Values are
+ * published, not edited: get() hands out a handle to an immutable value,
+ * and writers store a new value (update() builds it from the current one
+ * under the key's lock).  A reader therefore always sees one consistent
+ * version of a member, for as long as it keeps the handle.
+ *
+ * Published values must not be modified afterwards.  Readers copy
+ * handles to any node they reach, so publishing switches every node of the
+ * value's subtree to atomic reference counts (see
+ * ParseOptions::atomicRefCounts); parsing with atomic counts, the
+ * default, makes that walk write nothing.
+ */
+class ConcurrentObject {
+public:
+    /** @param shards Lock shards; 0 picks four per hardware thread. */
+    explicit ConcurrentObject(size_t shards = 0) : table_(shards) {}
+
+    /** Publishes every member of @p object. */
+    explicit ConcurrentObject(const JsonObject& object, size_t shards = 0);
+
+    ConcurrentObject(const ConcurrentObject&) = delete;
+    ConcurrentObject& operator=(const ConcurrentObject&) = delete;
+
+    /** @return The current value of @p key, or a null handle if absent. */
+    ValuePtr get(const std::string& key) const;
+
+    /**
+     * @brief Publish @p value (a null handle meaning JSON null) as the member @p key.
+     * @return true if the key was new.
+     */
+    bool set(const std::string& key, ValuePtr value);
+
+    /** @return true if the member existed. */
+    bool erase(const std::string& key);
+
+    /**
+     * @brief Replace @p key with a value derived from its current one.
+     *
+     * @param fn Called as fn(const JsonValue* current) (nullptr if absent)
+     *           while the key is locked against other writers; returns the
+     *           new ValuePtr, or a null handle to erase the member.  It
+     *           must not access this object.
+     * @return The value now stored (null if erased).
+     */
+    template <typename F>
+    ValuePtr update(const std::string& key, F&& fn) {
+        ValuePtr stored;
+        table_.update(key, [&](ValuePtr* current) -> std::optional<ValuePtr> {
+            ValuePtr next = fn(current ? current->get() : nullptr);
+            if (!next) {
+                return std::nullopt;
+            }
+            publish(next);
+            stored = next;
+            return next;
+        });
+        return stored;
+    }
+
+    /**
+     * @brief Store @p desired only if @p key still holds @p expected
+     *        (a null handle meaning "absent").
+     * @return true if the swap happened.
+     */
+    bool compareAndSet(const std::string& key, const ValuePtr& expected, ValuePtr desired);
+
+    /** @return Number of members (approximate while writers run). */
+    size_t size() const { return table_.size(); }
+
+    /**
+     * @brief Copy the member handles into a plain JsonObject.
+     *
+     * Each member is one consistent version, but members written while the
+     * copy runs may or may not be included.
+     */
+    JsonObject snapshot() const;
+
+private:
+    /* Switch every node reachable from @p value to atomic counts */
+    static void publish(const ValuePtr& value);
+
+    HashTable<std::string, ValuePtr> table_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_CONCURRENT_OBJECT_HPP
@@ -1,9 +1,8 @@
 #ifndef DTOA_HPP
 #define DTOA_HPP
 
+#include <cstddef>
 #include <string>
-#include <sstream>
-#include <iomanip>
 
 namespace jsson {
 
@@ -15,14 +14,27 @@ namespace jsson {
  */
 class Dtoa {
 public:
+    /** Buffer size that fits any toChars() result. */
+    static constexpr size_t kMaxLength = 32;
+
+    /**
+     * @brief Write the shortest text that reads back as exactly @p value.
+     *
+     * Finite values always contain a '.' or an exponent ("1.0", "1e+100"),
+     * so the text parses as a real again rather than as an integer.
+     * Infinities and NaN are written as "inf", "-inf" and "nan".
+     *
+     * @param value  The double to format.
+     * @param buffer At least kMaxLength bytes; not NUL-terminated.
+     * @return Number of bytes written.
+     */
+    static size_t toChars(double value, char* buffer) noexcept;
+
     /**
      * @brief Convert a double to its string representation.
      *
      * @param value The double value to convert.
-     * @return std::string The string representation of the double.
-     *
-     * The conversion uses std::ostringstream with a precision of 15 decimal places,
-     * which matches the typical precision needed for double values.
+     * @return std::string The toChars() text of the double.
      */
     static std::string doubleToString(double value) noexcept;
 };
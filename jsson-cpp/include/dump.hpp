@@ -1,10 +1,15 @@
 #ifndef DUMP_HPP
 #define DUMP_HPP
 
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 #include <ostream>
 #include "json_value.hpp"
+#include "io.hpp"
 
 namespace jsson {
 
@@ -13,6 +18,10 @@ namespace jsson {
  *
  * This class encapsulates the dumping functionality using modern C++
  * idioms: RAII, std::visit, range-based for loops, and const-correctness.
+ *
+ * Strings escape '"', '\\' and every control character, and reals are
+ * written in the shortest form that parses back to the same double (see
+ * Dtoa::toChars), so dumped text reads back as an equal value.
  */
 class JsonDumper {
 public:
@@ -22,7 +31,38 @@ public:
      * @param value The JSON value to dump.
      * @param out   The output stream to write to.
      */
-    void dump(const std::shared_ptr<JsonValue>& value, std::ostream& out) const;
+    void dump(const ValuePtr& value, std::ostream& out) const;
+
+    /**
+     * @brief Dump a JSON value that is not (or not known to be) held by a ValuePtr.
+     *
+     * @param value The JSON value to dump.
+     * @param out   The output stream to write to.
+     */
+    void dump(const JsonValue& value, std::ostream& out) const;
+
+    /**
+     * @brief Dump a JSON value to an output sink.
+     *
+     * Use a CompressingSink (or openOutput() with a compression format) to
+     * write gzip or zstd output compressed on worker threads.
+     *
+     * @param value The JSON value to dump.
+     * @param sink  The sink to write to; it is not flushed or closed.
+     */
+    void dump(const ValuePtr& value, OutputSink& sink) const;
+
+    /**
+     * @brief Write raw bytes as a quoted base64 JSON string.
+     *
+     * The bytes are encoded in fixed-size chunks straight into the stream,
+     * so binary payloads never need a std::string copy of their encoding.
+     *
+     * @param data Bytes to encode.
+     * @param size Number of bytes.
+     * @param out  The output stream to write to.
+     */
+    void dumpBase64(const void* data, size_t size, std::ostream& out) const;
 
 private:
     /**
@@ -32,9 +72,83 @@ private:
     /**
      * @brief Recursively dump a JSON value using the visitor.
      */
-    void dumpValue(const std::shared_ptr<JsonValue>& value, std::ostream& out) const;
+    void dumpValue(const JsonValue& value, std::ostream& out) const;
+};
+
+/**
+ * @brief Pull-based serializer producing JSON text in caller-sized pieces.
+ *
+ * Where JsonDumper pushes a whole document into a stream, a JsonSerializer
+ * hands out the next bytes only when asked, into whatever buffer space is
+ * available (say, what a non-blocking socket accepts).  The traversal
+ * position lives in an explicit stack, so one thread can interleave many
+ * large responses without buffering any of them in full.
+ *
+ * The text is identical to JsonDumper's.  Long strings are escaped a
+ * piece at a time, so the bytes buffered between calls stay within a few
+ * bytes of @p cap.  The serializer keeps the root alive; the document must
+ * not be modified until done() returns true.
+ */
+class JsonSerializer {
+public:
+    /** @param root Document to serialize. */
+    explicit JsonSerializer(ValuePtr root);
+
+    /**
+     * @brief Produce the next piece of output.
+     *
+     * @param buf Receives up to @p cap bytes.
+     * @param cap Space available in @p buf.
+     * @return Bytes written; 0 with @p cap > 0 means the output is complete.
+     */
+    size_t next(char* buf, size_t cap);
+
+    /** @return true once every byte has been handed out. */
+    bool done() const noexcept { return stack_.empty() && pendingPos_ == pending_.size(); }
+
+private:
+    /*
+     * One container, scalar or string on the traversal path.  A string
+     * frame (a value or a member key) writes text from index onwards; the
+     * key of an OrderedObject member is copied into ownedText first.
+     */
+    struct Frame {
+        explicit Frame(const JsonValue* v) : value(v) {}
+
+        const JsonValue* value;
+        bool opened = false;
+        bool first = true;
+        JsonObject::Map::const_iterator it;
+        OrderedObject::iterator ordered;
+        size_t index = 0;
+
+        bool isText = false;
+        bool isKey = false;
+        bool verbatim = false;
+        std::string_view text;
+        std::string ownedText;
+    };
+
+    /* Append the next token, or about @p budget bytes of a string, to pending_ */
+    void step(size_t budget);
+
+    /* Push a frame writing member key @p key, or @p owned when it is not empty */
+    void pushKey(std::string_view key, std::string owned);
+
+    /* Append the next piece of the string in @p frame, popping it once done */
+    void stepText(Frame& frame, size_t budget);
+
+    ValuePtr root_;
+    std::vector<Frame> stack_;
+    std::string pending_;
+    size_t pendingPos_ = 0;
 };
 
+/**
+ * @brief Write @p value to @p out as JSON text.
+ */
+std::ostream& operator<<(std::ostream& out, const JsonValue& value);
+
 } // namespace dump
 
 #endif // DUMP_HPP
\ No newline at end of file
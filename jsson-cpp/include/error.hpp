@@ -27,6 +27,14 @@ enum class JsonErrorCode {
     IndexOutOfRange,
     PrematureEndOfInput,
     EndOfInputExpected,
+    // Resource limits (ParseLimits)
+    InputTooLarge,
+    TooManyNodes,
+    DepthLimitExceeded,
+    StringTooLong,
+    MemoryLimitExceeded,
+    DeadlineExceeded,
+    Cancelled,
     Unknown
 };
 
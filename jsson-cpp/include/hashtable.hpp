@@ -1,6 +1,10 @@
 #ifndef JSSON_CPP_HASHTABLE_HPP
 #define JSSON_CPP_HASHTABLE_HPP
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <optional>
 #include <shared_mutex>
@@ -8,14 +12,26 @@
 /**
  * @brief A thread-safe hash table implementation using modern C++.
  *
- * @tparam K The key type.
- * @tparam V The value type.
+ * Keys are spread over independently locked shards, so threads working on
+ * different keys rarely contend: lookups take a shard's lock shared,
+ * updates take it exclusively.  Operations on one key are linearizable;
+ * whole-table operations (size, clear, forEach) visit the shards one at a
+ * time and are not atomic with respect to concurrent writers.
+ *
+ * @tparam K    The key type.
+ * @tparam V    The value type.
+ * @tparam Hash Hash function for K.
  */
-template <typename K, typename V>
+template <typename K, typename V, typename Hash = std::hash<K>>
 class HashTable {
 public:
-    /** Constructs an empty hash table. */
-    HashTable() = default;
+    /**
+     * Constructs an empty hash table.
+     *
+     * @param shards Number of independently locked shards, rounded up to a
+     *               power of two; 0 picks four per hardware thread.
+     */
+    explicit HashTable(std::size_t shards = 0);
 
     /** Destroys the hash table. */
     ~HashTable() = default;
@@ -42,6 +58,22 @@ public:
      */
     std::optional<V> find(const K& key) const;
 
+    /** Updates a value in place under the key's exclusive lock.
+     *
+     *  @param key The key to update.
+     *  @param fn  Called as fn(V*) with the current value, or nullptr if the
+     *             key is absent; it must not touch this table.  Returns a
+     *             std::optional<V>: a value to store, or nullopt to erase.
+     *  @return true if the key holds a value afterwards.
+     */
+    template <typename F>
+    bool update(const K& key, F&& fn);
+
+    /** Calls fn(key, value) for every element, one shard at a time under
+     *  its shared lock; fn must not touch this table. */
+    template <typename F>
+    void forEach(F&& fn) const;
+
     /** Removes all elements from the table. */
     void clear();
 
@@ -51,9 +83,27 @@ public:
      */
     std::size_t size() const noexcept;
 
+    /** @return The number of shards. */
+    std::size_t shardCount() const noexcept { return shardMask_ + 1; }
+
 private:
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<K, V> map_;
+    // One cache line apart so shard locks do not false-share
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<K, V, Hash> map;
+    };
+
+    Shard& shardFor(const K& key) const;
+
+    /* Lock @p shard, reporting contention to the hashtable_contended probe */
+    std::unique_lock<std::shared_mutex> lockExclusive(Shard& shard) const;
+    std::shared_lock<std::shared_mutex> lockShared(const Shard& shard) const;
+
+    /* Report a rehash of @p shard to the hashtable_resize probe */
+    void noteResize(const Shard& shard, std::size_t buckets) const;
+
+    std::unique_ptr<Shard[]> shards_;
+    std::size_t shardMask_;
 };
 
 #include "hashtable_impl.hpp"
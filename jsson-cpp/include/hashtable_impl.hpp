@@ -0,0 +1,139 @@
+#ifndef JSSON_CPP_HASHTABLE_IMPL_HPP
+#define JSSON_CPP_HASHTABLE_IMPL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "probes.hpp"
+
+template <typename K, typename V, typename Hash>
+HashTable<K, V, Hash>::HashTable(std::size_t shards) {
+    if (shards == 0) {
+        shards = 4 * std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::size_t count = 1;
+    while (count < shards) {
+        count <<= 1;
+    }
+    shards_ = std::make_unique<Shard[]>(count);
+    shardMask_ = count - 1;
+}
+
+template <typename K, typename V, typename Hash>
+typename HashTable<K, V, Hash>::Shard& HashTable<K, V, Hash>::shardFor(const K& key) const {
+    // The maps bucket by the low hash bits; pick shards from mixed high bits
+    std::uint64_t h = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return shards_[static_cast<std::size_t>(h >> 32) & shardMask_];
+}
+
+template <typename K, typename V, typename Hash>
+std::unique_lock<std::shared_mutex> HashTable<K, V, Hash>::lockExclusive(Shard& shard) const {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        JSSON_PROBE2(hashtable_contended, this, static_cast<std::size_t>(&shard - shards_.get()));
+        lock.lock();
+    }
+    return lock;
+}
+
+template <typename K, typename V, typename Hash>
+std::shared_lock<std::shared_mutex> HashTable<K, V, Hash>::lockShared(const Shard& shard) const {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        JSSON_PROBE2(hashtable_contended, this, static_cast<std::size_t>(&shard - shards_.get()));
+        lock.lock();
+    }
+    return lock;
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::noteResize(const Shard& shard, std::size_t buckets) const {
+    if (shard.map.bucket_count() != buckets) {
+        JSSON_PROBE3(hashtable_resize, this, static_cast<std::size_t>(&shard - shards_.get()),
+                     shard.map.bucket_count());
+    }
+}
+
+template <typename K, typename V, typename Hash>
+bool HashTable<K, V, Hash>::insert(const K& key, const V& value) {
+    Shard& shard = shardFor(key);
+    auto lock = lockExclusive(shard);
+    std::size_t buckets = shard.map.bucket_count();
+    bool inserted = shard.map.insert_or_assign(key, value).second;
+    noteResize(shard, buckets);
+    return inserted;
+}
+
+template <typename K, typename V, typename Hash>
+bool HashTable<K, V, Hash>::erase(const K& key) {
+    Shard& shard = shardFor(key);
+    auto lock = lockExclusive(shard);
+    return shard.map.erase(key) > 0;
+}
+
+template <typename K, typename V, typename Hash>
+std::optional<V> HashTable<K, V, Hash>::find(const K& key) const {
+    const Shard& shard = shardFor(key);
+    auto lock = lockShared(shard);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename F>
+bool HashTable<K, V, Hash>::update(const K& key, F&& fn) {
+    Shard& shard = shardFor(key);
+    auto lock = lockExclusive(shard);
+    auto it = shard.map.find(key);
+    std::optional<V> result = fn(it == shard.map.end() ? nullptr : &it->second);
+    if (!result) {
+        if (it != shard.map.end()) {
+            shard.map.erase(it);
+        }
+        return false;
+    }
+    if (it == shard.map.end()) {
+        std::size_t buckets = shard.map.bucket_count();
+        shard.map.emplace(key, std::move(*result));
+        noteResize(shard, buckets);
+    } else {
+        it->second = std::move(*result);
+    }
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename F>
+void HashTable<K, V, Hash>::forEach(F&& fn) const {
+    for (std::size_t i = 0; i <= shardMask_; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+        for (const auto& entry : shards_[i].map) {
+            fn(entry.first, entry.second);
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void HashTable<K, V, Hash>::clear() {
+    for (std::size_t i = 0; i <= shardMask_; ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+        shards_[i].map.clear();
+    }
+}
+
+template <typename K, typename V, typename Hash>
+std::size_t HashTable<K, V, Hash>::size() const noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i <= shardMask_; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+        total += shards_[i].map.size();
+    }
+    return total;
+}
+
+#endif // JSSON_CPP_HASHTABLE_IMPL_HPP
@@ -0,0 +1,224 @@
+#ifndef JSSON_IO_HPP
+#define JSSON_IO_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace jsson {
+
+/** Supported stream compression formats. */
+enum class Compression {
+    None,
+    Gzip,
+    Zstd
+};
+
+/**
+ * @brief Pull-style byte source consumed by the parsers.
+ *
+ * Implementations fill @p buf with up to @p cap bytes and return the number
+ * of bytes written; 0 means end of input.  Errors are reported by throwing
+ * JsonError.
+ */
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    /**
+     * @brief Read up to @p cap bytes into @p buf.
+     * @return Bytes read, 0 at end of input.
+     */
+    virtual size_t read(char* buf, size_t cap) = 0;
+};
+
+/**
+ * @brief InputSource reading a file (or stdin when the name is "-").
+ */
+class FileSource : public InputSource {
+public:
+    /**
+     * @brief Open @p filename for reading.
+     * @throws JsonError(CannotOpenFile) if the file cannot be opened.
+     */
+    explicit FileSource(const std::string& filename);
+    ~FileSource() override;
+
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+
+    size_t read(char* buf, size_t cap) override;
+
+private:
+    std::FILE* file_;
+    bool owned_;
+};
+
+/**
+ * @brief InputSource over a caller-owned memory range.
+ */
+class MemorySource : public InputSource {
+public:
+    MemorySource(const char* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    size_t read(char* buf, size_t cap) override;
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+/**
+ * @brief Open @p filename, transparently decompressing it if needed.
+ *
+ * The compression format is detected from the leading magic bytes (gzip or
+ * zstd); plain files are returned as a FileSource.  Compressed files are
+ * wrapped in a DecompressingSource, which decompresses on its own thread.
+ *
+ * @throws JsonError(CannotOpenFile) if the file cannot be opened.
+ * @throws JsonError(InvalidFormat) if the file is compressed with a codec
+ *         this build does not support.
+ */
+std::unique_ptr<InputSource> openInput(const std::string& filename);
+
+/**
+ * @brief Push-style byte sink used by the dumpers and writers.
+ *
+ * close() flushes everything still buffered and must be called before the
+ * sink is destroyed if errors are to be observed; the destructor closes
+ * silently.
+ */
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    /** Write @p size bytes from @p data. */
+    virtual void write(const char* data, size_t size) = 0;
+
+    /** Push buffered bytes downstream (does not end compressed streams). */
+    virtual void flush() {}
+
+    /** Flush and finish the output. Idempotent. */
+    virtual void close() { flush(); }
+};
+
+/**
+ * @brief OutputSink writing a file (or stdout when the name is "-").
+ */
+class FileSink : public OutputSink {
+public:
+    /**
+     * @brief Create or truncate @p filename.
+     * @throws JsonError(CannotOpenFile) if the file cannot be opened.
+     */
+    explicit FileSink(const std::string& filename);
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    void close() override;
+
+private:
+    std::FILE* file_;
+    bool owned_;
+};
+
+/**
+ * @brief std::streambuf forwarding to an OutputSink.
+ *
+ * Lets the std::ostream based JsonDumper write into any sink, including
+ * compressing ones.
+ */
+class SinkStreamBuf : public std::streambuf {
+public:
+    explicit SinkStreamBuf(OutputSink& sink, size_t bufferSize = 64 * 1024);
+    ~SinkStreamBuf() override;
+
+    /**
+     * @brief Hand buffered bytes to the sink without flushing the sink.
+     *
+     * Unlike sync(), this does not end a compressed block, so it is cheap
+     * to call after every record.
+     */
+    void commit() { drain(); }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize size) override;
+    int sync() override;
+
+private:
+    void drain();
+
+    OutputSink& sink_;
+    std::unique_ptr<char[]> buffer_;
+    size_t bufferSize_;
+};
+
+/**
+ * @brief std::ostream over an OutputSink.
+ */
+class SinkStream : public std::ostream {
+public:
+    explicit SinkStream(OutputSink& sink) : std::ostream(nullptr), buf_(sink) { rdbuf(&buf_); }
+
+    /** @see SinkStreamBuf::commit() */
+    void commit() { buf_.commit(); }
+
+private:
+    SinkStreamBuf buf_;
+};
+
+/**
+ * @brief Create @p filename for writing, optionally compressed.
+ *
+ * @param filename Output path ("-" for stdout).
+ * @param format   Compression to apply.
+ * @param threads  Compression worker threads (0 = hardware concurrency).
+ * @throws JsonError(CannotOpenFile) if the file cannot be created.
+ * @throws JsonError(InvalidFormat) if @p format is not supported.
+ */
+std::unique_ptr<OutputSink> openOutput(const std::string& filename,
+                                       Compression format = Compression::None,
+                                       unsigned threads = 0);
+
+/**
+ * @brief Names for temporary files, removed when this object dies.
+ *
+ * Names are unique per instance, so concurrent users can share a
+ * directory.  Files are created by whoever opens the returned paths.
+ */
+class ScratchFiles {
+public:
+    /** @param dir Directory for the files; empty uses the system temporary directory. */
+    explicit ScratchFiles(const std::string& dir, const std::string& prefix = "jsson");
+
+    /** Removes every file still tracked. */
+    ~ScratchFiles();
+
+    ScratchFiles(const ScratchFiles&) = delete;
+    ScratchFiles& operator=(const ScratchFiles&) = delete;
+
+    /** @return A fresh path, tracked until remove() or destruction. */
+    std::string create();
+
+    /** @brief Delete @p path now and stop tracking it. */
+    void remove(const std::string& path);
+
+private:
+    std::string base_;
+    size_t next_ = 0;
+    std::vector<std::string> live_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_IO_HPP
@@ -0,0 +1,73 @@
+#ifndef JSSON_JOIN_HPP
+#define JSSON_JOIN_HPP
+
+#include <cstddef>
+#include <string>
+#include "json_pointer.hpp"
+#include "ndjson.hpp"
+
+namespace jsson {
+
+/** Which probe records hashJoin() emits. */
+enum class JoinType {
+    Inner,  ///< Only probe records with at least one match.
+    Left    ///< Every probe record; unmatched ones are copied unchanged.
+};
+
+/** @brief Tuning for hashJoin(). */
+struct JoinOptions {
+    JoinType type = JoinType::Inner;
+
+    /**
+     * Bytes of build records (plus index overhead) held in memory.  A
+     * larger build side is hash-partitioned to scratch files first.
+     */
+    size_t memoryLimit = size_t(256) << 20;
+
+    /** Directory for partition files; empty uses the system temporary directory. */
+    std::string scratchDir;
+
+    /** Probe and key extraction threads; 0 uses one per hardware thread. */
+    unsigned threads = 0;
+};
+
+/**
+ * @brief Join every record of @p probe with the @p build records sharing its key.
+ *
+ * The build side (the smaller input) is read into a HashTable from join
+ * key to its records, which are kept as raw line bytes and parsed only
+ * when they match.  The probe side is then streamed in batches, parsed
+ * and matched on worker threads, and written in input order.  Each match
+ * yields the probe object with the build object's members added; members
+ * the probe record already has keep the probe's value.  A record matching
+ * several build records is emitted once per match, in build order.  The
+ * joined record is spliced from the two input lines, probe members first,
+ * so every member keeps its exact input text.
+ *
+ * Keys match when they are equal values: 1 and 1.0 match, 1 and "1" do
+ * not, and objects match regardless of member order.  Records whose key
+ * is missing or null never match.
+ *
+ * If the build side outgrows options.memoryLimit, both inputs are hash
+ * partitioned by key into scratch files and each partition pair is joined
+ * in turn (grace hash join), repartitioning with a new hash if one is
+ * still too large.  Output is then grouped by partition rather than in
+ * probe order.  Scratch files are removed on return, including when an
+ * exception is thrown.
+ *
+ * @param build    Smaller input, indexed in memory.
+ * @param buildKey Pointer to the join key inside build records.
+ * @param probe    Larger input, streamed.
+ * @param probeKey Pointer to the join key inside probe records.
+ * @param out      Receives the joined records.
+ * @return Number of records written.
+ * @throws JsonError on malformed records, with their line number, and
+ *         WrongType when a matched record is not an object.
+ */
+size_t hashJoin(NdjsonReader& build, const JsonPointer& buildKey,
+                NdjsonReader& probe, const JsonPointer& probeKey,
+                NdjsonWriter& out, const JoinOptions& options = JoinOptions());
+
+} // namespace jsson
+
+#endif // JSSON_JOIN_HPP
@@ -0,0 +1,70 @@
+#ifndef JSSON_JSON_POINTER_HPP
+#define JSSON_JSON_POINTER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "json_value.hpp"
+
+namespace jsson {
+
+/**
+ * @brief RFC 6901 JSON Pointer, e.g. "/user/address/zip" or "/items/0".
+ *
+ * The text is split and unescaped ("~1" is '/', "~0" is '~') once when
+ * the pointer is built, and array indices are pre-parsed, so resolving the
+ * same pointer against many values costs one lookup per reference token.
+ */
+class JsonPointer {
+public:
+    /** @brief One reference token. */
+    struct Token {
+        std::string key;
+        /** Array index, or npos if the token is not a valid index. */
+        size_t index;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /** The empty pointer, referring to the whole document. */
+    JsonPointer() = default;
+
+    /**
+     * @brief Parse a pointer.
+     * @throws JsonError(InvalidFormat) if @p text is non-empty and does not
+     *         start with '/', or contains a '~' not followed by '0' or '1'.
+     */
+    explicit JsonPointer(std::string_view text);
+
+    /**
+     * @brief Find the value the pointer refers to.
+     * @return The value, or nullptr if some token does not match.
+     */
+    const JsonValue* resolve(const JsonValue& root) const noexcept;
+
+    /** @copydoc resolve(const JsonValue&) const */
+    JsonValue* resolve(JsonValue& root) const noexcept;
+
+    /** @return The reference tokens, unescaped. */
+    const std::vector<Token>& tokens() const noexcept { return tokens_; }
+
+    /** @return true for the pointer to the whole document. */
+    bool empty() const noexcept { return tokens_.empty(); }
+
+    /** @return The pointer without its last token (the empty pointer stays empty). */
+    JsonPointer parent() const;
+
+    /** @return The pointer extended by the unescaped token @p key. */
+    JsonPointer child(std::string_view key) const;
+
+    /** @return The pointer in its escaped text form. */
+    std::string toString() const;
+
+private:
+    std::vector<Token> tokens_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_JSON_POINTER_HPP
@@ -9,12 +9,21 @@
 #include <sstream>
 #include <stdexcept>
 #include <optional>
+#include "arena.hpp"
+#include "raw_string.hpp"
+#include "ref.hpp"
+#include "string_dictionary.hpp"
 
 namespace jsson {
 
 /* Forward declarations */
+class JsonValue;
 class JsonObject;
 class JsonArray;
+class OrderedObject;
+
+/** Owning handle to a JsonValue (intrusively reference counted). */
+using ValuePtr = Ref<JsonValue>;
 
 /**
  * @brief Class representing any JSON value (object, array, number, string, etc.).
@@ -22,6 +31,9 @@ class JsonArray;
  * This class encapsulates a JSON value using a `std::variant` that can hold
  * concrete types: object, array, number, string, boolean, or null.
  * Composite values (objects and arrays) are stored via `std::unique_ptr`.
+ *
+ * Values are shared through ValuePtr handles whose reference count lives
+ * in the value itself (see RefCount).
  */
 class JsonValue {
 public:
@@ -60,24 +72,42 @@ public:
     // String (move)
     explicit JsonValue(std::string&& value) : type_(Type::String), data_(std::move(value)) {}
 
+    // String (dictionary entry)
+    explicit JsonValue(InternedString value) : type_(Type::String), data_(std::move(value)) {}
+
+    // String (escaped input form, unescaped on demand)
+    explicit JsonValue(RawString value) : type_(Type::String), data_(std::move(value)) {}
+
     // Object (copy)
     explicit JsonValue(const JsonObject& object) : type_(Type::Object), data_(std::make_unique<JsonObject>(object)) {}
 
     // Object (move)
     explicit JsonValue(JsonObject&& object) : type_(Type::Object), data_(std::make_unique<JsonObject>(std::move(const_cast<JsonObject&>(object)))) {}
 
+    // Object ordered by key (copy)
+    explicit JsonValue(const OrderedObject& object);
+
+    // Object ordered by key (move)
+    explicit JsonValue(OrderedObject&& object);
+
     // Array (copy)
     explicit JsonValue(const JsonArray& array) : type_(Type::Array), data_(std::make_unique<JsonArray>(array)) {}
 
     // Array (move)
     explicit JsonValue(JsonArray&& array) : type_(Type::Array), data_(std::make_unique<JsonArray>(std::move(const_cast<JsonArray&>(array)))) {}
 
-    // Copy / Move (defaulted)
-    JsonValue(const JsonValue&) = default;
+    // Copy: objects and arrays get their own container, sharing the children
+    JsonValue(const JsonValue& other);
+    JsonValue& operator=(const JsonValue& other);
+
+    // Move (defaulted; the reference count is never transferred)
     JsonValue(JsonValue&&) = default;
-    JsonValue& operator=(const JsonValue&) = default;
     JsonValue& operator=(JsonValue&&) = default;
 
+    // Node storage comes from the thread's current arena, if any (see ArenaScope)
+    static void* operator new(size_t size) { return allocateNode(size); }
+    static void operator delete(void* pointer) noexcept { deallocateNode(pointer); }
+
     /*=====================================================================
      *  Type Inquiry
      *====================================================================*/
@@ -119,30 +149,111 @@ public:
     /** @return Const reference to the contained array. Throws if not an array. */
     std::reference_wrapper<const JsonArray>& asArray() const;
 
+    /** @return true if the value is an object stored as an OrderedObject. */
+    bool isOrderedObject() const noexcept {
+        return std::holds_alternative<std::unique_ptr<OrderedObject>>(data_);
+    }
+
+    /** @return The contained ordered object. Throws if not an OrderedObject. */
+    OrderedObject& asOrderedObject();
+
+    /** @return The contained ordered object (const). Throws if not an OrderedObject. */
+    const OrderedObject& asOrderedObject() const;
+
     /** @return The boolean value. Throws if not a boolean. */
     bool asBoolean() const;
 
     /** @return The double value. Throws if not a number. */
     double asNumber() const;
 
-    /** @return Reference to the underlying string. Throws if not a string. */
+    /**
+     * @return Reference to the underlying string. Throws if not a string.
+     *
+     * A string parsed with ParseOptions::lazyStrings is unescaped on the
+     * first call and the result kept.
+     */
     const std::string& asString() const;
 
-    /** @return Reference to the underlying string (non‑const). Throws if not a string. */
+    /**
+     * @return Reference to the underlying string (non‑const). Throws if not a string.
+     *
+     * An interned or lazily parsed string is first copied into an owned
+     * string, so writes through the reference never touch shared storage.
+     */
     std::string& asString();
 
+    /**
+     * @return View of the string's characters.  Unlike asString() this
+     *         never materializes a lazily parsed string that has no escapes.
+     *         Throws if not a string.
+     */
+    std::string_view asStringView() const;
+
+    /** @return true if the value is a string stored in a StringDictionary. */
+    bool isInterned() const noexcept {
+        return std::holds_alternative<InternedString>(data_);
+    }
+
+    /** @return true if the value is a string still in its escaped input form. */
+    bool isRawString() const noexcept {
+        return std::holds_alternative<RawString>(data_);
+    }
+
+    /**
+     * @brief Compare two string values.
+     *
+     * Interned strings sharing a dictionary entry compare by pointer, and
+     * lazily parsed strings compare their escaped forms where that decides
+     * the answer; everything else falls back to comparing characters.
+     * Returns false if either value is not a string.
+     */
+    bool stringEquals(const JsonValue& other) const;
+
+    /** @brief Compare a string value with @p text (false if not a string). */
+    bool stringEquals(std::string_view text) const;
+
+    /**
+     * @brief Decode a base64 string value into raw bytes, in place.
+     *
+     * The decoded bytes overwrite the string's own buffer (base64 only ever
+     * shrinks) and the string is truncated to them, so no second buffer is
+     * allocated.  Afterwards asString() holds the binary payload.
+     *
+     * @return Number of decoded bytes.
+     * @throws JsonError(WrongType) if the value is not a string.
+     * @throws JsonError(InvalidFormat) if it is not valid base64; the value
+     *         is left unchanged in that case.
+     */
+    size_t decodeBase64InPlace();
+
     /**
      * @brief Convert the JSON value to its string representation.
      * @return A string containing the JSON representation.
      */
     std::string toString() const;
 
+    /**
+     * @brief Choose atomic or plain reference counting for this value.
+     *
+     * Plain counts avoid locked instructions but must only be used while
+     * handles to the value stay on one thread.  The default comes from
+     * JSSON_ATOMIC_REFCOUNT; the parser sets it per document from
+     * ParseOptions::atomicRefCounts.
+     */
+    void setAtomicRefCount(bool atomic) noexcept { refs_.setAtomic(atomic); }
+
+    /** @return true if this value's reference count is atomic. */
+    bool hasAtomicRefCount() const noexcept { return refs_.isAtomic(); }
+
+    /** Storage for every alternative a value can hold. */
+    using Data = std::variant<std::monostate, bool, double, int64_t, std::string,
+                              std::unique_ptr<JsonObject>, std::unique_ptr<JsonArray>,
+                              InternedString, RawString, std::unique_ptr<OrderedObject>>;
+
     /**
      * @brief Access the underlying variant (for dumping).
      */
-    const std::variant<std::monostate, bool, double, int64_t, std::string,
-                       std::unique_ptr<JsonObject>, std::unique_ptr<JsonArray>>&
-                       raw_variant() const noexcept {
+    const Data& raw_variant() const noexcept {
         return data_;
     }
 
@@ -155,15 +266,18 @@ public:
     JsonValue& operator=(int64_t value);
     JsonValue& operator=(const std::string& value);
     JsonValue& operator=(std::string&& value);
+    JsonValue& operator=(InternedString value);
     JsonValue& operator=(const JsonObject& object);
     JsonValue& operator=(JsonObject&& object);
     JsonValue& operator=(const JsonArray& array);
     JsonValue& operator=(JsonArray&& array);
 
 private:
+    template <typename> friend class Ref;
+
+    RefCount refs_;
     Type type_;
-    std::variant<std::monostate, bool, double, int64_t, std::string,
-                 std::unique_ptr<JsonObject>, std::unique_ptr<JsonArray>> data_;
+    Data data_;
 };
 
 /*=====================================================================
@@ -172,10 +286,15 @@ private:
 
 class JsonObject {
 public:
-    using Map = std::unordered_map<std::string, std::shared_ptr<JsonValue>>;
+    using Map = std::unordered_map<std::string, ValuePtr, std::hash<std::string>,
+                                   std::equal_to<std::string>,
+                                   NodeAllocator<std::pair<const std::string, ValuePtr>>>;
 
     JsonObject() = default;
 
+    static void* operator new(size_t size) { return allocateNode(size); }
+    static void operator delete(void* pointer) noexcept { deallocateNode(pointer); }
+
     explicit JsonObject(const Map& map)
         : data_(map) {}
 
@@ -187,7 +306,7 @@ public:
         for (const auto& [key, value] : init) {
             data_.emplace(
                 key,
-                std::make_shared<JsonValue>(value)
+                makeRef<JsonValue>(value)
             );
         }
     }
@@ -196,7 +315,7 @@ public:
     JsonValue& operator[](const std::string& key) {
         auto& ptr = data_[key];
         if (!ptr) {
-            ptr = std::make_shared<JsonValue>();
+            ptr = makeRef<JsonValue>();
         }
         return *ptr;
     }
@@ -217,17 +336,17 @@ public:
 
     /** Insert helpers */
     void insert(const std::string& key, const JsonValue& value) {
-        data_[key] = std::make_shared<JsonValue>(value);
+        data_[key] = makeRef<JsonValue>(value);
     }
 
     void insert(std::string&& key, JsonValue&& value) {
         data_[std::move(key)] =
-            std::make_shared<JsonValue>(std::move(value));
+            makeRef<JsonValue>(std::move(value));
     }
 
     template <typename... Args>
     JsonValue& emplace(const std::string& key, Args&&... args) {
-        auto ptr = std::make_shared<JsonValue>(
+        auto ptr = makeRef<JsonValue>(
             std::forward<Args>(args)...
         );
         data_[key] = ptr;
@@ -276,10 +395,13 @@ private:
 
 class JsonArray {
 public:
-    using Vec = std::vector<std::shared_ptr<JsonValue>>;
+    using Vec = std::vector<ValuePtr, NodeAllocator<ValuePtr>>;
 
     JsonArray() = default;
 
+    static void* operator new(size_t size) { return allocateNode(size); }
+    static void operator delete(void* pointer) noexcept { deallocateNode(pointer); }
+
     explicit JsonArray(Vec&& vec)
         : data_(std::move(vec)) {}
 
@@ -287,7 +409,7 @@ public:
     JsonArray(std::initializer_list<JsonValue> init) {
         data_.reserve(init.size());
         for (const auto& v : init) {
-            data_.push_back(std::make_shared<JsonValue>(v));
+            data_.push_back(makeRef<JsonValue>(v));
         }
     }
 
@@ -312,17 +434,17 @@ public:
 
     /** Add elements */
     void push_back(const JsonValue& value) {
-        data_.push_back(std::make_shared<JsonValue>(value));
+        data_.push_back(makeRef<JsonValue>(value));
     }
 
     void push_back(JsonValue&& value) {
-        data_.push_back(std::make_shared<JsonValue>(std::move(value)));
+        data_.push_back(makeRef<JsonValue>(std::move(value)));
     }
 
     template <typename... Args>
     JsonValue& emplace_back(Args&&... args) {
         data_.push_back(
-            std::make_shared<JsonValue>(std::forward<Args>(args)...)
+            makeRef<JsonValue>(std::forward<Args>(args)...)
         );
         return *data_.back();
     }
@@ -352,6 +474,150 @@ private:
     Vec data_;
 };
 
+/*=====================================================================
+ *  OrderedObject Declaration
+ *====================================================================*/
+
+/**
+ * @brief Object storage kept sorted by key, for objects with very many members.
+ *
+ * A B+-tree whose leaves hold up to 64 members.  Each leaf stores the
+ * prefix its keys share once and packs the remaining key suffixes into
+ * one buffer, so maps keyed by ids such as "user:0001234" take little
+ * more than the distinct tail of each key.  Unlike JsonObject it never
+ * rehashes, iterates (and dumps) in key order, and answers lower_bound,
+ * range and prefix queries, plus cursor-based paging for listing APIs.
+ *
+ * Inserting may invalidate iterators; erasing never merges leaves, so a
+ * map that shrank a lot is best rebuilt by copying it.
+ */
+class OrderedObject {
+    struct Node;
+    struct Leaf;
+    struct Inner;
+
+public:
+    /** Forward iterator over members in key order. */
+    class iterator {
+    public:
+        iterator() = default;
+
+        /** @return The member's key; valid until the iterator changes. */
+        std::string_view key() const;
+
+        /** @return The member's value handle. */
+        ValuePtr& value() const;
+
+        iterator& operator++();
+
+        bool operator==(const iterator& other) const noexcept {
+            return leaf_ == other.leaf_ && index_ == other.index_;
+        }
+        bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class OrderedObject;
+        iterator(Leaf* leaf, size_t index);
+
+        Leaf* leaf_ = nullptr;
+        size_t index_ = 0;
+        mutable std::string key_;
+    };
+
+    /** A half-open [begin, end) run of members. */
+    struct Range {
+        iterator first;
+        iterator last;
+
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+    };
+
+    /** One page of a paged listing (see listPage()). */
+    struct Page {
+        std::vector<std::pair<std::string, ValuePtr>> entries;
+        /** Pass as @p after to fetch the following page; empty after the last page. */
+        std::optional<std::string> next;
+    };
+
+    OrderedObject();
+    ~OrderedObject();
+
+    /** Copies the member handles (values are shared, as with JsonObject). */
+    OrderedObject(const OrderedObject& other);
+    OrderedObject& operator=(const OrderedObject& other);
+    OrderedObject(OrderedObject&& other) noexcept;
+    OrderedObject& operator=(OrderedObject&& other) noexcept;
+
+    /** Takes over the members of @p object. */
+    explicit OrderedObject(JsonObject&& object);
+
+    static void* operator new(size_t size) { return allocateNode(size); }
+    static void operator delete(void* pointer) noexcept { deallocateNode(pointer); }
+
+    /**
+     * @brief Insert or replace the member @p key.
+     * @return true if the key was new.
+     */
+    bool insert(std::string_view key, ValuePtr value);
+
+    /** Access (inserts a null member if missing) */
+    JsonValue& operator[](std::string_view key);
+
+    /** @return The member's handle, or nullptr if absent. */
+    const ValuePtr* find(std::string_view key) const;
+
+    /** Bounds-checked access; throws JsonError(ItemNotFound) if missing. */
+    JsonValue& at(std::string_view key);
+    const JsonValue& at(std::string_view key) const;
+
+    bool contains(std::string_view key) const { return find(key) != nullptr; }
+
+    /** @return true if a member was removed. */
+    bool erase(std::string_view key);
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    iterator begin() const;
+    iterator end() const { return iterator(); }
+
+    /** @return First member whose key is not less than @p key. */
+    iterator lower_bound(std::string_view key) const;
+
+    /** @return First member whose key is greater than @p key. */
+    iterator upper_bound(std::string_view key) const;
+
+    /** @return Members with keys in [@p from, @p to). */
+    Range range(std::string_view from, std::string_view to) const;
+
+    /** @return Members whose keys start with @p prefix. */
+    Range prefix(std::string_view prefix) const;
+
+    /**
+     * @brief List members page by page, in key order.
+     *
+     * @param after  Cursor from the previous Page::next, or nullopt for the
+     *               first page.  Stays valid across inserts and erases.
+     * @param limit  Maximum members per page.
+     * @param prefix Only list keys starting with this.
+     */
+    Page listPage(std::optional<std::string_view> after, size_t limit,
+                  std::string_view prefix = {}) const;
+
+private:
+    Leaf* findLeaf(std::string_view key) const;
+
+    // Insert below @p node; returns the right half if @p node had to split
+    static std::unique_ptr<Node> insertInto(Node* node, std::string_view key, ValuePtr& value,
+                                            bool& inserted, std::string& separator);
+    static std::unique_ptr<Node> splitLeaf(Leaf& leaf, size_t insertedAt, std::string& separator);
+    static std::unique_ptr<Node> splitInner(Inner& inner, std::string& separator);
+
+    std::unique_ptr<Node> root_;
+    size_t size_ = 0;
+};
+
 }
 
 #endif // JSON_VALUE_HPP
\ No newline at end of file
@@ -67,6 +67,18 @@ public:
                                                                    std::size_t size) noexcept;
 };
 
+template <typename T>
+std::unique_ptr<T[]> Allocator::make_unique_array(std::size_t count) noexcept {
+    if (count == 0) {
+        return std::unique_ptr<T[]>(nullptr);
+    }
+    try {
+        return std::unique_ptr<T[]>(new T[count]());
+    } catch (...) {
+        return std::unique_ptr<T[]>(nullptr);
+    }
+}
+
 } // namespace memory
 } // namespace jsson
 
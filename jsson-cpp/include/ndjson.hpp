@@ -0,0 +1,119 @@
+#ifndef JSSON_NDJSON_HPP
+#define JSSON_NDJSON_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "dump.hpp"
+#include "io.hpp"
+#include "json_value.hpp"
+#include "parser.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Reader for newline-delimited JSON (one value per line).
+ *
+ * Lines are pulled from an InputSource in fixed-size chunks, so the reader
+ * works unchanged over plain files, memory and DecompressingSource.  Blank
+ * lines are skipped; a trailing '\r' is stripped.
+ *
+ * Records are parsed with a KeyOrderPredictor, since consecutive records
+ * usually share their keys and key order.
+ */
+class NdjsonReader {
+public:
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+    explicit NdjsonReader(std::unique_ptr<InputSource> source,
+                          size_t chunkSize = kDefaultChunkSize);
+
+    /**
+     * @brief Open @p filename via openInput() (compressed files included).
+     */
+    static NdjsonReader open(const std::string& filename);
+
+    /**
+     * @brief Fetch the next non-blank line without parsing it.
+     *
+     * @param line Set to a view that stays valid until the next call.
+     * @return false at end of input.
+     */
+    bool nextLine(std::string_view& line);
+
+    /**
+     * @brief Parse the next record.
+     *
+     * @param value Receives the parsed value.
+     * @return false at end of input.
+     * @throws JsonError on malformed records.
+     */
+    bool next(ValuePtr& value);
+
+    /** @return 1-based number of the line last returned. */
+    size_t lineNumber() const noexcept { return lineNumber_; }
+
+    /** @return Options next() parses with; keyPredictor is preset. */
+    ParseOptions& options() noexcept { return options_; }
+
+private:
+    bool fill();
+
+    std::unique_ptr<InputSource> source_;
+    std::string buffer_;
+    size_t chunkSize_;
+    size_t pos_ = 0;
+    size_t lineNumber_ = 0;
+    bool eof_ = false;
+    ParseOptions options_;
+};
+
+/**
+ * @brief Writer for newline-delimited JSON.
+ *
+ * Records are dumped one per line into an OutputSink; pair it with
+ * openOutput(filename, Compression::Gzip) or a CompressingSink to get
+ * parallel gzip/zstd output.
+ */
+class NdjsonWriter {
+public:
+    explicit NdjsonWriter(std::unique_ptr<OutputSink> sink);
+    ~NdjsonWriter();
+
+    NdjsonWriter(const NdjsonWriter&) = delete;
+    NdjsonWriter& operator=(const NdjsonWriter&) = delete;
+
+    /**
+     * @brief Create @p filename, optionally compressed (see openOutput()).
+     */
+    static std::unique_ptr<NdjsonWriter> open(const std::string& filename,
+                                              Compression format = Compression::None,
+                                              unsigned threads = 0);
+
+    /** Dump @p value followed by a newline. */
+    void write(const ValuePtr& value);
+
+    /**
+     * @brief Write an already serialized record verbatim.
+     * @param line One JSON value without the trailing newline.
+     */
+    void writeLine(std::string_view line);
+
+    /** @return Number of records written so far. */
+    size_t count() const noexcept { return count_; }
+
+    /** Flush all buffered records and finish the sink. */
+    void close();
+
+private:
+    std::unique_ptr<OutputSink> sink_;
+    SinkStream out_;
+    JsonDumper dumper_;
+    size_t count_ = 0;
+    bool closed_ = false;
+};
+
+} // namespace jsson
+
+#endif // JSSON_NDJSON_HPP
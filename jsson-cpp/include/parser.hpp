@@ -1,31 +1,352 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
 #include <string>
 #include <memory>
 #include <stdexcept>
 #include <string_view>
+#include <utility>
+#include <vector>
+#include "error.hpp"
 #include "json_value.hpp"
+#include "string_dictionary.hpp"
+#include "tape.hpp"
 namespace jsson {
+
+/** Interning of repeated string values while parsing. */
+enum class StringInterning {
+    Off,    ///< Every string value owns its characters (default).
+    On,     ///< Intern every string value up to maxInternLength bytes.
+    Auto    ///< Intern a sample first; keep interning only if it repeats enough.
+};
+
+/**
+ * @brief Flag another thread sets to abort a parse in progress.
+ */
+class CancellationToken {
+public:
+    /** Request cancellation; the parse fails with JsonErrorCode::Cancelled. */
+    void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+
+    /** @return true once cancel() has been called. */
+    bool cancelled() const noexcept { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @brief Resource bounds for parsing untrusted input.
+ *
+ * Every limit defaults to unbounded.  A violation aborts the parse with a
+ * JsonError carrying the matching code; nothing parsed so far is returned.
+ *
+ * Node counts, memory, the deadline and cancellation are checked when a
+ * container is entered and every few hundred elements inside one, so a
+ * limit may be overshot by that many scalar values.  Depth, input size and
+ * string length are checked exactly.
+ */
+struct ParseLimits {
+    static constexpr size_t kUnlimited = std::numeric_limits<size_t>::max();
+
+    /** Bytes of (decompressed) input text; InputTooLarge. */
+    size_t maxInputBytes = kUnlimited;
+
+    /** Values of any type, containers included; TooManyNodes. */
+    size_t maxNodes = kUnlimited;
+
+    /** Nesting depth of objects and arrays; DepthLimitExceeded. */
+    size_t maxDepth = kUnlimited;
+
+    /** Length of any string value or key, in input bytes; StringTooLong. */
+    size_t maxStringLength = kUnlimited;
+
+    /** Estimated bytes allocated for the document tree; MemoryLimitExceeded. */
+    size_t maxAllocationBytes = kUnlimited;
+
+    /** Wall-clock point after which the parse gives up; DeadlineExceeded. */
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    /** Checked alongside the deadline when set; Cancelled. */
+    std::shared_ptr<const CancellationToken> cancellation;
+};
+
+/**
+ * @brief Remembers the key order of objects from one document to the next.
+ *
+ * Records in a stream nearly always repeat their keys in the same order.
+ * With a predictor in ParseOptions, the parser compares each incoming key
+ * against the key seen at the same member index of the same object (the
+ * n-th object opened in the document) with one memcmp of the raw input,
+ * and sizes each object's member table up front.  A mismatching key takes
+ * the general path and replaces the prediction.
+ *
+ * Once an object has matched its whole prediction, the predictor keeps a
+ * prototype member table holding the predicted keys.  Later objects at
+ * that position start as a copy of it, which keeps each key's cached hash
+ * and bucket, and a hit drops the value straight into its slot: no key
+ * is scanned, copied or hashed.  A miss removes the slots still empty and
+ * carries on along the general path.
+ *
+ * Keys containing quotes or escapes are never predicted.  Not thread-safe:
+ * use one predictor per stream or thread.
+ */
+class KeyOrderPredictor {
+public:
+    static constexpr size_t kDefaultMaxPositions = 64;
+
+    /** @param maxPositions Objects per document that get predictions. */
+    explicit KeyOrderPredictor(size_t maxPositions = kDefaultMaxPositions)
+        : maxPositions_(maxPositions) {}
+
+    /**
+     * @brief Check the raw @p input, positioned at a key's opening quote.
+     * @return The predicted key if @p input starts with it quoted, else nullptr.
+     */
+    const std::string* match(size_t position, size_t index, std::string_view input) noexcept;
+
+    /** @brief Record @p key as member @p index of object @p position. */
+    void learn(size_t position, size_t index, std::string_view key);
+
+    /** @brief Record that object @p position ended after @p count members. */
+    void finish(size_t position, size_t count);
+
+    /** @return Members object @p position had last time (0 if unknown). */
+    size_t expectedSize(size_t position) const noexcept;
+
+    /**
+     * @brief Member table with the keys predicted for object @p position.
+     *
+     * Each key maps to an integer marker holding its member index.
+     * @return nullptr until an object at @p position matched its whole
+     *         prediction, and again after the prediction changes.
+     */
+    const JsonObject::Map* prototype(size_t position) const noexcept;
+
+    /** @return Keys taken from a prediction. */
+    size_t hits() const noexcept { return hits_; }
+
+    /** @return Predicted keys the input did not match. */
+    size_t misses() const noexcept { return misses_; }
+
+    /** @brief Forget all predictions. */
+    void clear() { shapes_.clear(); }
+
+private:
+    struct Key {
+        std::string text;
+        bool predictable;
+    };
+
+    struct Shape {
+        std::vector<Key> keys;
+        // Shared, read-only, by copies of the predictor
+        std::shared_ptr<const JsonObject::Map> prototype;
+        bool changed = true;    // keys learned since the last finish()
+    };
+
+    size_t maxPositions_;
+    std::vector<Shape> shapes_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+/**
+ * @brief Options controlling Parser::parse and Parser::parseText.
+ */
+struct ParseOptions {
+    /** How string values are stored. */
+    StringInterning interning = StringInterning::Off;
+
+    /**
+     * Dictionary shared between documents (and threads).  When null and
+     * interning is enabled, each document gets its own dictionary.
+     */
+    std::shared_ptr<StringDictionary> dictionary;
+
+    /** Longer strings are never interned. */
+    size_t maxInternLength = 64;
+
+    /** Number of string values sampled before Auto decides. */
+    size_t internSampleSize = 1024;
+
+    /** Auto keeps interning if at least this fraction of samples repeated. */
+    double internMinRepeatRatio = 0.5;
+
+    /**
+     * Give the document atomic reference counts.  Turn off for documents
+     * whose handles never leave the parsing thread: copying a ValuePtr then
+     * costs a plain increment instead of a locked one.
+     */
+    bool atomicRefCounts = JSSON_ATOMIC_REFCOUNT != 0;
+
+    /**
+     * Keep string values in their escaped form (RawString) and unescape
+     * them on first access.  The document then shares one copy of the
+     * input text.  Object keys are still unescaped while parsing, and
+     * interning, when enabled, takes precedence.
+     */
+    bool lazyStrings = false;
+
+    /**
+     * Objects reaching this many members switch to OrderedObject storage
+     * (sorted, range-queryable, no rehashing) for the rest of the parse.
+     */
+    size_t orderedObjectMinSize = std::numeric_limits<size_t>::max();
+
+    /**
+     * Key order predictions kept across documents (NdjsonReader sets one
+     * up); null disables prediction.
+     */
+    std::shared_ptr<KeyOrderPredictor> keyPredictor;
+
+    /** Resource bounds; unbounded by default. */
+    ParseLimits limits;
+};
+
+/** @brief Result of Parser::parseBatch(). */
+struct ParsedBatch {
+    /** One root per message, in input order; null where parsing failed. */
+    std::vector<ValuePtr> roots;
+    /** Message index and error of each failed message, in index order. */
+    std::vector<std::pair<size_t, JsonError>> errors;
+};
+
 class Parser {
 public:
     /**
      * @brief Parses a JSON file and returns the root JsonValue.
+     *
+     * gzip and zstd compressed files are detected by their magic bytes and
+     * decompressed on a background thread while being read.
+     *
      * @param filename Path to the JSON file.
-     * @return Shared pointer to the parsed JsonValue.
-     * @throws std::runtime_error on file opening or parsing errors.
+     * @param options  Parsing options.
+     * @return Handle to the parsed JsonValue.
+     * @throws std::runtime_error on file opening errors.
+     * @throws JsonError on parsing errors and exceeded limits.
+     */
+    static ValuePtr parse(const std::string& filename,
+                                            const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Parses JSON text held in memory.
+     * @param text    The JSON text.
+     * @param options Parsing options.
+     * @return Handle to the parsed JsonValue.
+     * @throws JsonError on parsing errors and exceeded limits.
+     */
+    static ValuePtr parseText(std::string_view text,
+                                                const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Parses JSON text in a buffer the document takes over.
+     *
+     * String values are unescaped into the buffer itself (unescaping never
+     * lengthens a string) and stay there as RawString views, so parsing
+     * allocates nothing per string.  Object keys are unescaped as usual,
+     * since objects own their keys.  The buffer lives as long as any value
+     * viewing it and is then released with delete[].
+     *
+     * @param buf     Buffer holding @p len bytes of JSON text; owned by the
+     *                document from now on, even if parsing fails.  Its
+     *                contents are overwritten.
+     * @param len     Number of bytes of text.
+     * @param options Parsing options; lazyStrings is implied.
+     * @return Handle to the parsed JsonValue.
+     * @throws JsonError on parsing errors and exceeded limits.
+     */
+    static ValuePtr parseInSitu(std::unique_ptr<char[]> buf, size_t len,
+                                const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Parses @p text over a document of (mostly) the same shape.
+     *
+     * The existing tree is walked alongside the input: scalars are
+     * overwritten in place, strings reuse their capacity, and object members
+     * and array elements are matched by key and position and updated
+     * recursively.  Only where the shape differs are nodes created (new
+     * members, longer arrays, changed types) or dropped, so polling a
+     * document whose values change but whose structure does not allocates
+     * nothing once warmed up.  Strings updated in place become owned
+     * std::string values; lazyStrings does not apply.
+     *
+     * Values are changed through the nodes themselves, so other handles to
+     * shared subtrees see the update.  On error the document holds the
+     * changes made up to the failure point.
+     *
+     * @param existing Document to update.
+     * @param text     The new JSON text.
+     * @param options  Parsing options (limits, orderedObjectMinSize).
+     * @return true if any value changed.
+     * @throws JsonError on parsing errors and exceeded limits.
+     */
+    static bool reparseInto(JsonValue& existing, std::string_view text,
+                            const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Parses many small documents in one call.
+     *
+     * Each worker thread parses its contiguous share of the messages
+     * inside one NodeArena, so the whole batch costs a handful of block
+     * allocations instead of per-node heap traffic.  Its parser state is
+     * set up once and reset between messages, so interning (when enabled
+     * without a shared dictionary) uses one dictionary per worker, and
+     * StringInterning::Auto decides once per worker rather than once per
+     * message.  With lazyStrings the messages are copied into one buffer
+     * that all documents share.  Only the calling thread's share updates
+     * options.keyPredictor; other workers learn in copies of it.
+     *
+     * A malformed message does not stop the batch; its root is null and
+     * its error is reported in ParsedBatch::errors.  Limits apply per
+     * message.
+     *
+     * @param messages Pointer to @p count message texts; not referenced
+     *                 after the call.
+     * @param count    Number of messages.
+     * @param options  Parsing options, applied to every message.
+     * @param threads  Worker threads; 0 picks the hardware concurrency.
+     *                 Small batches use fewer.
+     * @return Roots and errors.
+     */
+    static ParsedBatch parseBatch(const std::string_view* messages, size_t count,
+                                  const ParseOptions& options = ParseOptions(),
+                                  size_t threads = 1);
+
+    /** @copydoc parseBatch(const std::string_view*, size_t, const ParseOptions&, size_t) */
+    static ParsedBatch parseBatch(const std::vector<std::string_view>& messages,
+                                  const ParseOptions& options = ParseOptions(),
+                                  size_t threads = 1);
+
+    /**
+     * @brief Parses JSON text straight into a flat tape document.
+     * @param json The JSON text; it is not referenced after the call.
+     * @return The tape document (one allocation for tape and strings).
+     * @throws JsonError on parsing errors.
+     */
+    static TapeDocument parseTape(std::string_view json);
+
+    /**
+     * @brief Unescapes the characters of a string literal.
+     * @param escaped The characters between the quotes.
+     * @return The decoded string.
+     * @throws JsonError on invalid escape sequences.
      */
-    static std::shared_ptr<JsonValue> parse(const std::string& filename);
+    static std::string unescape(std::string_view escaped);
 
 public:
     // Helper functions for parsing
     static void skipWhitespace(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseValue(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseObject(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseArray(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseString(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseLiteral(std::string_view& view);
-    static std::shared_ptr<JsonValue> parseNumber(std::string_view& view);
+    static ValuePtr parseValue(std::string_view& view);
+    static ValuePtr parseObject(std::string_view& view);
+    static ValuePtr parseArray(std::string_view& view);
+    static ValuePtr parseString(std::string_view& view);
+    static ValuePtr parseLiteral(std::string_view& view);
+    static ValuePtr parseNumber(std::string_view& view);
 };
 }
 
@@ -0,0 +1,41 @@
+#ifndef JSSON_PROBES_HPP
+#define JSSON_PROBES_HPP
+
+/**
+ * @file
+ * @brief USDT (SystemTap/DTrace-style) static tracepoints.
+ *
+ * With <sys/sdt.h> available each probe compiles to a single NOP plus an
+ * ELF note, so it costs nothing until a tracer attaches, e.g.
+ *
+ *     bpftrace -e 'usdt:./app:jsson:parse_done { @nodes = hist(arg1); }'
+ *
+ * Probes (provider "jsson"):
+ *  - parse_start(bytes), parse_done(bytes, nodes), parse_error(code)
+ *  - dump_start(value), dump_done(value), serialize_chunk(serializer, bytes)
+ *  - arena_block(bytes, blocks)
+ *  - hashtable_contended(table, shard), hashtable_resize(table, shard, buckets)
+ *
+ * Define JSSON_NO_USDT (CMake option JSSON_WITH_USDT=OFF) to compile them out.
+ */
+
+#if !defined(JSSON_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define JSSON_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef JSSON_HAVE_USDT
+#define JSSON_PROBE0(name) STAP_PROBE(jsson, name)
+#define JSSON_PROBE1(name, a) STAP_PROBE1(jsson, name, a)
+#define JSSON_PROBE2(name, a, b) STAP_PROBE2(jsson, name, a, b)
+#define JSSON_PROBE3(name, a, b, c) STAP_PROBE3(jsson, name, a, b, c)
+#else
+#define JSSON_PROBE0(name) do {} while (0)
+#define JSSON_PROBE1(name, a) do { (void)(a); } while (0)
+#define JSSON_PROBE2(name, a, b) do { (void)(a); (void)(b); } while (0)
+#define JSSON_PROBE3(name, a, b, c) do { (void)(a); (void)(b); (void)(c); } while (0)
+#endif
+
+#endif // JSSON_PROBES_HPP
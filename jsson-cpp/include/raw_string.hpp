@@ -0,0 +1,86 @@
+#ifndef JSSON_RAW_STRING_HPP
+#define JSSON_RAW_STRING_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jsson {
+
+/**
+ * @brief String value viewing characters in a shared input buffer.
+ *
+ * Produced by the parser with ParseOptions::lazyStrings: instead of
+ * unescaping every string up front, the value records where its escaped
+ * characters sit in the (shared, immutable) input buffer and whether any
+ * backslash escapes occur.  Strings without escapes can be viewed, compared
+ * and dumped without ever being copied; the unescaped std::string is only
+ * built on the first call to str(), once, even with concurrent readers.
+ *
+ * Parser::parseInSitu instead unescapes into the buffer itself and creates
+ * values with unescaped(), whose span already holds the final characters.
+ */
+class RawString {
+public:
+    /**
+     * @param source     Owner of the buffer holding the characters; kept alive.
+     * @param escaped    Characters between the quotes, still escaped.
+     * @param hasEscapes true if @p escaped contains a backslash.
+     */
+    RawString(std::shared_ptr<const void> source, std::string_view escaped,
+              bool hasEscapes) noexcept
+        : source_(std::move(source)), span_(escaped), hasEscapes_(hasEscapes) {}
+
+    /**
+     * @brief View already unescaped characters (which may need escaping
+     *        again when dumped).
+     * @param source Owner of the buffer holding the characters; kept alive.
+     * @param text   The string value.
+     */
+    static RawString unescaped(std::shared_ptr<const void> source, std::string_view text) noexcept {
+        RawString raw(std::move(source), text, false);
+        raw.verbatim_ = false;
+        return raw;
+    }
+
+    RawString(const RawString& other);
+    RawString(RawString&& other) noexcept;
+    RawString& operator=(const RawString& other);
+    RawString& operator=(RawString&& other) noexcept;
+    ~RawString();
+
+    /**
+     * @return The characters viewed: escaped if hasEscapes(), otherwise
+     *         the string value itself.
+     */
+    std::string_view span() const noexcept { return span_; }
+
+    /** @return true if span() contains backslash escapes still to decode. */
+    bool hasEscapes() const noexcept { return hasEscapes_; }
+
+    /** @return true if span() is valid JSON string text as it stands. */
+    bool isVerbatim() const noexcept { return verbatim_; }
+
+    /**
+     * @return The unescaped characters without building a std::string
+     *         when the input had no escapes.
+     */
+    std::string_view view() const {
+        return hasEscapes_ ? std::string_view(str()) : span_;
+    }
+
+    /** @return The unescaped string, decoded on first use. */
+    const std::string& str() const;
+
+private:
+    std::shared_ptr<const void> source_;
+    std::string_view span_;
+    bool hasEscapes_;
+    bool verbatim_ = true;
+    mutable std::atomic<const std::string*> decoded_{nullptr};
+};
+
+} // namespace jsson
+
+#endif // JSSON_RAW_STRING_HPP
@@ -0,0 +1,120 @@
+#ifndef JSSON_RECLAIMER_HPP
+#define JSSON_RECLAIMER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "json_value.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Deferred destruction of large JSON trees.
+ *
+ * Dropping the last reference to a big document frees every node on the
+ * dropping thread.  Handing the tree to retire() instead makes that O(1):
+ * the tree is queued and taken apart later, a bounded slice of nodes at a
+ * time, either by a background thread or by explicit reclaim() calls from
+ * the owner's own idle points.
+ *
+ * Trees are dismantled iteratively (children are detached onto a work
+ * stack before their parent is freed), so deep documents cannot overflow
+ * the stack either.  Subtrees still referenced elsewhere are only
+ * released, never destroyed.  Owners whose destruction is already a single
+ * free, such as a TapeDocument, go through retireWhole() and are freed as
+ * one unit.
+ */
+class Reclaimer {
+public:
+    enum class Mode {
+        /** A worker thread reclaims in slices as soon as work arrives. */
+        Background,
+        /** Nothing is freed until reclaim() or drain() is called. */
+        Manual
+    };
+
+    static constexpr size_t kDefaultSlice = 4096;
+
+    /**
+     * @param mode  Who performs the reclamation.
+     * @param slice Nodes freed by the background thread before it yields.
+     */
+    explicit Reclaimer(Mode mode = Mode::Background, size_t slice = kDefaultSlice);
+
+    /** Frees everything still pending before returning. */
+    ~Reclaimer();
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    /** @brief Process-wide background reclaimer. */
+    static Reclaimer& global();
+
+    /**
+     * @brief Queue a tree for destruction.
+     *
+     * Takes the caller's reference; if it was the last one the tree is
+     * destroyed later, off the calling thread.
+     */
+    void retire(ValuePtr value);
+
+    /**
+     * @brief Queue any movable owner to be destroyed in one step.
+     */
+    template <typename T>
+    void retireWhole(T&& owner) {
+        using Owner = std::decay_t<T>;
+        retireOpaque(std::make_unique<Holder<Owner>>(std::forward<T>(owner)));
+    }
+
+    /**
+     * @brief Free up to @p maxNodes nodes on the calling thread.
+     * @return Number of nodes freed.
+     */
+    size_t reclaim(size_t maxNodes = kDefaultSlice);
+
+    /** Free everything retired so far on the calling thread. */
+    void drain();
+
+    /** @return Items queued or partly dismantled (approximate). */
+    size_t pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    struct Retired {
+        virtual ~Retired() = default;
+    };
+
+    template <typename T>
+    struct Holder : Retired {
+        explicit Holder(T&& value) : owner(std::move(value)) {}
+        explicit Holder(const T& value) : owner(value) {}
+        T owner;
+    };
+
+    void retireOpaque(std::unique_ptr<Retired> owner);
+    void run();
+
+    // Incoming items, appended by retire() under queueMutex_
+    std::mutex queueMutex_;
+    std::condition_variable wakeup_;
+    std::vector<ValuePtr> incoming_;
+    std::vector<std::unique_ptr<Retired>> incomingOpaque_;
+    bool stop_ = false;
+
+    // Work stack of the thread currently reclaiming, under workMutex_
+    std::mutex workMutex_;
+    std::vector<ValuePtr> work_;
+
+    std::atomic<size_t> pending_{0};
+    size_t slice_;
+    std::thread worker_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_RECLAIMER_HPP
@@ -0,0 +1,171 @@
+#ifndef JSSON_REF_HPP
+#define JSSON_REF_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+/*
+ * Default for new reference counts: 1 uses atomic read-modify-write
+ * operations, 0 plain loads and stores (single-threaded programs).
+ * Individual values can still be switched with setAtomic().
+ */
+#ifndef JSSON_ATOMIC_REFCOUNT
+#define JSSON_ATOMIC_REFCOUNT 1
+#endif
+
+namespace jsson {
+
+/**
+ * @brief Reference count embedded in a counted object.
+ *
+ * Like the refcount in the C library's json_t, the count lives inside the
+ * object, so a counted object needs no separate control block.  Each
+ * count is either atomic (safe to share between threads) or plain: plain
+ * counts are updated with ordinary loads and stores, avoiding the locked
+ * instructions an atomic increment costs.
+ *
+ * Copying the owning object never copies its count: the copy starts
+ * unreferenced.
+ */
+class RefCount {
+public:
+    RefCount() noexcept = default;
+    RefCount(const RefCount&) noexcept {}
+    RefCount& operator=(const RefCount&) noexcept { return *this; }
+
+    /** Add one reference. */
+    void increment() const noexcept {
+        if (atomic_) {
+            count_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /** Drop one reference. @return true if it was the last one. */
+    bool decrement() const noexcept {
+        if (atomic_) {
+            return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+        uint32_t count = count_.load(std::memory_order_relaxed) - 1;
+        count_.store(count, std::memory_order_relaxed);
+        return count == 0;
+    }
+
+    /** @return Current number of references. */
+    uint32_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+    /** @return true if updates are atomic. */
+    bool isAtomic() const noexcept { return atomic_; }
+
+    /**
+     * @brief Choose atomic or plain updates.
+     *
+     * Only switch while no other thread can reach the object, typically
+     * right after creating it.
+     */
+    void setAtomic(bool atomic) noexcept { atomic_ = atomic; }
+
+private:
+    mutable std::atomic<uint32_t> count_{0};
+    bool atomic_ = JSSON_ATOMIC_REFCOUNT != 0;
+};
+
+/**
+ * @brief Intrusive owning handle, the counterpart of std::shared_ptr.
+ *
+ * @p T must hold a RefCount member named refs_ and befriend Ref<T>.  A
+ * Ref is one pointer wide, and copying it touches only the count inside
+ * the object.  The object is deleted when its last Ref goes away.
+ */
+template <typename T>
+class Ref {
+public:
+    Ref() noexcept = default;
+    Ref(std::nullptr_t) noexcept {}
+
+    /** Adopt @p object, adding a reference to it. */
+    explicit Ref(T* object) noexcept : ptr_(object) {
+        if (ptr_) ptr_->refs_.increment();
+    }
+
+    Ref(const Ref& other) noexcept : ptr_(other.ptr_) {
+        if (ptr_) ptr_->refs_.increment();
+    }
+
+    Ref(Ref&& other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    ~Ref() { release(); }
+
+    Ref& operator=(const Ref& other) noexcept {
+        Ref(other).swap(*this);
+        return *this;
+    }
+
+    Ref& operator=(Ref&& other) noexcept {
+        Ref(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    Ref& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    T* get() const noexcept { return ptr_; }
+    T& operator*() const noexcept { return *ptr_; }
+    T* operator->() const noexcept { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+    /** @return Number of Refs to the object, 0 if empty. */
+    long use_count() const noexcept { return ptr_ ? static_cast<long>(ptr_->refs_.count()) : 0; }
+
+    void reset() noexcept {
+        release();
+        ptr_ = nullptr;
+    }
+
+    void reset(T* object) noexcept { Ref(object).swap(*this); }
+
+    void swap(Ref& other) noexcept { std::swap(ptr_, other.ptr_); }
+
+    friend bool operator==(const Ref& a, const Ref& b) noexcept { return a.ptr_ == b.ptr_; }
+    friend bool operator!=(const Ref& a, const Ref& b) noexcept { return a.ptr_ != b.ptr_; }
+    friend bool operator==(const Ref& a, std::nullptr_t) noexcept { return !a.ptr_; }
+    friend bool operator!=(const Ref& a, std::nullptr_t) noexcept { return a.ptr_ != nullptr; }
+
+private:
+    void release() noexcept {
+        if (ptr_ && ptr_->refs_.decrement()) {
+            delete ptr_;
+        }
+    }
+
+    T* ptr_ = nullptr;
+};
+
+/** @brief Construct a T and return the first Ref to it. */
+template <typename T, typename... Args>
+Ref<T> makeRef(Args&&... args) {
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+} // namespace jsson
+
+namespace std {
+
+template <typename T>
+struct hash<jsson::Ref<T>> {
+    size_t operator()(const jsson::Ref<T>& ref) const noexcept {
+        return hash<T*>()(ref.get());
+    }
+};
+
+} // namespace std
+
+#endif // JSSON_REF_HPP
@@ -0,0 +1,85 @@
+#ifndef JSSON_SIMD_HPP
+#define JSSON_SIMD_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace jsson {
+
+/** @brief Instruction set levels with their own kernel builds, lowest first. */
+enum class SimdLevel {
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Byte-scanning kernels shared by the parser, dumper and UTF-8 code.
+ *
+ * Every kernel looks at @p size bytes from @p data and returns the length
+ * of the leading run it accepts, i.e. the index of the first byte that
+ * stops it, or @p size.  Kernels never read past @p size.
+ */
+struct SimdKernels {
+    SimdLevel level;
+    /** Run without '"' or '\\'. */
+    size_t (*findQuoteOrBackslash)(const char* data, size_t size) noexcept;
+    /** Run without '"', '\\' or control characters (below 0x20). */
+    size_t (*findEscapable)(const char* data, size_t size) noexcept;
+    /** Run of bytes below 0x80. */
+    size_t (*asciiPrefix)(const char* data, size_t size) noexcept;
+    /** Run of JSON whitespace: ' ', '\\t', '\\n' and '\\r' (RFC 8259). */
+    size_t (*whitespacePrefix)(const char* data, size_t size) noexcept;
+};
+
+/**
+ * @brief Runtime selection of the kernel set.
+ *
+ * Each level is compiled in its own translation unit with that ISA
+ * enabled, so one binary carries all of them; the best level the CPU
+ * supports is chosen on first use.  The JSSON_SIMD environment variable
+ * ("scalar", "sse4.2", "avx2", "avx512") or setLevel() lowers the choice,
+ * which lets every variant run on one machine.
+ */
+namespace simd {
+
+/** @return Highest level both the CPU and this build support. */
+SimdLevel supportedLevel() noexcept;
+
+/** @return Level of the kernels in use. */
+SimdLevel activeLevel() noexcept;
+
+/**
+ * @brief Switch to the kernels for @p level.
+ *
+ * Levels above supportedLevel() are clamped.  Not meant to race with
+ * work in progress on other threads; kernels already fetched keep running.
+ *
+ * @return The level now active.
+ */
+SimdLevel setLevel(SimdLevel level) noexcept;
+
+/** @return The active kernels. */
+const SimdKernels& kernels() noexcept;
+
+/** @return Name of @p level as accepted by JSSON_SIMD. */
+const char* levelName(SimdLevel level) noexcept;
+
+/** @return The level named @p name, if any. */
+std::optional<SimdLevel> parseLevel(std::string_view name) noexcept;
+
+/** @name Per-ISA kernel tables; nullptr when the build lacks that ISA */
+/** @{ */
+const SimdKernels* scalarKernels() noexcept;
+const SimdKernels* sse42Kernels() noexcept;
+const SimdKernels* avx2Kernels() noexcept;
+const SimdKernels* avx512Kernels() noexcept;
+/** @} */
+
+} // namespace simd
+
+} // namespace jsson
+
+#endif // JSSON_SIMD_HPP
@@ -0,0 +1,94 @@
+#ifndef JSSON_SORT_HPP
+#define JSSON_SORT_HPP
+
+#include <cstddef>
+#include <string>
+#include "json_pointer.hpp"
+#include "json_value.hpp"
+#include "ndjson.hpp"
+
+namespace jsson {
+
+/** Direction for sortBy() and topK(). */
+enum class SortOrder {
+    Ascending,
+    Descending
+};
+
+/**
+ * @brief Sort an array by the value at @p key inside each element.
+ *
+ * Sort keys are resolved once per element into a compact key array, sorted
+ * with a parallel merge sort, and the elements are then moved into place
+ * as one permutation, so no comparison touches a JsonObject.
+ *
+ * Keys of different types follow one total order: missing, null, false,
+ * true, numbers (integers and doubles compared by exact value, NaN last),
+ * strings (bytewise), arrays, then objects.  Arrays and objects compare
+ * equal among themselves.  Equal keys keep their original relative order
+ * in both directions.
+ *
+ * @param array   The array to reorder.
+ * @param key     Pointer resolved against each element ("" for the element
+ *                itself).
+ * @param order   Sort direction.
+ * @param threads Worker threads; 0 uses one per hardware thread.  Small
+ *                arrays are always sorted on the calling thread.
+ */
+void sortBy(JsonArray& array, const JsonPointer& key,
+            SortOrder order = SortOrder::Ascending, unsigned threads = 0);
+
+/**
+ * @brief The first @p k elements of @p array in sortBy() order.
+ *
+ * Each worker keeps only its own best @p k keys, so the full array is
+ * never sorted.  @p array itself is not modified.
+ *
+ * @return A new array sharing the selected elements with @p array.
+ */
+JsonArray topK(const JsonArray& array, const JsonPointer& key, size_t k,
+               SortOrder order = SortOrder::Ascending, unsigned threads = 0);
+
+/** @brief Tuning for sortNdjson(). */
+struct ExternalSortOptions {
+    SortOrder order = SortOrder::Ascending;
+
+    /**
+     * Bytes of buffered lines (plus per-record bookkeeping) held at once.
+     * Half goes to the run being filled, half to the run being spilled.
+     */
+    size_t memoryLimit = size_t(256) << 20;
+
+    /** Directory for run files; empty uses the system temporary directory. */
+    std::string scratchDir;
+
+    /** Key extraction threads; 0 uses one per hardware thread. */
+    unsigned threads = 0;
+
+    /** Runs merged in one pass; more runs are merged in several passes. */
+    size_t maxFanIn = 128;
+};
+
+/**
+ * @brief Sort the records of @p in by the value at @p key into @p out.
+ *
+ * For inputs larger than memory: records are read into runs of at most
+ * half of options.memoryLimit, their keys extracted in parallel and
+ * sorted as in sortBy(), and each run is spilled to a scratch file on a
+ * background thread while the next one is read.  Runs are then k-way
+ * merged with a loser tree.  Record lines are copied byte for byte, never
+ * reserialized; input that fits in one run is never spilled.
+ *
+ * The order is sortBy()'s, including its stability: records with equal
+ * keys keep their input order.  Scratch files are removed on return,
+ * including when an exception is thrown.
+ *
+ * @return Number of records written.
+ * @throws JsonError on malformed records, with their line number.
+ */
+size_t sortNdjson(NdjsonReader& in, NdjsonWriter& out, const JsonPointer& key,
+                  const ExternalSortOptions& options = ExternalSortOptions());
+
+} // namespace jsson
+
+#endif // JSSON_SORT_HPP
@@ -23,6 +23,8 @@ public:
     // Append methods
     StringBuffer& append(char c);
     StringBuffer& append(const char* data, size_t size);
+    // Append the base64 encoding of raw bytes (no quotes)
+    StringBuffer& appendBase64(const void* data, size_t size);
 
     // Prepend methods
     StringBuffer& prepend(char c);
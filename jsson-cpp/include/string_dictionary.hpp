@@ -0,0 +1,84 @@
+#ifndef JSSON_STRING_DICTIONARY_HPP
+#define JSSON_STRING_DICTIONARY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jsson {
+
+/**
+ * @brief String value stored once in a StringDictionary.
+ *
+ * JsonValue string nodes can hold one of these instead of an owned
+ * std::string.  Two interned strings from the same dictionary are equal
+ * exactly when they point at the same entry, so equality is a pointer
+ * comparison.
+ */
+struct InternedString {
+    std::shared_ptr<const std::string> entry;
+
+    const std::string& str() const noexcept { return *entry; }
+};
+
+/**
+ * @brief Interning table for repeated string values.
+ *
+ * A dictionary can be private to one document (created by the parser) or
+ * shared between many documents and threads by passing it in through
+ * ParseOptions.  Entries are reference counted by the values using them;
+ * purge() drops entries nobody references any more.
+ */
+class StringDictionary {
+public:
+    /**
+     * @param threadSafe Guard the table with a reader/writer lock.  Only
+     *                   dictionaries shared between threads need it.
+     */
+    explicit StringDictionary(bool threadSafe = true) : threadSafe_(threadSafe) {}
+
+    StringDictionary(const StringDictionary&) = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+
+    /**
+     * @brief Return the entry for @p value, inserting it if needed.
+     */
+    InternedString intern(std::string_view value);
+
+    /**
+     * @brief Look @p value up without inserting it.
+     * @return The entry, or an InternedString with a null entry if absent.
+     */
+    InternedString find(std::string_view value) const;
+
+    /** @return Number of distinct strings stored. */
+    size_t size() const;
+
+    /** @return Number of intern() calls answered by an existing entry. */
+    size_t hits() const noexcept { return hits_.load(std::memory_order_relaxed); }
+
+    /** @return Total number of intern() calls. */
+    size_t lookups() const noexcept { return lookups_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Drop entries that are no longer referenced by any value.
+     * @return Number of entries removed.
+     */
+    size_t purge();
+
+private:
+    // Keys view the entry's own characters, so lookups need no allocation
+    std::unordered_map<std::string_view, std::shared_ptr<const std::string>> entries_;
+    mutable std::shared_mutex mutex_;
+    bool threadSafe_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> lookups_{0};
+};
+
+} // namespace jsson
+
+#endif // JSSON_STRING_DICTIONARY_HPP
@@ -0,0 +1,150 @@
+#ifndef JSSON_SUBSCRIPTION_HPP
+#define JSSON_SUBSCRIPTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "json_pointer.hpp"
+#include "json_value.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Index of change subscriptions on JSON Pointer patterns.
+ *
+ * Patterns are pointers in which a "*" token matches any single key or
+ * index.  They are compiled into a trie
+ * over reference tokens with a separate wildcard edge per node, so a
+ * changed path is matched against every subscription by walking the trie
+ * once, token by token, instead of testing each pattern.
+ *
+ * A change at path P notifies a subscription whose pattern
+ *  - matches P exactly,
+ *  - matches a descendant of P (the watched value was replaced or removed
+ *    along with its parent), or
+ *  - matches an ancestor of P, if the subscription watches descendants.
+ *
+ * Notifications are delivered in batches, see notify() and Transaction.
+ * Subscribing and matching may run on different threads.
+ */
+class SubscriptionIndex {
+public:
+    using Id = uint64_t;
+
+    /** Receives the changed paths of one batch that matched the subscription. */
+    using Callback = std::function<void(const std::vector<JsonPointer>& changes)>;
+
+    SubscriptionIndex();
+    ~SubscriptionIndex();
+
+    SubscriptionIndex(const SubscriptionIndex&) = delete;
+    SubscriptionIndex& operator=(const SubscriptionIndex&) = delete;
+
+    /**
+     * @brief Register @p callback for changes matching @p pattern.
+     *
+     * @param pattern            JSON Pointer text; "*" tokens are wildcards.
+     * @param callback           Called from notify(), without index locks held.
+     * @param watchDescendants   Also notify for changes below a match.
+     * @return Handle for unsubscribe().
+     * @throws JsonError(InvalidFormat) if @p pattern is not a valid pointer.
+     */
+    Id subscribe(std::string_view pattern, Callback callback, bool watchDescendants = true);
+
+    /**
+     * @brief Remove a subscription, pruning trie nodes no pattern uses any more.
+     * @return true if the subscription existed.
+     */
+    bool unsubscribe(Id id);
+
+    /** @return Number of subscriptions. */
+    size_t size() const;
+
+    /** @return Number of trie nodes below the root. */
+    size_t nodeCount() const;
+
+    /** @brief Append the ids of subscriptions that a change at @p path notifies. */
+    void match(const JsonPointer& path, std::vector<Id>& out) const;
+
+    /**
+     * @brief Deliver one batch of changes.
+     *
+     * Each matching subscription's callback runs once, with the paths of
+     * the batch that concern it, in batch order.
+     */
+    void notify(const std::vector<JsonPointer>& changes) const;
+
+private:
+    struct Node;
+    struct Subscription;
+
+    mutable std::shared_mutex mutex_;
+    std::unique_ptr<Node> root_;
+    std::unordered_map<Id, Subscription> subscriptions_;
+    size_t nodes_ = 0;
+    Id nextId_ = 1;
+};
+
+/**
+ * @brief Mutations on a document whose notifications go out per commit.
+ *
+ * Each operation changes the document at once and records the changed
+ * path; commit() (or the destructor) hands the recorded paths, each
+ * once, to the index as one batch.  Edits made directly through
+ * JsonObject/JsonArray can be reported with touch().
+ */
+class Transaction {
+public:
+    Transaction(JsonValue& root, const SubscriptionIndex& index) : root_(root), index_(index) {}
+
+    /** Commits pending changes. */
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    /**
+     * @brief Store @p value at @p path.
+     *
+     * The parent must exist.  Object members are inserted or replaced;
+     * array elements are replaced, and the index one past the end (or "-")
+     * appends.  The empty path replaces the whole document.
+     *
+     * @throws JsonError(ItemNotFound) if the parent does not exist.
+     * @throws JsonError(IndexOutOfRange) for an array index past the end.
+     * @throws JsonError(WrongType) if the parent is not a container.
+     */
+    void set(const JsonPointer& path, ValuePtr value);
+
+    /** @brief Append @p value to the array at @p path. */
+    void append(const JsonPointer& path, ValuePtr value);
+
+    /** @return true if @p path existed and was removed. */
+    bool erase(const JsonPointer& path);
+
+    /** @brief Record a change made to @p path by other means. */
+    void touch(const JsonPointer& path);
+
+    /** @return Number of distinct changed paths awaiting commit(). */
+    size_t pending() const noexcept { return changes_.size(); }
+
+    /** @brief Notify subscribers of the changes so far. */
+    void commit();
+
+private:
+    JsonValue& root_;
+    const SubscriptionIndex& index_;
+    std::vector<JsonPointer> changes_;
+    std::unordered_set<std::string> seen_;
+};
+
+} // namespace jsson
+
+#endif // JSSON_SUBSCRIPTION_HPP
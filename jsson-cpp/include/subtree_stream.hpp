@@ -0,0 +1,116 @@
+#ifndef JSSON_SUBTREE_STREAM_HPP
+#define JSSON_SUBTREE_STREAM_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "error.hpp"
+#include "io.hpp"
+#include "json_pointer.hpp"
+#include "json_value.hpp"
+#include "parser.hpp"
+
+namespace jsson {
+
+/**
+ * @brief Pulls the subtrees matching a path pattern out of a huge document.
+ *
+ * The pattern is a JSON Pointer in which a "*" token matches any member
+ * name or array index: "/items" followed by a "*" token yields every
+ * element of the top-level "items" array, one at a time.  The input is read in fixed-size
+ * chunks and everything outside the pattern is only scanned in skip mode
+ * (brackets balanced, strings terminated, nothing built), so memory use is
+ * bounded by the largest matching subtree rather than by the document.
+ *
+ * Each match is copied into a capture buffer that is reused from match to
+ * match and parsed from there with Parser::parseText(), so only matching
+ * subtrees are ever validated fully.
+ */
+class SubtreeStream {
+public:
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+    /**
+     * @param source    Input to read; compressed files work through openInput().
+     * @param pattern   Path pattern, "" for the whole document.
+     * @param options   Options used to parse each match (e.g. a shared
+     *                  StringDictionary across all matches).
+     * @param chunkSize Bytes requested from @p source per read.
+     * @throws JsonError(InvalidFormat) on a malformed pattern.
+     */
+    SubtreeStream(std::unique_ptr<InputSource> source, std::string_view pattern,
+                  const ParseOptions& options = ParseOptions(),
+                  size_t chunkSize = kDefaultChunkSize);
+
+    /** Open @p filename via openInput() (compressed files included). */
+    static SubtreeStream open(const std::string& filename, std::string_view pattern,
+                              const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Parse the next matching subtree.
+     *
+     * @param value Receives the subtree.
+     * @return false once the document is exhausted.
+     * @throws JsonError on malformed input.
+     */
+    bool next(ValuePtr& value);
+
+    /**
+     * @brief Call @p callback(value) for every remaining match.
+     * @return Number of matches visited.
+     */
+    template <typename Callback>
+    size_t forEach(Callback&& callback) {
+        size_t count = 0;
+        ValuePtr value;
+        while (next(value)) {
+            callback(value);
+            ++count;
+        }
+        return count;
+    }
+
+    /** @return JSON Pointer of the match last returned, e.g. "/items/17". */
+    std::string path() const;
+
+    /** @return Number of input bytes consumed so far. */
+    size_t offset() const noexcept { return dropped_ + pos_; }
+
+private:
+    struct Frame {
+        bool isArray;
+        bool first;
+        size_t index;
+        std::string key;
+    };
+
+    bool fill();
+    int peek();
+    void expect(char c);
+    void skipWhitespace();
+    void scanValue(std::string* out);
+    void readKey(std::string& key);
+    bool matches(const Frame& frame) const;
+    [[noreturn]] void fail(JsonErrorCode code, const char* message) const;
+
+    std::unique_ptr<InputSource> source_;
+    std::vector<JsonPointer::Token> pattern_;
+    ParseOptions options_;
+    size_t chunkSize_;
+
+    std::string buffer_;
+    size_t pos_ = 0;
+    size_t dropped_ = 0;
+    bool eof_ = false;
+
+    std::vector<Frame> stack_;
+    std::string capture_;
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace jsson
+
+#endif // JSSON_SUBTREE_STREAM_HPP
@@ -0,0 +1,292 @@
+#ifndef JSSON_TAPE_HPP
+#define JSSON_TAPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace jsson {
+
+class TapeDocument;
+class TapeArray;
+class TapeObject;
+
+/**
+ * @brief Tag stored in the top byte of every tape word.
+ *
+ * The layout follows the simdjson tape: one 64-bit word per entry, the tag
+ * in bits 56..63 and a 56-bit payload below it.  Numbers occupy two words
+ * (tag word followed by the raw 64-bit value).  A container start word
+ * holds the index one past its matching end word, and the end word holds
+ * the element count, both in the full payload, so skipping a subtree or
+ * asking for its size is O(1).
+ */
+enum class TapeTag : char {
+    Root = 'r',
+    StartObject = '{',
+    EndObject = '}',
+    StartArray = '[',
+    EndArray = ']',
+    String = '"',
+    Int64 = 'l',
+    Double = 'd',
+    True = 't',
+    False = 'f',
+    Null = 'n'
+};
+
+/**
+ * @brief Lightweight, trivially copyable cursor to one value on a tape.
+ *
+ * A TapeRef is only valid while the TapeDocument it points into is alive.
+ */
+class TapeRef {
+public:
+    TapeRef() noexcept = default;
+    TapeRef(const TapeDocument* doc, size_t index) noexcept : doc_(doc), index_(index) {}
+
+    /** @return The tag of the referenced entry. */
+    TapeTag tag() const noexcept;
+
+    bool isNull() const noexcept { return tag() == TapeTag::Null; }
+    bool isBoolean() const noexcept { return tag() == TapeTag::True || tag() == TapeTag::False; }
+    bool isNumber() const noexcept { return tag() == TapeTag::Int64 || tag() == TapeTag::Double; }
+    bool isInteger() const noexcept { return tag() == TapeTag::Int64; }
+    bool isString() const noexcept { return tag() == TapeTag::String; }
+    bool isObject() const noexcept { return tag() == TapeTag::StartObject; }
+    bool isArray() const noexcept { return tag() == TapeTag::StartArray; }
+
+    /** @return The boolean value. Throws if not a boolean. */
+    bool asBoolean() const;
+
+    /** @return The numeric value as double. Throws if not a number. */
+    double asNumber() const;
+
+    /** @return The integer value. Throws if not an integer. */
+    int64_t asInt64() const;
+
+    /** @return View into the document string buffer. Throws if not a string. */
+    std::string_view asString() const;
+
+    /** @return Object cursor. Throws if not an object. */
+    TapeObject asObject() const;
+
+    /** @return Array cursor. Throws if not an array. */
+    TapeArray asArray() const;
+
+    /**
+     * @brief Cursor to the value following this one at the same depth.
+     *
+     * Containers are skipped in O(1) using the end offset stored in their
+     * start word.
+     */
+    TapeRef nextSibling() const noexcept;
+
+    /** @return Index of this entry on the tape. */
+    size_t index() const noexcept { return index_; }
+
+    /** @return The document this cursor points into. */
+    const TapeDocument* document() const noexcept { return doc_; }
+
+    bool operator==(const TapeRef& other) const noexcept {
+        return doc_ == other.doc_ && index_ == other.index_;
+    }
+    bool operator!=(const TapeRef& other) const noexcept { return !(*this == other); }
+
+private:
+    uint64_t word() const noexcept;
+
+    const TapeDocument* doc_ = nullptr;
+    size_t index_ = 0;
+};
+
+/**
+ * @brief Cursor over the elements of a tape array.
+ */
+class TapeArray {
+public:
+    class iterator {
+    public:
+        using value_type = TapeRef;
+        using difference_type = std::ptrdiff_t;
+        using reference = TapeRef;
+        using pointer = void;
+        using iterator_category = std::forward_iterator_tag;
+
+        explicit iterator(TapeRef ref) noexcept : ref_(ref) {}
+        TapeRef operator*() const noexcept { return ref_; }
+        iterator& operator++() noexcept { ref_ = ref_.nextSibling(); return *this; }
+        iterator operator++(int) noexcept { iterator tmp = *this; ++*this; return tmp; }
+        bool operator==(const iterator& other) const noexcept { return ref_ == other.ref_; }
+        bool operator!=(const iterator& other) const noexcept { return ref_ != other.ref_; }
+
+    private:
+        TapeRef ref_;
+    };
+
+    explicit TapeArray(TapeRef start) noexcept : start_(start) {}
+
+    /** @return Number of elements (O(1)). */
+    size_t size() const noexcept;
+
+    bool empty() const noexcept { return begin() == end(); }
+
+    /**
+     * @brief Element at @p index, skipping earlier siblings in O(1) each.
+     * @throws JsonError(IndexOutOfRange) if @p index is past the end.
+     */
+    TapeRef at(size_t index) const;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+private:
+    TapeRef start_;
+};
+
+/**
+ * @brief Cursor over the members of a tape object.
+ *
+ * On the tape every member is a key string entry immediately followed by
+ * its value; iteration yields both as a Member.
+ */
+class TapeObject {
+public:
+    struct Member {
+        std::string_view key;
+        TapeRef value;
+    };
+
+    class iterator {
+    public:
+        using value_type = Member;
+        using difference_type = std::ptrdiff_t;
+        using reference = Member;
+        using pointer = void;
+        using iterator_category = std::forward_iterator_tag;
+
+        explicit iterator(TapeRef key) noexcept : key_(key) {}
+        Member operator*() const;
+        iterator& operator++() noexcept { key_ = key_.nextSibling().nextSibling(); return *this; }
+        iterator operator++(int) noexcept { iterator tmp = *this; ++*this; return tmp; }
+        bool operator==(const iterator& other) const noexcept { return key_ == other.key_; }
+        bool operator!=(const iterator& other) const noexcept { return key_ != other.key_; }
+
+    private:
+        TapeRef key_;
+    };
+
+    explicit TapeObject(TapeRef start) noexcept : start_(start) {}
+
+    /** @return Number of members (O(1)). */
+    size_t size() const noexcept;
+
+    bool empty() const noexcept { return begin() == end(); }
+
+    /**
+     * @brief Linear scan for @p key, skipping member values in O(1) each.
+     * @return Cursor to the value, or std::nullopt when the key is absent.
+     */
+    std::optional<TapeRef> find_field(std::string_view key) const noexcept;
+
+    /** @return Value for @p key. Throws JsonError(ItemNotFound) if missing. */
+    TapeRef at(std::string_view key) const;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+private:
+    TapeRef start_;
+};
+
+/**
+ * @brief Read-only JSON document stored as a flat tape.
+ *
+ * This is an alternative to the JsonValue tree for read-mostly access to
+ * large documents.  The tape and the string buffer live in a single
+ * allocation sized from the input length, so building a document performs
+ * exactly one allocation and both passes over it are sequential.
+ *
+ * Strings are stored in the buffer as a native 32-bit length followed by
+ * the unescaped bytes and a terminating NUL; a longer string is rejected
+ * with JsonError(StringTooLong).
+ *
+ * Cursors hold a pointer to the document, so take them only once the
+ * document has reached its final location (moving it invalidates them).
+ */
+class TapeDocument {
+public:
+    TapeDocument() = default;
+    TapeDocument(TapeDocument&&) noexcept = default;
+    TapeDocument& operator=(TapeDocument&&) noexcept = default;
+    TapeDocument(const TapeDocument&) = delete;
+    TapeDocument& operator=(const TapeDocument&) = delete;
+
+    /**
+     * @brief Parse @p json into a new tape document.
+     * @throws JsonError on malformed input.
+     */
+    static TapeDocument parse(std::string_view json);
+
+    /** @return Cursor to the root value. */
+    TapeRef root() const noexcept { return TapeRef(this, 1); }
+
+    /** @return Number of 64-bit words used on the tape. */
+    size_t tapeSize() const noexcept { return tapeLength_; }
+
+    /** @return Number of bytes used in the string buffer. */
+    size_t stringBufferSize() const noexcept { return stringLength_; }
+
+    /** @return Raw tape word at @p index. */
+    uint64_t word(size_t index) const noexcept { return tape_[index]; }
+
+    /** @return Pointer to the string buffer. */
+    const char* strings() const noexcept { return strings_; }
+
+    /** @return Bytes held by the backing allocation. */
+    size_t capacityBytes() const noexcept { return capacityBytes_; }
+
+    static constexpr uint64_t kPayloadMask = (uint64_t(1) << 56) - 1;
+
+private:
+    friend class TapeBuilder;
+
+    std::unique_ptr<uint64_t[]> storage_;
+    uint64_t* tape_ = nullptr;
+    char* strings_ = nullptr;
+    size_t tapeLength_ = 0;
+    size_t stringLength_ = 0;
+    size_t capacityBytes_ = 0;
+};
+
+/*=====================================================================
+ *  Inline cursor helpers
+ *====================================================================*/
+
+inline uint64_t TapeRef::word() const noexcept {
+    return doc_->word(index_);
+}
+
+inline TapeTag TapeRef::tag() const noexcept {
+    return static_cast<TapeTag>(word() >> 56);
+}
+
+inline TapeRef TapeRef::nextSibling() const noexcept {
+    switch (tag()) {
+        case TapeTag::StartObject:
+        case TapeTag::StartArray:
+            return TapeRef(doc_, static_cast<size_t>(word() & TapeDocument::kPayloadMask));
+        case TapeTag::Int64:
+        case TapeTag::Double:
+            return TapeRef(doc_, index_ + 2);
+        default:
+            return TapeRef(doc_, index_ + 1);
+    }
+}
+
+} // namespace jsson
+
+#endif // JSSON_TAPE_HPP
@@ -0,0 +1,123 @@
+#include "arena.hpp"
+#include "probes.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace jsson {
+
+/* Allocation header: owning arena block, or null for the heap */
+static constexpr size_t kHeaderSize = 8;
+
+static thread_local NodeArena* currentArena = nullptr;
+
+static void releaseBlock(NodeArena::Block* block) noexcept {
+    if (block->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block->~Block();
+        std::free(block);
+    }
+}
+
+/*=====================================================================
+ *  NodeArena
+ *====================================================================*/
+
+NodeArena::NodeArena(size_t blockSize) noexcept
+    : blockSize_(std::max<size_t>(blockSize, 4096)) {}
+
+NodeArena::~NodeArena() {
+    if (current_) {
+        releaseBlock(current_);
+    }
+}
+
+void NodeArena::newBlock(size_t minimum) {
+    size_t size = std::max(blockSize_, minimum + sizeof(Block));
+    void* memory = std::malloc(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    Block* block = new (memory) Block;
+    block->live.store(1, std::memory_order_relaxed); // the arena's own hold
+
+    if (current_) {
+        releaseBlock(current_);
+    }
+    current_ = block;
+    next_ = static_cast<char*>(memory) + sizeof(Block);
+    end_ = static_cast<char*>(memory) + size;
+    ++blocks_;
+    JSSON_PROBE2(arena_block, size, blocks_);
+}
+
+void* NodeArena::allocate(size_t size) {
+    size = (size + 7) & ~static_cast<size_t>(7);
+    if (!current_ || static_cast<size_t>(end_ - next_) < size) {
+        newBlock(size);
+    }
+    void* result = next_;
+    next_ += size;
+    allocated_ += size;
+    current_->live.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+/*=====================================================================
+ *  ArenaScope
+ *====================================================================*/
+
+ArenaScope::ArenaScope(NodeArena& arena) noexcept : previous_(currentArena) {
+    currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    currentArena = previous_;
+}
+
+NodeArena* ArenaScope::current() noexcept {
+    return currentArena;
+}
+
+HeapScope::HeapScope() noexcept : previous_(currentArena) {
+    currentArena = nullptr;
+}
+
+HeapScope::~HeapScope() {
+    currentArena = previous_;
+}
+
+/*=====================================================================
+ *  Node allocation
+ *====================================================================*/
+
+void* allocateNode(size_t size) {
+    char* memory;
+    NodeArena::Block* owner = nullptr;
+    if (NodeArena* arena = currentArena) {
+        memory = static_cast<char*>(arena->allocate(kHeaderSize + size));
+        // The block header sits at the start of the block holding this allocation
+        owner = arena->currentBlock();
+    } else {
+        memory = static_cast<char*>(std::malloc(kHeaderSize + size));
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+    }
+    *reinterpret_cast<NodeArena::Block**>(memory) = owner;
+    return memory + kHeaderSize;
+}
+
+void deallocateNode(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    char* memory = static_cast<char*>(pointer) - kHeaderSize;
+    NodeArena::Block* owner = *reinterpret_cast<NodeArena::Block**>(memory);
+    if (owner) {
+        releaseBlock(owner);
+    } else {
+        std::free(memory);
+    }
+}
+
+} // namespace jsson
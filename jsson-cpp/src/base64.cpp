@@ -0,0 +1,232 @@
+#include "base64.hpp"
+#include "error.hpp"
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define JSSON_BASE64_SSSE3 1
+#endif
+
+namespace jsson {
+
+static const char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Reverse alphabet: 0..63 for valid characters, 0xFF otherwise */
+struct DecodeTable {
+    unsigned char values[256];
+    constexpr DecodeTable() : values() {
+        for (int i = 0; i < 256; ++i) values[i] = 0xFF;
+        for (int i = 0; i < 64; ++i) values[static_cast<unsigned char>(kAlphabet[i])] = static_cast<unsigned char>(i);
+    }
+};
+
+static constexpr DecodeTable kDecode{};
+
+/*=====================================================================
+ *  SSSE3 kernels (Muła / Lemire, aklomp layout)
+ *====================================================================*/
+
+#ifdef JSSON_BASE64_SSSE3
+
+static bool haveSsse3() noexcept {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+/* Encode 12-byte groups while 16 input bytes can be loaded; returns bytes consumed */
+__attribute__((target("ssse3")))
+static size_t encodeSsse3(const unsigned char* in, size_t size, char* out) noexcept {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    while (size - i >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        v = _mm_shuffle_epi8(v, shuffle);
+
+        // Spread the four 6-bit fields of each 3-byte group into bytes
+        const __m128i t0 = _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(v, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        // Map 0..63 onto the alphabet with one shuffle-based offset lookup
+        __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+        const __m128i result = _mm_add_epi8(_mm_shuffle_epi8(shiftLut, reduced), indices);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), result);
+        out += 16;
+        i += 12;
+    }
+    return i;
+}
+
+/*
+ * Decode 16-character groups without padding; stops at the first group
+ * holding anything else so the scalar loop can validate it.  Requires 8
+ * spare input characters so the 16-byte store stays inside the output.
+ */
+__attribute__((target("ssse3")))
+static size_t decodeSsse3(const unsigned char* in, size_t length, unsigned char* out,
+                          size_t& written) noexcept {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2F);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    written = 0;
+    while (length - i >= 24) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+        const __m128i loNibbles = _mm_and_si128(str, mask2F);
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+            break;
+        }
+
+        const __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        str = _mm_add_epi8(str, roll);
+
+        // Pack four 6-bit values per 32-bit lane into three bytes
+        const __m128i mergeAbBc = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(mergeAbBc, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, pack);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), packed);
+        written += 12;
+        i += 16;
+    }
+    return i;
+}
+
+#endif // JSSON_BASE64_SSSE3
+
+/*=====================================================================
+ *  Public API
+ *====================================================================*/
+
+size_t Base64::encode(const void* data, size_t size, char* out) noexcept {
+    const unsigned char* in = static_cast<const unsigned char*>(data);
+    char* const start = out;
+    size_t i = 0;
+
+#ifdef JSSON_BASE64_SSSE3
+    if (haveSsse3()) {
+        i = encodeSsse3(in, size, out);
+        out += i / 3 * 4;
+    }
+#endif
+
+    for (; size - i >= 3; i += 3) {
+        uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+        *out++ = kAlphabet[(v >> 6) & 0x3F];
+        *out++ = kAlphabet[v & 0x3F];
+    }
+
+    if (size - i == 1) {
+        uint32_t v = uint32_t(in[i]) << 16;
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+        *out++ = '=';
+        *out++ = '=';
+    } else if (size - i == 2) {
+        uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8);
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+        *out++ = kAlphabet[(v >> 6) & 0x3F];
+        *out++ = '=';
+    }
+    return static_cast<size_t>(out - start);
+}
+
+size_t Base64::decode(const char* text, size_t length, void* data) {
+    if (length % 4 != 0) {
+        throw JsonError(JsonErrorCode::InvalidFormat, "base64: length is not a multiple of 4");
+    }
+    size_t written = 0;
+    size_t consumed = 0;
+    if (!tryDecode(text, length, data, written, consumed)) {
+        throw JsonError(JsonErrorCode::InvalidFormat, "base64: invalid character or padding");
+    }
+    return written;
+}
+
+bool Base64::tryDecode(const char* text, size_t length, void* data,
+                       size_t& written, size_t& consumed) noexcept {
+    written = 0;
+    consumed = 0;
+    if (length % 4 != 0) {
+        return false;
+    }
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+    unsigned char* out = static_cast<unsigned char*>(data);
+    size_t i = 0;
+    size_t o = 0;
+
+#ifdef JSSON_BASE64_SSSE3
+    if (haveSsse3()) {
+        i = decodeSsse3(in, length, out, o);
+    }
+#endif
+
+    for (; i < length; i += 4) {
+        unsigned a = kDecode.values[in[i]];
+        unsigned b = kDecode.values[in[i + 1]];
+        unsigned c = kDecode.values[in[i + 2]];
+        unsigned d = kDecode.values[in[i + 3]];
+
+        if ((a | b | c | d) <= 0x3F) {
+            uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+            out[o++] = static_cast<unsigned char>(v >> 16);
+            out[o++] = static_cast<unsigned char>(v >> 8);
+            out[o++] = static_cast<unsigned char>(v);
+            continue;
+        }
+
+        // Only the final group may carry padding: "xx==" or "xxx="
+        bool last = (i + 4 == length);
+        if (last && a <= 0x3F && b <= 0x3F && in[i + 2] == '=' && in[i + 3] == '=') {
+            out[o++] = static_cast<unsigned char>((a << 2) | (b >> 4));
+        } else if (last && a <= 0x3F && b <= 0x3F && c <= 0x3F && in[i + 3] == '=') {
+            uint32_t v = (a << 18) | (b << 12) | (c << 6);
+            out[o++] = static_cast<unsigned char>(v >> 16);
+            out[o++] = static_cast<unsigned char>(v >> 8);
+        } else {
+            written = o;
+            consumed = i;
+            return false;
+        }
+    }
+    written = o;
+    consumed = length;
+    return true;
+}
+
+std::string Base64::encode(std::string_view bytes) {
+    std::string result(encodedLength(bytes.size()), '\0');
+    encode(bytes.data(), bytes.size(), &result[0]);
+    return result;
+}
+
+std::string Base64::decode(std::string_view text) {
+    std::string result(maxDecodedLength(text.size()), '\0');
+    result.resize(decode(text.data(), text.size(), &result[0]));
+    return result;
+}
+
+} // namespace jsson
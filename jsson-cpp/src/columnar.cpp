@@ -0,0 +1,727 @@
+#include "columnar.hpp"
+#include "error.hpp"
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace jsson {
+
+static const char kMagic[] = {'J', 'S', 'C', 'B', 1};
+
+/* Bitmap layouts */
+enum : uint8_t {
+    kAllSet = 0,
+    kNoneSet = 1,
+    kExplicit = 2
+};
+
+static JsonError malformed(const char* what) {
+    return JsonError(JsonErrorCode::InvalidFormat, std::string("columnar: ") + what);
+}
+
+/*=====================================================================
+ *  Encoding primitives
+ *====================================================================*/
+
+static void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static unsigned bitWidth(uint64_t value) {
+    unsigned width = 0;
+    while (value) {
+        ++width;
+        value >>= 1;
+    }
+    return width;
+}
+
+/* Packs values of a fixed bit width, least significant bit first */
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out_(out) {}
+
+    void put(uint64_t value, unsigned width) {
+        while (width > 0) {
+            unsigned take = std::min(width, 8 - used_);
+            current_ |= static_cast<uint8_t>((value & ((1u << take) - 1)) << used_);
+            value >>= take;
+            width -= take;
+            used_ += take;
+            if (used_ == 8) {
+                out_.push_back(static_cast<char>(current_));
+                current_ = 0;
+                used_ = 0;
+            }
+        }
+    }
+
+    void finish() {
+        if (used_ > 0) {
+            out_.push_back(static_cast<char>(current_));
+            current_ = 0;
+            used_ = 0;
+        }
+    }
+
+private:
+    std::string& out_;
+    uint8_t current_ = 0;
+    unsigned used_ = 0;
+};
+
+/* Bounds-checked reader over one batch */
+class Cursor {
+public:
+    Cursor(const char* begin, const char* end) : p_(begin), end_(end) {}
+
+    uint8_t byte() {
+        if (p_ == end_) {
+            throw malformed("truncated batch");
+        }
+        return static_cast<uint8_t>(*p_++);
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw malformed("varint too long");
+    }
+
+    std::string_view bytes(uint64_t size) {
+        if (size > static_cast<uint64_t>(end_ - p_)) {
+            throw malformed("truncated batch");
+        }
+        std::string_view result(p_, static_cast<size_t>(size));
+        p_ += size;
+        return result;
+    }
+
+    /* Read @p count values of @p width bits, least significant bit first */
+    template <typename F>
+    void unpack(uint64_t count, unsigned width, F&& emit) {
+        if (width > 64) {
+            throw malformed("bit width over 64");
+        }
+        uint64_t bits = count * width;
+        if (count != 0 && bits / count != width) {
+            throw malformed("bit-packed run too long");
+        }
+        std::string_view packed = bytes((bits + 7) / 8);
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(packed.data());
+        unsigned used = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t value = 0;
+            unsigned shift = 0;
+            for (unsigned left = width; left > 0;) {
+                unsigned take = std::min(left, 8 - used);
+                value |= static_cast<uint64_t>((*p >> used) & ((1u << take) - 1)) << shift;
+                shift += take;
+                left -= take;
+                used += take;
+                if (used == 8) {
+                    ++p;
+                    used = 0;
+                }
+            }
+            emit(value);
+        }
+    }
+
+    bool atEnd() const noexcept { return p_ == end_; }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+static void putBitmap(std::string& out, const std::vector<bool>& bits) {
+    size_t set = static_cast<size_t>(std::count(bits.begin(), bits.end(), true));
+    if (set == bits.size()) {
+        out.push_back(static_cast<char>(kAllSet));
+    } else if (set == 0) {
+        out.push_back(static_cast<char>(kNoneSet));
+    } else {
+        out.push_back(static_cast<char>(kExplicit));
+        BitWriter writer(out);
+        for (bool bit : bits) {
+            writer.put(bit, 1);
+        }
+        writer.finish();
+    }
+}
+
+static std::vector<bool> getBitmap(Cursor& in, size_t rows) {
+    uint8_t layout = in.byte();
+    if (layout == kAllSet || layout == kNoneSet) {
+        return std::vector<bool>(rows, layout == kAllSet);
+    }
+    if (layout != kExplicit) {
+        throw malformed("unknown bitmap layout");
+    }
+    std::vector<bool> bits;
+    bits.reserve(rows);
+    in.unpack(rows, 1, [&](uint64_t bit) { bits.push_back(bit != 0); });
+    return bits;
+}
+
+/*=====================================================================
+ *  ColumnarWriter
+ *====================================================================*/
+
+/* Leaves of one path in the current batch, in row order */
+struct ColumnarWriter::Column {
+    std::string path;
+    std::vector<std::pair<uint32_t, const JsonValue*>> cells;
+};
+
+ColumnarWriter::ColumnarWriter(std::unique_ptr<OutputSink> sink, size_t batchSize)
+    : sink_(std::move(sink)), batchSize_(batchSize ? batchSize : kDefaultBatchSize) {
+    sink_->write(kMagic, sizeof(kMagic));
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() to observe errors
+    }
+}
+
+std::unique_ptr<ColumnarWriter> ColumnarWriter::open(const std::string& filename,
+                                                     Compression format, size_t batchSize) {
+    return std::make_unique<ColumnarWriter>(openOutput(filename, format), batchSize);
+}
+
+/* Append @p key to @p path as an escaped JSON Pointer token */
+static void appendToken(std::string& path, std::string_view key) {
+    path.push_back('/');
+    for (char c : key) {
+        if (c == '~') {
+            path += "~0";
+        } else if (c == '/') {
+            path += "~1";
+        } else {
+            path.push_back(c);
+        }
+    }
+}
+
+void ColumnarWriter::flatten(const JsonValue& value, std::string& path, uint32_t row) {
+    const auto& data = value.raw_variant();
+    const size_t length = path.size();
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data); object && !(*object)->empty()) {
+        for (const auto& [key, member] : (*object)->keys()) {
+            appendToken(path, key);
+            if (member) {
+                flatten(*member, path, row);
+            }
+            path.resize(length);
+        }
+        return;
+    }
+    if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data); ordered && !(*ordered)->empty()) {
+        for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+            appendToken(path, it.key());
+            if (it.value()) {
+                flatten(*it.value(), path, row);
+            }
+            path.resize(length);
+        }
+        return;
+    }
+
+    auto [it, inserted] = index_.emplace(path, columns_.size());
+    if (inserted) {
+        columns_.push_back(Column{path, {}});
+    }
+    columns_[it->second].cells.emplace_back(row, &value);
+}
+
+void ColumnarWriter::write(const ValuePtr& record) {
+    if (closed_) {
+        throw JsonError(JsonErrorCode::InvalidArgument, "columnar: writer is closed");
+    }
+    std::string path;
+    uint32_t row = static_cast<uint32_t>(records_.size());
+    records_.push_back(record);
+    if (record) {
+        flatten(*record, path, row);
+    }
+    ++count_;
+    if (records_.size() >= batchSize_) {
+        flush();
+    }
+}
+
+/* Pick the narrowest type holding every non-null value */
+static ColumnType classify(const std::vector<const JsonValue*>& values) {
+    if (values.empty()) {
+        return ColumnType::Null;
+    }
+    bool ints = true, numbers = true, booleans = true, strings = true;
+    for (const JsonValue* value : values) {
+        ints = ints && std::holds_alternative<int64_t>(value->raw_variant());
+        numbers = numbers && value->isNumber();
+        booleans = booleans && value->isBoolean();
+        strings = strings && value->isString();
+    }
+    if (ints) return ColumnType::Int64;
+    if (numbers) return ColumnType::Double;
+    if (booleans) return ColumnType::Boolean;
+    if (strings) return ColumnType::String;
+    return ColumnType::Json;
+}
+
+static void putText(std::string& out, std::string_view text) {
+    putVarint(out, text.size());
+    out.append(text);
+}
+
+/* Encode one column block; returns its encoding */
+static ColumnEncoding encodeColumn(const std::vector<std::pair<uint32_t, const JsonValue*>>& cells,
+                                   size_t rows, ColumnType& type, std::string& out) {
+    std::vector<bool> present(rows, false);
+    std::vector<bool> nulls(rows, false);
+    std::vector<const JsonValue*> values;
+    values.reserve(cells.size());
+    for (const auto& [row, value] : cells) {
+        present[row] = true;
+        if (value->isNull()) {
+            nulls[row] = true;
+        } else {
+            values.push_back(value);
+        }
+    }
+    putBitmap(out, present);
+    putBitmap(out, nulls);
+
+    type = classify(values);
+    switch (type) {
+        case ColumnType::Null:
+            return ColumnEncoding::Plain;
+
+        case ColumnType::Int64: {
+            // First value, then zigzag deltas at the width of the widest one
+            std::vector<uint64_t> deltas;
+            deltas.reserve(values.size());
+            uint64_t previous = 0;
+            uint64_t widest = 0;
+            for (const JsonValue* value : values) {
+                uint64_t current = static_cast<uint64_t>(std::get<int64_t>(value->raw_variant()));
+                // Wrapping subtraction; zigzag of the signed result stays exact
+                deltas.push_back(zigzag(static_cast<int64_t>(current - previous)));
+                widest |= deltas.back();
+                previous = current;
+            }
+            unsigned width = bitWidth(widest);
+            out.push_back(static_cast<char>(width));
+            BitWriter writer(out);
+            for (uint64_t delta : deltas) {
+                writer.put(delta, width);
+            }
+            writer.finish();
+            return ColumnEncoding::Delta;
+        }
+
+        case ColumnType::Double: {
+            // Which values are integers, so int64 ones keep every bit
+            std::vector<bool> integers;
+            integers.reserve(values.size());
+            for (const JsonValue* value : values) {
+                integers.push_back(std::holds_alternative<int64_t>(value->raw_variant()));
+            }
+            putBitmap(out, integers);
+            for (const JsonValue* value : values) {
+                uint64_t bits;
+                if (auto i = std::get_if<int64_t>(&value->raw_variant())) {
+                    bits = static_cast<uint64_t>(*i);
+                } else {
+                    double number = value->asNumber();
+                    std::memcpy(&bits, &number, sizeof(bits));
+                }
+                for (int shift = 0; shift < 64; shift += 8) {
+                    out.push_back(static_cast<char>(bits >> shift));
+                }
+            }
+            return ColumnEncoding::Plain;
+        }
+
+        case ColumnType::Boolean: {
+            BitWriter writer(out);
+            for (const JsonValue* value : values) {
+                writer.put(value->asBoolean(), 1);
+            }
+            writer.finish();
+            return ColumnEncoding::Plain;
+        }
+
+        case ColumnType::String: {
+            std::unordered_map<std::string_view, uint32_t> ids;
+            std::vector<std::string_view> dictionary;
+            std::vector<uint64_t> indices;
+            indices.reserve(values.size());
+            for (const JsonValue* value : values) {
+                auto [it, inserted] = ids.emplace(value->asStringView(), static_cast<uint32_t>(dictionary.size()));
+                if (inserted) {
+                    dictionary.push_back(it->first);
+                }
+                indices.push_back(it->second);
+            }
+            // A dictionary pays off once values repeat on average
+            if (dictionary.size() * 2 <= values.size()) {
+                putVarint(out, dictionary.size());
+                for (std::string_view text : dictionary) {
+                    putText(out, text);
+                }
+                unsigned width = bitWidth(dictionary.size() - 1);
+                out.push_back(static_cast<char>(width));
+                BitWriter writer(out);
+                for (uint64_t index : indices) {
+                    writer.put(index, width);
+                }
+                writer.finish();
+                return ColumnEncoding::Dictionary;
+            }
+            for (const JsonValue* value : values) {
+                putText(out, value->asStringView());
+            }
+            return ColumnEncoding::Plain;
+        }
+
+        case ColumnType::Json:
+            for (const JsonValue* value : values) {
+                putText(out, value->toString());
+            }
+            return ColumnEncoding::Plain;
+    }
+    return ColumnEncoding::Plain;
+}
+
+void ColumnarWriter::flush() {
+    if (records_.empty()) {
+        return;
+    }
+    const size_t rows = records_.size();
+    std::string directory;
+    std::string blocks;
+    putVarint(directory, rows);
+    putVarint(directory, columns_.size());
+    for (const Column& column : columns_) {
+        size_t start = blocks.size();
+        ColumnType type;
+        ColumnEncoding encoding = encodeColumn(column.cells, rows, type, blocks);
+        putText(directory, column.path);
+        directory.push_back(static_cast<char>(type));
+        directory.push_back(static_cast<char>(encoding));
+        putVarint(directory, blocks.size() - start);
+    }
+
+    std::string length;
+    putVarint(length, directory.size() + blocks.size());
+    sink_->write(length.data(), length.size());
+    sink_->write(directory.data(), directory.size());
+    sink_->write(blocks.data(), blocks.size());
+
+    records_.clear();
+    columns_.clear();
+    index_.clear();
+}
+
+void ColumnarWriter::close() {
+    if (closed_) {
+        return;
+    }
+    flush();
+    closed_ = true;
+    sink_->close();
+}
+
+/*=====================================================================
+ *  ColumnarReader
+ *====================================================================*/
+
+ColumnarReader::ColumnarReader(std::unique_ptr<InputSource> source) : source_(std::move(source)) {
+    if (!fill(sizeof(kMagic)) || std::memcmp(buffer_.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw malformed("not a columnar batch file");
+    }
+    pos_ = sizeof(kMagic);
+}
+
+ColumnarReader ColumnarReader::open(const std::string& filename) {
+    return ColumnarReader(openInput(filename));
+}
+
+/* Make @p size bytes from pos_ available; false if the input ends first */
+bool ColumnarReader::fill(size_t size) {
+    if (pos_ > 0 && buffer_.size() - pos_ < size) {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+    }
+    while (buffer_.size() - pos_ < size) {
+        size_t old = buffer_.size();
+        size_t chunk = std::max<size_t>(size - (old - pos_), 64 * 1024);
+        buffer_.resize(old + chunk);
+        size_t n = source_->read(&buffer_[old], chunk);
+        buffer_.resize(old + n);
+        if (n == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ColumnarReader::select(std::vector<std::string> paths) {
+    selection_ = std::move(paths);
+}
+
+bool ColumnarReader::selected(const std::string& path) const {
+    if (selection_.empty()) {
+        return true;
+    }
+    for (const std::string& prefix : selection_) {
+        if (path.compare(0, prefix.size(), prefix) == 0 &&
+            (path.size() == prefix.size() || path[prefix.size()] == '/')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Store @p value at @p pointer inside @p root, creating objects on the way */
+static void place(ValuePtr& root, const JsonPointer& pointer, ValuePtr value) {
+    if (pointer.empty()) {
+        root = std::move(value);
+        return;
+    }
+    if (!root) {
+        root = makeRef<JsonValue>(JsonObject());
+    }
+    JsonValue* node = root.get();
+    const auto& tokens = pointer.tokens();
+    for (size_t i = 0;; ++i) {
+        auto object = std::get_if<std::unique_ptr<JsonObject>>(&node->raw_variant());
+        if (!object) {
+            throw malformed("column path crosses a leaf");
+        }
+        ValuePtr& slot = (*object)->keys()[tokens[i].key];
+        if (i + 1 == tokens.size()) {
+            slot = std::move(value);
+            return;
+        }
+        if (!slot) {
+            slot = makeRef<JsonValue>(JsonObject());
+        }
+        node = slot.get();
+    }
+}
+
+/* Decode one column block into the rows of @p records */
+static void decodeColumn(const ColumnInfo& column, Cursor in, std::vector<ValuePtr>& records) {
+    const size_t rows = records.size();
+    std::vector<bool> present = getBitmap(in, rows);
+    std::vector<bool> nulls = getBitmap(in, rows);
+    size_t count = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        count += present[row] && !nulls[row];
+    }
+
+    std::vector<ValuePtr> values;
+    values.reserve(count);
+    switch (column.type) {
+        case ColumnType::Null:
+            break;
+        case ColumnType::Int64: {
+            if (column.encoding != ColumnEncoding::Delta) {
+                throw malformed("unknown integer encoding");
+            }
+            unsigned width = in.byte();
+            uint64_t previous = 0;
+            in.unpack(count, width, [&](uint64_t delta) {
+                previous += static_cast<uint64_t>(unzigzag(delta));
+                values.push_back(makeRef<JsonValue>(static_cast<int64_t>(previous)));
+            });
+            break;
+        }
+        case ColumnType::Double: {
+            std::vector<bool> integers = getBitmap(in, count);
+            for (size_t i = 0; i < count; ++i) {
+                std::string_view bytes = in.bytes(8);
+                uint64_t bits = 0;
+                for (int b = 7; b >= 0; --b) {
+                    bits = (bits << 8) | static_cast<unsigned char>(bytes[static_cast<size_t>(b)]);
+                }
+                if (integers[i]) {
+                    values.push_back(makeRef<JsonValue>(static_cast<int64_t>(bits)));
+                } else {
+                    double number;
+                    std::memcpy(&number, &bits, sizeof(number));
+                    values.push_back(makeRef<JsonValue>(number));
+                }
+            }
+            break;
+        }
+        case ColumnType::Boolean:
+            in.unpack(count, 1, [&](uint64_t bit) { values.push_back(makeRef<JsonValue>(bit != 0)); });
+            break;
+        case ColumnType::String:
+        case ColumnType::Json: {
+            auto make = [&](std::string_view text) {
+                values.push_back(column.type == ColumnType::Json ? Parser::parseText(text)
+                                                                 : makeRef<JsonValue>(std::string(text)));
+            };
+            if (column.encoding == ColumnEncoding::Dictionary) {
+                std::vector<std::string_view> dictionary(in.varint());
+                for (std::string_view& text : dictionary) {
+                    text = in.bytes(in.varint());
+                }
+                unsigned width = in.byte();
+                in.unpack(count, width, [&](uint64_t index) {
+                    if (index >= dictionary.size()) {
+                        throw malformed("dictionary index out of range");
+                    }
+                    make(dictionary[index]);
+                });
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    make(in.bytes(in.varint()));
+                }
+            }
+            break;
+        }
+        default:
+            throw malformed("unknown column type");
+    }
+
+    JsonPointer pointer(column.path);
+    size_t next = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        if (!present[row]) {
+            continue;
+        }
+        if (nulls[row]) {
+            place(records[row], pointer, makeRef<JsonValue>());
+            continue;
+        }
+        // A null-typed column carries no values for rows its bitmaps call non-null
+        if (next >= values.size()) {
+            throw malformed("column has fewer values than rows");
+        }
+        place(records[row], pointer, values[next++]);
+    }
+}
+
+bool ColumnarReader::nextBatch(std::vector<ValuePtr>& records) {
+    // Batch length varint; a clean end of input may only come before it
+    uint64_t length = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        if (!fill(1)) {
+            if (shift == 0) {
+                return false;
+            }
+            throw malformed("truncated batch length");
+        }
+        uint8_t b = static_cast<uint8_t>(buffer_[pos_++]);
+        if (shift >= 63 && b > 1) {
+            throw malformed("varint too long");
+        }
+        length |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+    }
+    if (!fill(length)) {
+        throw malformed("truncated batch");
+    }
+    const char* begin = buffer_.data() + pos_;
+    pos_ += length;
+
+    Cursor in(begin, begin + length);
+    uint64_t rows = in.varint();
+    uint64_t count = in.varint();
+    if (rows > length * 8 + 8 || count > length) {
+        throw malformed("implausible batch header");
+    }
+    columns_.clear();
+    columns_.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        ColumnInfo info;
+        info.path = std::string(in.bytes(in.varint()));
+        info.type = static_cast<ColumnType>(in.byte());
+        info.encoding = static_cast<ColumnEncoding>(in.byte());
+        info.bytes = in.varint();
+        columns_.push_back(std::move(info));
+    }
+
+    records.assign(rows, nullptr);
+    for (const ColumnInfo& column : columns_) {
+        // Unselected blocks are skipped without decoding
+        std::string_view bytes = in.bytes(column.bytes);
+        if (selected(column.path)) {
+            decodeColumn(column, Cursor(bytes.data(), bytes.data() + bytes.size()), records);
+        }
+    }
+    for (ValuePtr& record : records) {
+        if (!record) {
+            record = makeRef<JsonValue>(JsonObject());
+        }
+    }
+    return true;
+}
+
+bool ColumnarReader::next(ValuePtr& record) {
+    while (next_ == pending_.size()) {
+        next_ = 0;
+        if (!nextBatch(pending_)) {
+            pending_.clear();
+            return false;
+        }
+    }
+    record = std::move(pending_[next_++]);
+    return true;
+}
+
+/*=====================================================================
+ *  Conversion
+ *====================================================================*/
+
+size_t ndjsonToColumnar(NdjsonReader& in, ColumnarWriter& out) {
+    size_t copied = 0;
+    ValuePtr record;
+    while (in.next(record)) {
+        out.write(record);
+        ++copied;
+    }
+    return copied;
+}
+
+size_t columnarToNdjson(ColumnarReader& in, NdjsonWriter& out) {
+    size_t copied = 0;
+    ValuePtr record;
+    while (in.next(record)) {
+        out.write(record);
+        ++copied;
+    }
+    return copied;
+}
+
+} // namespace jsson
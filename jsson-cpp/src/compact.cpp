@@ -0,0 +1,145 @@
+#include "compact.hpp"
+#include <cstdint>
+#include <unordered_set>
+
+namespace jsson {
+
+/*=====================================================================
+ *  Layout statistics
+ *====================================================================*/
+
+namespace {
+
+struct LayoutWalker {
+    static constexpr uintptr_t kPageBits = 12;
+
+    LayoutStats stats;
+    std::unordered_set<uintptr_t> pages;
+    uintptr_t previous = 0;
+
+    void visit(const JsonValue& value) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(&value);
+        if (stats.nodes > 0) {
+            if ((address >> kPageBits) != (previous >> kPageBits)) {
+                ++stats.pageSwitches;
+            }
+            if (address < previous) {
+                ++stats.backwardSteps;
+            }
+        }
+        pages.insert(address >> kPageBits);
+        previous = address;
+        ++stats.nodes;
+
+        const auto& data = value.raw_variant();
+        if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+            for (const auto& entry : (*object)->keys()) {
+                if (entry.second) visit(*entry.second);
+            }
+        } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+            for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+                if (it.value()) visit(*it.value());
+            }
+        } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+            for (const auto& element : (*array)->data()) {
+                if (element) visit(*element);
+            }
+        }
+    }
+};
+
+} // namespace
+
+LayoutStats analyzeLayout(const JsonValue& root) {
+    LayoutWalker walker;
+    walker.visit(root);
+    walker.stats.pages = walker.pages.size();
+    return walker.stats;
+}
+
+/*=====================================================================
+ *  Relocation
+ *====================================================================*/
+
+static ValuePtr relocate(const ValuePtr& source);
+
+/* Copy the children of @p source into the (empty) container of @p target */
+static void relocateChildren(const JsonValue& target, const JsonValue& source) {
+    const auto& from = source.raw_variant();
+    const auto& to = target.raw_variant();
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&from)) {
+        const JsonObject::Map& in = (*object)->keys();
+        JsonObject::Map& map = std::get<std::unique_ptr<JsonObject>>(to)->keys();
+        map.reserve(in.size());
+        // All map nodes first, then the children in the new map's own
+        // iteration order, so a traversal of the copy moves forwards
+        for (const auto& entry : in) {
+            map.emplace(entry.first, ValuePtr());
+        }
+        for (auto& entry : map) {
+            entry.second = relocate(in.find(entry.first)->second);
+        }
+    } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&from)) {
+        OrderedObject& out = *std::get<std::unique_ptr<OrderedObject>>(to);
+        for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+            out.insert(it.key(), relocate(it.value()));
+        }
+    } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&from)) {
+        JsonArray::Vec& vec = std::get<std::unique_ptr<JsonArray>>(to)->data();
+        vec.reserve((*array)->size());
+        for (const auto& element : (*array)->data()) {
+            vec.push_back(relocate(element));
+        }
+    }
+}
+
+/* Pre-order copy of a subtree owned only by its parent */
+static ValuePtr relocate(const ValuePtr& source) {
+    if (!source || source.use_count() > 1) {
+        return source;
+    }
+    ValuePtr node;
+    if (source->isOrderedObject()) {
+        node = makeRef<JsonValue>(OrderedObject());
+    } else if (source->isObject()) {
+        node = makeRef<JsonValue>(JsonObject());
+    } else if (source->isArray()) {
+        node = makeRef<JsonValue>(JsonArray());
+    } else {
+        node = makeRef<JsonValue>(*source);
+    }
+    node->setAtomicRefCount(source->hasAtomicRefCount());
+    relocateChildren(*node, *source);
+    return node;
+}
+
+CompactionReport compact(JsonValue& root, size_t blockSize) {
+    CompactionReport report;
+    report.before = analyzeLayout(root);
+
+    JsonValue rebuilt;
+    {
+        NodeArena arena(blockSize);
+        ArenaScope scope(arena);
+        if (root.isOrderedObject()) {
+            rebuilt = JsonValue(OrderedObject());
+        } else if (root.isObject()) {
+            rebuilt = JsonObject();
+        } else if (root.isArray()) {
+            rebuilt = JsonArray();
+        } else {
+            rebuilt = root;
+        }
+        relocateChildren(rebuilt, root);
+        report.arenaBytes = arena.bytesAllocated();
+        report.arenaBlocks = arena.blockCount();
+    }
+
+    // Swap the finished copy in; the old nodes are released here
+    root = std::move(rebuilt);
+
+    report.after = analyzeLayout(root);
+    return report;
+}
+
+} // namespace jsson
@@ -0,0 +1,587 @@
+#include "compression.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef JSSON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef JSSON_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace jsson {
+
+/*=====================================================================
+ *  Format helpers
+ *====================================================================*/
+
+Compression detectCompression(const unsigned char* magic, size_t size) noexcept {
+    if (size >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        return Compression::Gzip;
+    }
+    if (size >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+bool compressionSupported(Compression format) noexcept {
+    switch (format) {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+#ifdef JSSON_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Zstd:
+#ifdef JSSON_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char* compressionName(Compression format) noexcept {
+    switch (format) {
+        case Compression::None: return "none";
+        case Compression::Gzip: return "gzip";
+        case Compression::Zstd: return "zstd";
+    }
+    return "unknown";
+}
+
+/*=====================================================================
+ *  BlockRing
+ *====================================================================*/
+
+BlockRing::BlockRing(size_t blockSize, size_t blocks)
+    : blocks_(std::max<size_t>(blocks, 2)), blockSize_(blockSize) {
+    for (auto& block : blocks_) {
+        block.data.reset(new char[blockSize_]);
+    }
+}
+
+BlockRing::Block* BlockRing::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [this] { return closed_ || count_ < blocks_.size(); });
+    if (closed_) {
+        return nullptr;
+    }
+    Block* block = &blocks_[(head_ + count_) % blocks_.size()];
+    block->size = 0;
+    return block;
+}
+
+void BlockRing::publish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++count_;
+    }
+    notEmpty_.notify_one();
+}
+
+BlockRing::Block* BlockRing::front() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait(lock, [this] { return closed_ || count_ > 0; });
+    if (count_ == 0) {
+        return nullptr;
+    }
+    return &blocks_[head_];
+}
+
+void BlockRing::pop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        head_ = (head_ + 1) % blocks_.size();
+        --count_;
+    }
+    notFull_.notify_one();
+}
+
+void BlockRing::close(std::exception_ptr error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        if (error && !error_) {
+            error_ = error;
+        }
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+}
+
+void BlockRing::rethrowIfFailed() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error = error_;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/*=====================================================================
+ *  Decoder backends
+ *====================================================================*/
+
+class DecompressingSource::Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /**
+     * @brief Decode as much of @p in into @p out as fits.
+     * @param consumed Set to the number of input bytes used.
+     * @return Number of bytes written to @p out.
+     */
+    virtual size_t decode(const char* in, size_t inSize, size_t& consumed,
+                          char* out, size_t outCap) = 0;
+
+    /** @return true if the input seen so far ends on a member/frame boundary. */
+    virtual bool atBoundary() const noexcept = 0;
+};
+
+#ifdef JSSON_HAVE_ZLIB
+/* gzip (and zlib) through the system zlib; handles multi-member files */
+class GzipDecoder : public DecompressingSource::Decoder {
+public:
+    GzipDecoder() {
+        std::memset(&stream_, 0, sizeof(stream_));
+        // 15 window bits + 32: detect gzip or zlib headers automatically
+        if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+            throw JsonError(JsonErrorCode::OutOfMemory, "inflateInit2 failed");
+        }
+    }
+
+    ~GzipDecoder() override { inflateEnd(&stream_); }
+
+    size_t decode(const char* in, size_t inSize, size_t& consumed,
+                  char* out, size_t outCap) override {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        stream_.avail_in = static_cast<uInt>(std::min<size_t>(inSize, UINT32_MAX));
+        stream_.next_out = reinterpret_cast<Bytef*>(out);
+        stream_.avail_out = static_cast<uInt>(std::min<size_t>(outCap, UINT32_MAX));
+
+        int ret = inflate(&stream_, Z_NO_FLUSH);
+        consumed = static_cast<size_t>(reinterpret_cast<char*>(stream_.next_in) - in);
+        size_t produced = static_cast<size_t>(reinterpret_cast<char*>(stream_.next_out) - out);
+
+        if (ret == Z_STREAM_END) {
+            boundary_ = true;
+            inflateReset(&stream_);
+        } else if (ret == Z_OK) {
+            if (consumed > 0 || produced > 0) boundary_ = false;
+        } else if (ret != Z_BUF_ERROR) {
+            throw JsonError(JsonErrorCode::InvalidFormat,
+                            std::string("gzip: ") + (stream_.msg ? stream_.msg : "corrupt stream"));
+        }
+        return produced;
+    }
+
+    bool atBoundary() const noexcept override { return boundary_; }
+
+private:
+    z_stream stream_;
+    bool boundary_ = false;
+};
+#endif
+
+#ifdef JSSON_HAVE_ZSTD
+/* zstd streaming decoder; concatenated frames decode transparently */
+class ZstdDecoder : public DecompressingSource::Decoder {
+public:
+    ZstdDecoder() : stream_(ZSTD_createDStream()) {
+        if (!stream_) {
+            throw JsonError(JsonErrorCode::OutOfMemory, "ZSTD_createDStream failed");
+        }
+        ZSTD_initDStream(stream_);
+    }
+
+    ~ZstdDecoder() override { ZSTD_freeDStream(stream_); }
+
+    size_t decode(const char* in, size_t inSize, size_t& consumed,
+                  char* out, size_t outCap) override {
+        ZSTD_inBuffer input = {in, inSize, 0};
+        ZSTD_outBuffer output = {out, outCap, 0};
+        size_t ret = ZSTD_decompressStream(stream_, &output, &input);
+        if (ZSTD_isError(ret)) {
+            throw JsonError(JsonErrorCode::InvalidFormat,
+                            std::string("zstd: ") + ZSTD_getErrorName(ret));
+        }
+        consumed = input.pos;
+        if (consumed > 0 || output.pos > 0) {
+            boundary_ = (ret == 0);
+        }
+        return output.pos;
+    }
+
+    bool atBoundary() const noexcept override { return boundary_; }
+
+private:
+    ZSTD_DStream* stream_;
+    bool boundary_ = false;
+};
+#endif
+
+static std::unique_ptr<DecompressingSource::Decoder> makeDecoder(Compression format) {
+    switch (format) {
+#ifdef JSSON_HAVE_ZLIB
+        case Compression::Gzip:
+            return std::make_unique<GzipDecoder>();
+#endif
+#ifdef JSSON_HAVE_ZSTD
+        case Compression::Zstd:
+            return std::make_unique<ZstdDecoder>();
+#endif
+        default:
+            throw JsonError(JsonErrorCode::InvalidFormat,
+                            std::string("Unsupported compression: ") + compressionName(format));
+    }
+}
+
+/*=====================================================================
+ *  DecompressingSource
+ *====================================================================*/
+
+DecompressingSource::DecompressingSource(std::unique_ptr<InputSource> raw, Compression format,
+                                         size_t blockSize, size_t blocks)
+    : raw_(std::move(raw)),
+      decoder_(makeDecoder(format)),
+      ring_(blockSize, blocks) {
+    worker_ = std::thread(&DecompressingSource::run, this);
+}
+
+DecompressingSource::~DecompressingSource() {
+    ring_.close();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+/* Worker thread: fill ring blocks with decompressed data until EOF */
+void DecompressingSource::run() {
+    try {
+        std::unique_ptr<char[]> input(new char[ring_.blockSize()]);
+        size_t inPos = 0;
+        size_t inLen = 0;
+        bool eof = false;
+        bool finished = false;
+
+        while (!finished) {
+            BlockRing::Block* block = ring_.acquire();
+            if (!block) {
+                return; // consumer went away
+            }
+            while (block->size < ring_.blockSize()) {
+                if (inPos == inLen && !eof) {
+                    inLen = raw_->read(input.get(), ring_.blockSize());
+                    inPos = 0;
+                    eof = (inLen == 0);
+                }
+                size_t consumed = 0;
+                size_t produced = decoder_->decode(input.get() + inPos, inLen - inPos, consumed,
+                                                   block->data.get() + block->size,
+                                                   ring_.blockSize() - block->size);
+                inPos += consumed;
+                block->size += produced;
+                if (consumed == 0 && produced == 0) {
+                    if (eof) {
+                        finished = true;
+                        break;
+                    }
+                    if (inPos < inLen) {
+                        throw JsonError(JsonErrorCode::InvalidFormat, "Decompressor made no progress");
+                    }
+                }
+            }
+            if (block->size > 0) {
+                ring_.publish();
+            }
+        }
+        if (!decoder_->atBoundary()) {
+            throw JsonError(JsonErrorCode::PrematureEndOfInput, "Truncated compressed stream");
+        }
+        ring_.close();
+    } catch (...) {
+        ring_.close(std::current_exception());
+    }
+}
+
+size_t DecompressingSource::read(char* buf, size_t cap) {
+    BlockRing::Block* block = ring_.front();
+    if (!block) {
+        ring_.rethrowIfFailed();
+        return 0;
+    }
+    size_t n = std::min(cap, block->size - offset_);
+    std::memcpy(buf, block->data.get() + offset_, n);
+    offset_ += n;
+    if (offset_ == block->size) {
+        ring_.pop();
+        offset_ = 0;
+    }
+    return n;
+}
+
+/*=====================================================================
+ *  Encoder backends
+ *====================================================================*/
+
+class CompressingSink::Encoder {
+public:
+    virtual ~Encoder() = default;
+
+    /** Compress @p in into a self-contained member/frame in @p out. */
+    virtual void encode(const std::string& in, std::string& out) = 0;
+};
+
+#ifdef JSSON_HAVE_ZLIB
+/* Each block becomes one complete gzip member */
+class GzipEncoder : public CompressingSink::Encoder {
+public:
+    explicit GzipEncoder(int level) {
+        std::memset(&stream_, 0, sizeof(stream_));
+        // 15 window bits + 16: write a gzip header and trailer
+        if (deflateInit2(&stream_, level ? level : Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw JsonError(JsonErrorCode::OutOfMemory, "deflateInit2 failed");
+        }
+    }
+
+    ~GzipEncoder() override { deflateEnd(&stream_); }
+
+    void encode(const std::string& in, std::string& out) override {
+        out.resize(deflateBound(&stream_, static_cast<uLong>(in.size())));
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream_.avail_in = static_cast<uInt>(in.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream_.avail_out = static_cast<uInt>(out.size());
+        int ret = deflate(&stream_, Z_FINISH);
+        if (ret != Z_STREAM_END) {
+            deflateReset(&stream_);
+            throw JsonError(JsonErrorCode::InvalidFormat, "gzip: deflate failed");
+        }
+        out.resize(stream_.total_out);
+        deflateReset(&stream_);
+    }
+
+private:
+    z_stream stream_;
+};
+#endif
+
+#ifdef JSSON_HAVE_ZSTD
+/* Each block becomes one complete zstd frame */
+class ZstdEncoder : public CompressingSink::Encoder {
+public:
+    explicit ZstdEncoder(int level)
+        : context_(ZSTD_createCCtx()), level_(level ? level : ZSTD_CLEVEL_DEFAULT) {
+        if (!context_) {
+            throw JsonError(JsonErrorCode::OutOfMemory, "ZSTD_createCCtx failed");
+        }
+    }
+
+    ~ZstdEncoder() override { ZSTD_freeCCtx(context_); }
+
+    void encode(const std::string& in, std::string& out) override {
+        out.resize(ZSTD_compressBound(in.size()));
+        size_t ret = ZSTD_compressCCtx(context_, &out[0], out.size(), in.data(), in.size(), level_);
+        if (ZSTD_isError(ret)) {
+            throw JsonError(JsonErrorCode::InvalidFormat,
+                            std::string("zstd: ") + ZSTD_getErrorName(ret));
+        }
+        out.resize(ret);
+    }
+
+private:
+    ZSTD_CCtx* context_;
+    int level_;
+};
+#endif
+
+static std::unique_ptr<CompressingSink::Encoder> makeEncoder(Compression format, int level) {
+    switch (format) {
+#ifdef JSSON_HAVE_ZLIB
+        case Compression::Gzip:
+            return std::make_unique<GzipEncoder>(level);
+#endif
+#ifdef JSSON_HAVE_ZSTD
+        case Compression::Zstd:
+            return std::make_unique<ZstdEncoder>(level);
+#endif
+        default:
+            (void)level;
+            throw JsonError(JsonErrorCode::InvalidFormat,
+                            std::string("Unsupported compression: ") + compressionName(format));
+    }
+}
+
+/*=====================================================================
+ *  CompressingSink
+ *====================================================================*/
+
+CompressingSink::CompressingSink(std::unique_ptr<OutputSink> downstream, Compression format,
+                                 unsigned threads, int level, size_t blockSize)
+    : downstream_(std::move(downstream)),
+      format_(format),
+      level_(level),
+      blockSize_(blockSize ? blockSize : kDefaultBlockSize) {
+    makeEncoder(format_, level_); // fail early on unsupported formats
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    maxInFlight_ = 2 * static_cast<size_t>(threads);
+    current_.reserve(blockSize_);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back(&CompressingSink::worker, this);
+    }
+}
+
+CompressingSink::~CompressingSink() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() to observe errors
+    }
+    stopWorkers();
+}
+
+void CompressingSink::worker() {
+    std::unique_ptr<Encoder> encoder;
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workReady_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = queue_.front();
+            queue_.pop_front();
+        }
+
+        try {
+            if (!encoder) {
+                encoder = makeEncoder(format_, level_);
+            }
+            encoder->encode(job->input, job->output);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        std::string().swap(job->input);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->done = true;
+        }
+        jobDone_.notify_all();
+    }
+}
+
+void CompressingSink::stopWorkers() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workReady_.notify_all();
+    for (auto& thread : workers_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+/* Hand the current block to the workers */
+void CompressingSink::submit() {
+    auto job = std::make_shared<Job>();
+    job->input.swap(current_);
+    current_.reserve(blockSize_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(job);
+        queue_.push_back(job);
+    }
+    workReady_.notify_one();
+    writeCompleted(false);
+}
+
+/*
+ * Write finished blocks downstream in submission order.  Without @p wait
+ * this only blocks while too many blocks are in flight.
+ */
+void CompressingSink::writeCompleted(bool wait) {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+            if (pending_.empty()) {
+                return;
+            }
+            if (!pending_.front()->done) {
+                if (!wait && pending_.size() < maxInFlight_) {
+                    return;
+                }
+                jobDone_.wait(lock, [this] { return pending_.front()->done; });
+                continue;
+            }
+            job = pending_.front();
+            pending_.pop_front();
+        }
+        downstream_->write(job->output.data(), job->output.size());
+        wroteAny_ = true;
+    }
+}
+
+void CompressingSink::write(const char* data, size_t size) {
+    if (closed_) {
+        throw JsonError(JsonErrorCode::InvalidArgument, "Write to closed sink");
+    }
+    while (size > 0) {
+        size_t n = std::min(size, blockSize_ - current_.size());
+        current_.append(data, n);
+        data += n;
+        size -= n;
+        if (current_.size() == blockSize_) {
+            submit();
+        }
+    }
+}
+
+void CompressingSink::flush() {
+    if (closed_) {
+        return;
+    }
+    if (!current_.empty()) {
+        submit();
+    }
+    writeCompleted(true);
+    downstream_->flush();
+}
+
+void CompressingSink::close() {
+    if (closed_) {
+        return;
+    }
+    // An empty stream still gets one (empty) member so it stays decodable
+    if (!current_.empty() || (!wroteAny_ && pending_.empty())) {
+        submit();
+    }
+    writeCompleted(true);
+    closed_ = true;
+    stopWorkers();
+    downstream_->close();
+}
+
+} // namespace jsson
@@ -0,0 +1,82 @@
+#include "concurrent_object.hpp"
+#include <vector>
+
+namespace jsson {
+
+ConcurrentObject::ConcurrentObject(const JsonObject& object, size_t shards) : table_(shards) {
+    for (const auto& entry : object) {
+        set(entry.first, entry.second);
+    }
+}
+
+void ConcurrentObject::publish(const ValuePtr& value) {
+    // Readers copy handles to any node they reach, so the whole subtree goes
+    // atomic.  Nodes not yet atomic are private to the writer and safe to
+    // switch; nodes already shared are atomic and only read here.
+    std::vector<JsonValue*> pending{value.get()};
+    while (!pending.empty()) {
+        JsonValue* node = pending.back();
+        pending.pop_back();
+        if (!node->hasAtomicRefCount()) {
+            node->setAtomicRefCount(true);
+        }
+        const auto& data = node->raw_variant();
+        if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+            for (const auto& entry : (*object)->keys()) {
+                if (entry.second) pending.push_back(entry.second.get());
+            }
+        } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+            for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+                if (it.value()) pending.push_back(it.value().get());
+            }
+        } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+            for (const auto& element : (*array)->data()) {
+                if (element) pending.push_back(element.get());
+            }
+        }
+    }
+}
+
+ValuePtr ConcurrentObject::get(const std::string& key) const {
+    std::optional<ValuePtr> value = table_.find(key);
+    return value ? std::move(*value) : ValuePtr();
+}
+
+bool ConcurrentObject::set(const std::string& key, ValuePtr value) {
+    if (!value) {
+        value = makeRef<JsonValue>();
+    }
+    publish(value);
+    return table_.insert(key, value);
+}
+
+bool ConcurrentObject::erase(const std::string& key) {
+    return table_.erase(key);
+}
+
+bool ConcurrentObject::compareAndSet(const std::string& key, const ValuePtr& expected,
+                                     ValuePtr desired) {
+    bool swapped = false;
+    if (desired) {
+        publish(desired);
+    }
+    table_.update(key, [&](ValuePtr* current) -> std::optional<ValuePtr> {
+        ValuePtr now = current ? *current : ValuePtr();
+        if (now != expected) {
+            return current ? std::optional<ValuePtr>(std::move(now)) : std::nullopt;
+        }
+        swapped = true;
+        return desired ? std::optional<ValuePtr>(desired) : std::nullopt;
+    });
+    return swapped;
+}
+
+JsonObject ConcurrentObject::snapshot() const {
+    JsonObject result;
+    table_.forEach([&](const std::string& key, const ValuePtr& value) {
+        result.keys().emplace(key, value);
+    });
+    return result;
+}
+
+} // namespace jsson
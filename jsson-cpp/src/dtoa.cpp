@@ -1,14 +1,31 @@
 #include "dtoa.hpp"
-#include <sstream>
-#include <iomanip>
+#include <charconv>
+#include <cmath>
 
 namespace jsson {
 
+size_t Dtoa::toChars(double value, char* buffer) noexcept {
+    // Shortest form that round-trips (at most 24 bytes for a double)
+    char* end = std::to_chars(buffer, buffer + kMaxLength, value).ptr;
+    if (std::isfinite(value)) {
+        bool integral = true;
+        for (const char* p = buffer; p != end; ++p) {
+            if (*p == '.' || *p == 'e') {
+                integral = false;
+                break;
+            }
+        }
+        if (integral) {
+            *end++ = '.';
+            *end++ = '0';
+        }
+    }
+    return static_cast<size_t>(end - buffer);
+}
+
 std::string Dtoa::doubleToString(double value) noexcept {
-    // Use ostringstream for precise control over formatting
-    std::ostringstream oss;
-    oss << std::setprecision(15) << value;
-    return oss.str();
+    char buffer[kMaxLength];
+    return std::string(buffer, toChars(value, buffer));
 }
 
-} // namespace jsson
\ No newline at end of file
+} // namespace jsson
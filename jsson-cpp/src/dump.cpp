@@ -5,120 +5,418 @@
  * it under the terms of the MIT license. See LICENSE for details.
  */
 
-#include "json_value.hpp"
+#include "dump.hpp"
+#include "base64.hpp"
+#include "dtoa.hpp"
+#include "probes.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <variant>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
-namespace dump {
+namespace jsson {
 
-/**
- * @brief Class for dumping JSON values to output streams.
- *
- * This class encapsulates the dumping functionality using modern C++
- * idioms: RAII, std::visit, range-based for loops, and const-correctness.
- */
-class JsonDumper {
-public:
-    /**
-     * @brief Dump a JSON value to an output stream.
-     *
-     * @param value The JSON value to dump.
-     * @param out   The output stream to write to.
-     */
-    void dump(const std::shared_ptr<JsonValue>& value, std::ostream& out) const {
-        dumpValue(value, out);
+/* Append the escape sequence for a quote, backslash or control character */
+static void appendEscape(unsigned char c, std::string& result) {
+    static const char kHex[] = "0123456789abcdef";
+    result += '\\';
+    switch (c) {
+        case '"': result += '"'; break;
+        case '\\': result += '\\'; break;
+        case '\b': result += 'b'; break;
+        case '\f': result += 'f'; break;
+        case '\n': result += 'n'; break;
+        case '\r': result += 'r'; break;
+        case '\t': result += 't'; break;
+        default:
+            result += "u00";
+            result += kHex[c >> 4];
+            result += kHex[c & 0xf];
+            break;
     }
+}
 
-private:
-    /**
-     * @brief Helper visitor struct for std::visit.
-     */
-    struct DumpVisitor {
-        std::ostream& out;
-        DumpVisitor(std::ostream& o) : out(o) {}
-
-        void operator()(const std::monostate&) const {
-            out << "null";
+/* Escape quotes, backslashes and control characters of a string body */
+static std::string escape(std::string_view s) {
+    const auto findSpecial = simd::kernels().findEscapable;
+    std::string result;
+    result.reserve(s.size());
+    while (true) {
+        size_t run = findSpecial(s.data(), s.size());
+        result.append(s.data(), run);
+        if (run == s.size()) {
+            return result;
         }
+        appendEscape(static_cast<unsigned char>(s[run]), result);
+        s.remove_prefix(run + 1);
+    }
+}
 
-        void operator()(bool b) const {
-            out << (b ? "true" : "false");
+/*
+ * Text of a verbatim RawString span, which is already escaped except for
+ * any raw control characters the parser let through.  Returns @p span
+ * itself when there are none, else a copy in @p scratch with them escaped.
+ */
+static std::string_view verbatimText(std::string_view span, std::string& scratch) {
+    const auto findSpecial = simd::kernels().findEscapable;
+    size_t i = 0;
+    while (true) {
+        i += findSpecial(span.data() + i, span.size() - i);
+        if (i >= span.size()) {
+            return span;
         }
-
-        void operator()(double d) const {
-            out << d;
+        if (span[i] != '\\') {
+            break;
         }
-
-        void operator()(int64_t i) const {
-            out << i;
+        i += 2; // Keep the escape and the character it escapes
+    }
+    scratch.assign(span.data(), i);
+    while (i < span.size()) {
+        unsigned char c = static_cast<unsigned char>(span[i]);
+        if (c < 0x20) {
+            appendEscape(c, scratch);
+        } else {
+            scratch += span[i];
         }
+        ++i;
+    }
+    return scratch;
+}
 
-        void operator()(const std::string& s) const {
-            out << '"' << escape(s) << '"';
+/*
+ * Append the escaped form of @p s from @p pos onwards to @p out, stopping
+ * once @p out reaches @p limit bytes (an escape may overshoot it by up to
+ * five).  A @p verbatim string is already escaped apart from raw control
+ * characters, so its backslash pairs are copied as they stand.
+ * Returns the position in @p s reached.
+ */
+static size_t escapeInto(std::string_view s, size_t pos, size_t limit, bool verbatim,
+                         std::string& out) {
+    const auto findSpecial = simd::kernels().findEscapable;
+    while (pos < s.size() && out.size() < limit) {
+        size_t window = std::min(s.size() - pos, limit - out.size());
+        size_t run = findSpecial(s.data() + pos, window);
+        out.append(s.data() + pos, run);
+        pos += run;
+        if (run == window) {
+            continue;
+        }
+        if (verbatim && s[pos] == '\\') {
+            out.append(s.data() + pos, 2); // The escape and the character it escapes
+            pos += 2;
+        } else {
+            appendEscape(static_cast<unsigned char>(s[pos]), out);
+            ++pos;
         }
+    }
+    return pos;
+}
+
+/**
+ * @brief Helper visitor struct for std::visit.
+ */
+struct JsonDumper::DumpVisitor {
+    const JsonDumper& dumper;
+    std::ostream& out;
+    DumpVisitor(const JsonDumper& d, std::ostream& o) : dumper(d), out(o) {}
+
+    void operator()(const std::monostate&) const {
+        out << "null";
+    }
+
+    void operator()(bool b) const {
+        out << (b ? "true" : "false");
+    }
+
+    void operator()(double d) const {
+        char buffer[Dtoa::kMaxLength];
+        out.write(buffer, static_cast<std::streamsize>(Dtoa::toChars(d, buffer)));
+    }
+
+    void operator()(int64_t i) const {
+        out << i;
+    }
+
+    void operator()(const std::string& s) const {
+        out << '"' << escape(s) << '"';
+    }
+
+    void operator()(const InternedString& s) const {
+        out << '"' << escape(s.str()) << '"';
+    }
 
-        void operator()(const char* s) const {
-            out << '"' << escape(s) << '"';
+    void operator()(const RawString& s) const {
+        if (!s.isVerbatim()) {
+            out << '"' << escape(s.span()) << '"';
+            return;
         }
+        // Still in valid escaped form: copy the input bytes verbatim
+        std::string scratch;
+        std::string_view text = verbatimText(s.span(), scratch);
+        out << '"';
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        out << '"';
+    }
+
+    void operator()(const std::unique_ptr<JsonObject>& obj) const {
+        dumpObject(obj->keys());
+    }
 
-        void operator()(const std::unique_ptr<JsonObject>& obj) const {
-            dumpObject(obj->keys(), out);
+    void operator()(const std::unique_ptr<JsonArray>& arr) const {
+        dumpArray(arr->data());
+    }
+
+    void operator()(const std::unique_ptr<OrderedObject>& obj) const {
+        out << '{';
+        bool first = true;
+        for (auto it = obj->begin(); it != obj->end(); ++it) {
+            if (!first) out << ", ";
+            first = false;
+            out << '"' << escape(it.key()) << "\": ";
+            dumper.dumpValue(*it.value(), out);
         }
+        out << '}';
+    }
 
-        void operator()(const std::unique_ptr<JsonArray>& arr) const {
-            dumpArray(arr->data(), out);
+private:
+    /**
+     * @brief Dump the contents of a JSON object.
+     */
+    void dumpObject(const JsonObject::Map& map) const {
+        out << '{';
+        bool first = true;
+        for (const auto& kv : map) {
+            if (!first) out << ", ";
+            first = false;
+            out << '"' << escape(kv.first) << "\": ";
+            dumper.dumpValue(*kv.second, out);
         }
+        out << '}';
+    }
 
-    private:
-        static std::string escape(const std::string& s) {
-            std::string result;
-            for (char c : s) {
-                if (c == '\\' || c == '"') result += '\\';
-                result += c;
-            }
-            return result;
+    /**
+     * @brief Dump the contents of a JSON array.
+     */
+    void dumpArray(const JsonArray::Vec& vec) const {
+        out << '[';
+        for (size_t i = 0; i < vec.size(); ++i) {
+            if (i) out << ", ";
+            dumper.dumpValue(*vec[i], out);
         }
+        out << ']';
+    }
+};
+
+void JsonDumper::dump(const ValuePtr& value, std::ostream& out) const {
+    dump(*value, out);
+}
+
+void JsonDumper::dump(const JsonValue& value, std::ostream& out) const {
+    JSSON_PROBE1(dump_start, &value);
+    dumpValue(value, out);
+    JSSON_PROBE1(dump_done, &value);
+}
+
+void JsonDumper::dump(const ValuePtr& value, OutputSink& sink) const {
+    JSSON_PROBE1(dump_start, value.get());
+    SinkStream out(sink);
+    dumpValue(*value, out);
+    out.commit();
+    JSSON_PROBE1(dump_done, value.get());
+}
+
+void JsonDumper::dumpBase64(const void* data, size_t size, std::ostream& out) const {
+    // 3072 input bytes encode to exactly 4096 characters, without padding
+    constexpr size_t kChunk = 3072;
+    char buffer[Base64::encodedLength(kChunk)];
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    out.put('"');
+    while (size > 0) {
+        size_t n = std::min(size, kChunk);
+        out.write(buffer, static_cast<std::streamsize>(Base64::encode(bytes, n, buffer)));
+        bytes += n;
+        size -= n;
+    }
+    out.put('"');
+}
+
+/**
+ * @brief Recursively dump a JSON value using the visitor.
+ */
+void JsonDumper::dumpValue(const JsonValue& value, std::ostream& out) const {
+    DumpVisitor visitor(*this, out);
+    std::visit(visitor, value.raw_variant());
+}
+
+/*=====================================================================
+ *  JsonSerializer
+ *====================================================================*/
+
+/* Appends a non-string scalar exactly as DumpVisitor writes it to a stream */
+struct ScalarAppender {
+    std::string& out;
+
+    void operator()(const std::monostate&) const { out += "null"; }
+    void operator()(bool b) const { out += b ? "true" : "false"; }
+
+    void operator()(double d) const {
+        char buffer[Dtoa::kMaxLength];
+        out.append(buffer, Dtoa::toChars(d, buffer));
+    }
 
-        /**
-         * @brief Dump the contents of a JSON object.
-         */
-        void dumpObject(const JsonObject::Map& map, std::ostream& out) const {
-            out << '{';
-            bool first = true;
-            for (const auto& kv : map) {
-                if (!first) out << ", ";
-                first = false;
-                out << '"' << escape(kv.first) << "\": ";
-                dumpValue(kv.second, out);
+    void operator()(int64_t i) const { out += std::to_string(i); }
+
+    /* Strings and containers are written by their own frames */
+    template <typename Other>
+    void operator()(const Other&) const {}
+};
+
+JsonSerializer::JsonSerializer(ValuePtr root) : root_(std::move(root)) {
+    stack_.push_back(Frame{root_.get()});
+}
+
+size_t JsonSerializer::next(char* buf, size_t cap) {
+    size_t written = 0;
+    while (written < cap) {
+        if (pendingPos_ == pending_.size()) {
+            if (stack_.empty()) {
+                break;
             }
-            out << '}';
+            pending_.clear();
+            pendingPos_ = 0;
+            step(cap - written);
+            continue;
         }
+        size_t n = std::min(cap - written, pending_.size() - pendingPos_);
+        std::memcpy(buf + written, pending_.data() + pendingPos_, n);
+        pendingPos_ += n;
+        written += n;
+    }
+    JSSON_PROBE2(serialize_chunk, this, written);
+    return written;
+}
 
-        /**
-         * @brief Dump the contents of a JSON array.
-         */
-        void dumpArray(const JsonArray::Vec& vec, std::ostream& out) const {
-            out << '[';
-            for (size_t i = 0; i < vec.size(); ++i) {
-                if (i) out << ", ";
-                dumpValue(vec[i], out);
-            }
-            out << ']';
+void JsonSerializer::step(size_t budget) {
+    Frame& frame = stack_.back();
+    if (frame.isText) {
+        stepText(frame, budget);
+        return;
+    }
+    const JsonValue& value = *frame.value;
+    const JsonValue* child = nullptr;
+    bool hasKey = false;
+    std::string_view key;
+    std::string ownedKey;
+
+    if (value.isOrderedObject()) {
+        const OrderedObject& object = value.asOrderedObject();
+        if (!frame.opened) {
+            frame.opened = true;
+            frame.ordered = object.begin();
+            pending_ += '{';
+            return;
+        }
+        if (frame.ordered == object.end()) {
+            pending_ += '}';
+            stack_.pop_back();
+            return;
+        }
+        if (!frame.first) pending_ += ", ";
+        frame.first = false;
+        // The key view dies with the iterator step, so the key frame owns a copy
+        hasKey = true;
+        ownedKey = frame.ordered.key();
+        child = frame.ordered.value().get();
+        ++frame.ordered;
+    } else if (value.isObject()) {
+        const JsonObject::Map& map = std::get<std::unique_ptr<JsonObject>>(value.raw_variant())->keys();
+        if (!frame.opened) {
+            frame.opened = true;
+            frame.it = map.begin();
+            pending_ += '{';
+            return;
+        }
+        if (frame.it == map.end()) {
+            pending_ += '}';
+            stack_.pop_back();
+            return;
         }
+        if (!frame.first) pending_ += ", ";
+        frame.first = false;
+        hasKey = true;
+        key = frame.it->first;
+        child = frame.it->second.get();
+        ++frame.it;
+    } else if (value.isArray()) {
+        const JsonArray::Vec& vec = std::get<std::unique_ptr<JsonArray>>(value.raw_variant())->data();
+        if (!frame.opened) {
+            frame.opened = true;
+            pending_ += '[';
+            return;
+        }
+        if (frame.index == vec.size()) {
+            pending_ += ']';
+            stack_.pop_back();
+            return;
+        }
+        if (frame.index) pending_ += ", ";
+        child = vec[frame.index++].get();
+    } else if (value.isString()) {
+        frame.isText = true;
+        if (const RawString* raw = std::get_if<RawString>(&value.raw_variant())) {
+            frame.text = raw->span();
+            frame.verbatim = raw->isVerbatim();
+        } else {
+            frame.text = value.asStringView();
+        }
+        stepText(frame, budget);
+        return;
+    } else {
+        std::visit(ScalarAppender{pending_}, value.raw_variant());
+        stack_.pop_back();
+        return;
+    }
+    // Pushed last: growing the stack invalidates frame.  The key frame goes
+    // on top of its value so that it is written first.
+    stack_.push_back(Frame{child});
+    if (hasKey) {
+        pushKey(key, std::move(ownedKey));
+    }
+}
 
-    };
+void JsonSerializer::pushKey(std::string_view key, std::string owned) {
+    stack_.push_back(Frame{nullptr});
+    Frame& frame = stack_.back();
+    frame.isText = true;
+    frame.isKey = true;
+    frame.ownedText = std::move(owned);
+    // Viewing ownedText is safe: nothing is pushed above a string frame
+    frame.text = frame.ownedText.empty() ? key : std::string_view(frame.ownedText);
+}
 
-    /**
-     * @brief Recursively dump a JSON value using the visitor.
-     */
-    static void dumpValue(const std::shared_ptr<JsonValue>& value, std::ostream& out) {
-        DumpVisitor visitor(out);
-        std::visit(visitor, value->raw_variant());
+void JsonSerializer::stepText(Frame& frame, size_t budget) {
+    if (!frame.opened) {
+        frame.opened = true;
+        pending_ += '"';
     }
-};
+    frame.index = escapeInto(frame.text, frame.index, pending_.size() + budget, frame.verbatim,
+                             pending_);
+    if (frame.index == frame.text.size()) {
+        pending_ += frame.isKey ? "\": " : "\"";
+        stack_.pop_back();
+    }
+}
+
+std::ostream& operator<<(std::ostream& out, const JsonValue& value) {
+    JsonDumper().dump(value, out);
+    return out;
+}
 
-} // namespace dump
\ No newline at end of file
+} // namespace jsson
@@ -26,6 +26,13 @@ std::string error_message(JsonErrorCode code) {
         case JsonErrorCode::IndexOutOfRange: return "Index out of range";
         case JsonErrorCode::PrematureEndOfInput: return "Premature end of input";
         case JsonErrorCode::EndOfInputExpected: return "End of input expected";
+        case JsonErrorCode::InputTooLarge: return "Input too large";
+        case JsonErrorCode::TooManyNodes: return "Too many nodes";
+        case JsonErrorCode::DepthLimitExceeded: return "Depth limit exceeded";
+        case JsonErrorCode::StringTooLong: return "String too long";
+        case JsonErrorCode::MemoryLimitExceeded: return "Memory limit exceeded";
+        case JsonErrorCode::DeadlineExceeded: return "Deadline exceeded";
+        case JsonErrorCode::Cancelled: return "Cancelled";
         case JsonErrorCode::Unknown: return "Unknown error";
     }
 }
@@ -0,0 +1,233 @@
+#include "io.hpp"
+#include "compression.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+namespace jsson {
+
+/*=====================================================================
+ *  FileSource / MemorySource
+ *====================================================================*/
+
+FileSource::FileSource(const std::string& filename)
+    : file_(nullptr), owned_(filename != "-") {
+    file_ = owned_ ? std::fopen(filename.c_str(), "rb") : stdin;
+    if (!file_) {
+        throw JsonError(JsonErrorCode::CannotOpenFile, "Failed to open file: " + filename);
+    }
+}
+
+FileSource::~FileSource() {
+    if (owned_ && file_) {
+        std::fclose(file_);
+    }
+}
+
+size_t FileSource::read(char* buf, size_t cap) {
+    size_t n = std::fread(buf, 1, cap, file_);
+    if (n == 0 && std::ferror(file_)) {
+        throw JsonError(JsonErrorCode::CannotOpenFile, "Read error");
+    }
+    return n;
+}
+
+size_t MemorySource::read(char* buf, size_t cap) {
+    size_t n = std::min(cap, size_ - pos_);
+    std::memcpy(buf, data_ + pos_, n);
+    pos_ += n;
+    return n;
+}
+
+/*=====================================================================
+ *  openInput
+ *====================================================================*/
+
+/* Replays bytes already consumed for format sniffing, then the rest */
+class PrefixedSource : public InputSource {
+public:
+    PrefixedSource(std::string prefix, std::unique_ptr<InputSource> rest)
+        : prefix_(std::move(prefix)), rest_(std::move(rest)) {}
+
+    size_t read(char* buf, size_t cap) override {
+        if (pos_ < prefix_.size()) {
+            size_t n = std::min(cap, prefix_.size() - pos_);
+            std::memcpy(buf, prefix_.data() + pos_, n);
+            pos_ += n;
+            return n;
+        }
+        return rest_->read(buf, cap);
+    }
+
+private:
+    std::string prefix_;
+    size_t pos_ = 0;
+    std::unique_ptr<InputSource> rest_;
+};
+
+std::unique_ptr<InputSource> openInput(const std::string& filename) {
+    auto file = std::make_unique<FileSource>(filename);
+
+    char magic[4];
+    size_t have = 0;
+    while (have < sizeof(magic)) {
+        size_t n = file->read(magic + have, sizeof(magic) - have);
+        if (n == 0) break;
+        have += n;
+    }
+
+    Compression format = detectCompression(reinterpret_cast<const unsigned char*>(magic), have);
+    auto source = std::make_unique<PrefixedSource>(std::string(magic, have), std::move(file));
+    if (format == Compression::None) {
+        return source;
+    }
+    return std::make_unique<DecompressingSource>(std::move(source), format);
+}
+
+/*=====================================================================
+ *  FileSink
+ *====================================================================*/
+
+FileSink::FileSink(const std::string& filename)
+    : file_(nullptr), owned_(filename != "-") {
+    file_ = owned_ ? std::fopen(filename.c_str(), "wb") : stdout;
+    if (!file_) {
+        throw JsonError(JsonErrorCode::CannotOpenFile, "Failed to create file: " + filename);
+    }
+}
+
+FileSink::~FileSink() {
+    if (owned_ && file_) {
+        std::fclose(file_);
+    }
+}
+
+void FileSink::write(const char* data, size_t size) {
+    if (std::fwrite(data, 1, size, file_) != size) {
+        throw JsonError(JsonErrorCode::CannotOpenFile, "Write error");
+    }
+}
+
+void FileSink::flush() {
+    if (file_ && std::fflush(file_) != 0) {
+        throw JsonError(JsonErrorCode::CannotOpenFile, "Write error");
+    }
+}
+
+void FileSink::close() {
+    if (!file_) {
+        return;
+    }
+    flush();
+    if (owned_) {
+        std::FILE* file = file_;
+        file_ = nullptr;
+        if (std::fclose(file) != 0) {
+            throw JsonError(JsonErrorCode::CannotOpenFile, "Write error");
+        }
+    }
+}
+
+/*=====================================================================
+ *  SinkStreamBuf
+ *====================================================================*/
+
+SinkStreamBuf::SinkStreamBuf(OutputSink& sink, size_t bufferSize)
+    : sink_(sink), buffer_(new char[bufferSize]), bufferSize_(bufferSize) {
+    setp(buffer_.get(), buffer_.get() + bufferSize_);
+}
+
+SinkStreamBuf::~SinkStreamBuf() {
+    try {
+        drain();
+    } catch (...) {
+        // Destructors must not throw; callers wanting errors call flush()
+    }
+}
+
+void SinkStreamBuf::drain() {
+    size_t pending = static_cast<size_t>(pptr() - pbase());
+    if (pending > 0) {
+        sink_.write(pbase(), pending);
+        setp(buffer_.get(), buffer_.get() + bufferSize_);
+    }
+}
+
+SinkStreamBuf::int_type SinkStreamBuf::overflow(int_type ch) {
+    drain();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize SinkStreamBuf::xsputn(const char* data, std::streamsize size) {
+    size_t n = static_cast<size_t>(size);
+    if (n <= static_cast<size_t>(epptr() - pptr())) {
+        std::memcpy(pptr(), data, n);
+        pbump(static_cast<int>(n));
+        return size;
+    }
+    // Large writes bypass the buffer
+    drain();
+    sink_.write(data, n);
+    return size;
+}
+
+int SinkStreamBuf::sync() {
+    drain();
+    sink_.flush();
+    return 0;
+}
+
+/*=====================================================================
+ *  openOutput
+ *====================================================================*/
+
+std::unique_ptr<OutputSink> openOutput(const std::string& filename, Compression format,
+                                       unsigned threads) {
+    // Reject the format before creating (and truncating) the file
+    if (format != Compression::None && !compressionSupported(format)) {
+        throw JsonError(JsonErrorCode::InvalidFormat,
+                        std::string("Unsupported compression: ") + compressionName(format));
+    }
+    auto file = std::make_unique<FileSink>(filename);
+    if (format == Compression::None) {
+        return file;
+    }
+    return std::make_unique<CompressingSink>(std::move(file), format, threads);
+}
+
+/*=====================================================================
+ *  ScratchFiles
+ *====================================================================*/
+
+ScratchFiles::ScratchFiles(const std::string& dir, const std::string& prefix) {
+    std::filesystem::path path = dir.empty() ? std::filesystem::temp_directory_path()
+                                             : std::filesystem::path(dir);
+    std::random_device random;
+    char token[17];
+    std::snprintf(token, sizeof(token), "%08x%08x", random(), random());
+    base_ = (path / (prefix + "-" + token + "-")).string();
+}
+
+ScratchFiles::~ScratchFiles() {
+    for (const std::string& path : live_) {
+        std::remove(path.c_str());
+    }
+}
+
+std::string ScratchFiles::create() {
+    live_.push_back(base_ + std::to_string(next_++) + ".tmp");
+    return live_.back();
+}
+
+void ScratchFiles::remove(const std::string& path) {
+    std::remove(path.c_str());
+    live_.erase(std::remove(live_.begin(), live_.end(), path), live_.end());
+}
+
+} // namespace jsson
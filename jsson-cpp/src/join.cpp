@@ -0,0 +1,744 @@
+#include "join.hpp"
+#include "error.hpp"
+#include "hashtable.hpp"
+#include "io.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace jsson {
+
+/* Limits of one batch read from either input */
+static constexpr size_t kBatchRecords = 8192;
+static constexpr size_t kBatchBytes = size_t(8) << 20;
+
+/* Batches with fewer records per worker are probed on the calling thread */
+static constexpr size_t kRecordsPerWorker = 256;
+
+/* Grace partitions per pass, and passes before a partition is joined as is */
+static constexpr size_t kPartitions = 32;
+static constexpr unsigned kMaxDepth = 4;
+
+/* Rough index cost of one distinct key beyond its bytes */
+static constexpr size_t kKeyOverhead = 64;
+
+/* Partition file record header: key and line lengths */
+static constexpr size_t kPartitionHeader = 8;
+
+/* Partition writes are batched into blocks of this size */
+static constexpr size_t kPartitionBlock = 1 << 20;
+
+/*=====================================================================
+ *  Batches
+ *====================================================================*/
+
+enum class KeyState : uint8_t {
+    Unknown,    // not parsed yet
+    Keyed,
+    Missing     // absent or null: never matches
+};
+
+/* Records read from one input; lines are kept verbatim */
+struct Batch {
+    struct Record {
+        size_t offset;
+        size_t length;
+        size_t line;        // 0 for records read back from a partition
+        KeyState state;
+        std::string key;
+        ValuePtr value;     // parsed probe record, once needed
+    };
+
+    std::string bytes;
+    std::vector<Record> records;
+
+    std::string_view lineAt(const Record& record) const {
+        return std::string_view(bytes.data() + record.offset, record.length);
+    }
+
+    void clear() {
+        bytes.clear();
+        records.clear();
+    }
+};
+
+static unsigned workerCount(unsigned threads, size_t size) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, size / kRecordsPerWorker)));
+}
+
+/* Run body(part) for part in [0, parts) on worker threads; rethrows the first failure */
+template <typename Body>
+static void runParts(unsigned parts, Body body) {
+    std::vector<std::exception_ptr> errors(parts);
+    auto guarded = [&](unsigned part) {
+        try {
+            body(part);
+        } catch (...) {
+            errors[part] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (unsigned part = 1; part < parts; ++part) {
+        workers.emplace_back(guarded, part);
+    }
+    guarded(0u);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+static ValuePtr parseRecord(std::string_view text, size_t line, const ParseOptions& options) {
+    try {
+        return Parser::parseText(text, options);
+    } catch (const JsonError& e) {
+        if (line == 0) {
+            throw;
+        }
+        throw JsonError(static_cast<JsonErrorCode>(e.code().value()),
+                        "line " + std::to_string(line) + ": " + e.what());
+    }
+}
+
+/*=====================================================================
+ *  Join keys
+ *====================================================================*/
+
+static void appendLength(std::string& out, size_t length) {
+    if (length > UINT32_MAX) {
+        throw JsonError(JsonErrorCode::InputTooLarge, "join: key string over 4 GiB");
+    }
+    uint32_t n = static_cast<uint32_t>(length);
+    out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+}
+
+static void appendInteger(std::string& out, int64_t i) {
+    out += 'i';
+    out.append(reinterpret_cast<const char*>(&i), sizeof(i));
+}
+
+/*
+ * Append the exact encoding of @p value: a type tag, then fixed-size or
+ * length-prefixed payload, so two keys encode equally only if they are
+ * equal values.  Integral reals encode as integers, so 1 and 1.0 match;
+ * object members are encoded in key order.
+ */
+static void appendKey(const JsonValue& value, std::string& out) {
+    const auto& data = value.raw_variant();
+    switch (value.type()) {
+    case JsonValue::Type::Null:
+        out += 'n';
+        return;
+    case JsonValue::Type::Boolean:
+        out += value.asBoolean() ? 't' : 'f';
+        return;
+    case JsonValue::Type::Number: {
+        if (auto i = std::get_if<int64_t>(&data)) {
+            appendInteger(out, *i);
+            return;
+        }
+        double d = value.asNumber();
+        if (std::trunc(d) == d && d >= -9223372036854775808.0 && d < 9223372036854775808.0) {
+            appendInteger(out, static_cast<int64_t>(d)); // -0.0 included
+            return;
+        }
+        if (std::isnan(d)) {
+            d = std::numeric_limits<double>::quiet_NaN();
+        }
+        out += 'd';
+        out.append(reinterpret_cast<const char*>(&d), sizeof(d));
+        return;
+    }
+    case JsonValue::Type::String: {
+        std::string_view text = value.asStringView();
+        out += 's';
+        appendLength(out, text.size());
+        out.append(text.data(), text.size());
+        return;
+    }
+    case JsonValue::Type::Array:
+        out += '[';
+        for (const ValuePtr& element : std::get<std::unique_ptr<JsonArray>>(data)->data()) {
+            appendKey(*element, out);
+        }
+        out += ']';
+        return;
+    case JsonValue::Type::Object:
+        out += '{';
+        if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+            // Already in key order
+            for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+                appendLength(out, it.key().size());
+                out.append(it.key().data(), it.key().size());
+                appendKey(*it.value(), out);
+            }
+        } else {
+            const auto& members = std::get<std::unique_ptr<JsonObject>>(data)->keys();
+            std::vector<const JsonObject::Map::value_type*> sorted;
+            sorted.reserve(members.size());
+            for (const auto& member : members) {
+                sorted.push_back(&member);
+            }
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const auto* a, const auto* b) { return a->first < b->first; });
+            for (const auto* member : sorted) {
+                appendLength(out, member->first.size());
+                out += member->first;
+                appendKey(*member->second, out);
+            }
+        }
+        out += '}';
+        return;
+    }
+}
+
+/* Parse a record of unknown key; the parsed value is kept when @p keep */
+static void extractKey(Batch& batch, Batch::Record& record, const JsonPointer& pointer,
+                       const ParseOptions& options, bool keep) {
+    ValuePtr value = parseRecord(batch.lineAt(record), record.line, options);
+    const JsonValue* key = pointer.resolve(*value);
+    if (!key || key->isNull()) {
+        record.state = KeyState::Missing;
+    } else {
+        record.state = KeyState::Keyed;
+        record.key.clear();
+        appendKey(*key, record.key);
+    }
+    if (keep) {
+        record.value = std::move(value);
+    }
+}
+
+/* Resolve every unknown key of @p batch in parallel */
+static void extractKeys(Batch& batch, const JsonPointer& pointer, unsigned threads) {
+    const size_t n = batch.records.size();
+    unsigned parts = workerCount(threads, n);
+    runParts(parts, [&](unsigned part) {
+        ParseOptions options;
+        options.keyPredictor = std::make_shared<KeyOrderPredictor>();
+        for (size_t i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+            if (batch.records[i].state == KeyState::Unknown) {
+                extractKey(batch, batch.records[i], pointer, options, false);
+            }
+        }
+    });
+}
+
+/*=====================================================================
+ *  Sources
+ *====================================================================*/
+
+/* Either input, read a batch at a time */
+class Source {
+public:
+    virtual ~Source() = default;
+
+    /* Replace @p batch with the next records; false at end of input */
+    virtual bool next(Batch& batch) = 0;
+};
+
+class NdjsonSource : public Source {
+public:
+    explicit NdjsonSource(NdjsonReader& reader) : reader_(reader) {}
+
+    bool next(Batch& batch) override {
+        batch.clear();
+        std::string_view line;
+        while (batch.records.size() < kBatchRecords && batch.bytes.size() < kBatchBytes &&
+               reader_.nextLine(line)) {
+            batch.records.push_back({batch.bytes.size(), line.size(), reader_.lineNumber(),
+                                     KeyState::Unknown, std::string(), nullptr});
+            batch.bytes.append(line.data(), line.size());
+        }
+        return !batch.records.empty();
+    }
+
+private:
+    NdjsonReader& reader_;
+};
+
+/* Keyed records spilled by a grace pass: header, key bytes, line bytes */
+class PartitionSource : public Source {
+public:
+    explicit PartitionSource(const std::string& path) : source_(openInput(path)) {}
+
+    bool next(Batch& batch) override {
+        batch.clear();
+        while (batch.records.size() < kBatchRecords && batch.bytes.size() < kBatchBytes) {
+            if (!need(kPartitionHeader)) {
+                if (pos_ != buffer_.size()) {
+                    throw JsonError(JsonErrorCode::PrematureEndOfInput, "join: truncated partition file");
+                }
+                break;
+            }
+            uint32_t lengths[2];
+            std::memcpy(lengths, buffer_.data() + pos_, kPartitionHeader);
+            size_t size = kPartitionHeader + size_t(lengths[0]) + lengths[1];
+            if (!need(size)) {
+                throw JsonError(JsonErrorCode::PrematureEndOfInput, "join: truncated partition file");
+            }
+            const char* key = buffer_.data() + pos_ + kPartitionHeader;
+            batch.records.push_back({batch.bytes.size(), lengths[1], 0, KeyState::Keyed,
+                                     std::string(key, lengths[0]), nullptr});
+            batch.bytes.append(key + lengths[0], lengths[1]);
+            pos_ += size;
+        }
+        return !batch.records.empty();
+    }
+
+private:
+    /* Make @p size bytes from pos_ available; false if the file ends first */
+    bool need(size_t size) {
+        if (buffer_.size() - pos_ >= size) {
+            return true;
+        }
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        while (buffer_.size() < size) {
+            size_t old = buffer_.size();
+            size_t want = std::max<size_t>(64 * 1024, size - old);
+            buffer_.resize(old + want);
+            size_t n = source_->read(&buffer_[old], want);
+            buffer_.resize(old + n);
+            if (n == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<InputSource> source_;
+    std::string buffer_;
+    size_t pos_ = 0;
+};
+
+/* Spreads keyed records over kPartitions files by a per-pass hash */
+class Partitions {
+public:
+    Partitions(ScratchFiles& scratch, unsigned depth) : depth_(depth) {
+        for (size_t i = 0; i < kPartitions; ++i) {
+            paths_.push_back(scratch.create());
+            sinks_.push_back(openOutput(paths_.back()));
+        }
+        blocks_.resize(kPartitions);
+        counts_.resize(kPartitions);
+    }
+
+    void put(const std::string& key, std::string_view line) {
+        if (key.size() > UINT32_MAX || line.size() > UINT32_MAX) {
+            throw JsonError(JsonErrorCode::InputTooLarge, "join: record over 4 GiB");
+        }
+        size_t i = partitionOf(key);
+        uint32_t lengths[2] = {static_cast<uint32_t>(key.size()), static_cast<uint32_t>(line.size())};
+        std::string& block = blocks_[i];
+        block.append(reinterpret_cast<const char*>(lengths), kPartitionHeader);
+        block.append(key);
+        block.append(line.data(), line.size());
+        ++counts_[i];
+        if (block.size() >= kPartitionBlock) {
+            sinks_[i]->write(block.data(), block.size());
+            block.clear();
+        }
+    }
+
+    void close() {
+        for (size_t i = 0; i < kPartitions; ++i) {
+            sinks_[i]->write(blocks_[i].data(), blocks_[i].size());
+            sinks_[i]->close();
+        }
+        sinks_.clear();
+        blocks_.clear();
+    }
+
+    const std::string& path(size_t i) const { return paths_[i]; }
+    size_t count(size_t i) const { return counts_[i]; }
+
+private:
+    /* Every pass mixes in its depth, so a partition splits again on the next */
+    size_t partitionOf(const std::string& key) const {
+        uint64_t h = std::hash<std::string>{}(key) + (depth_ + 1) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>((h ^ (h >> 31)) % kPartitions);
+    }
+
+    unsigned depth_;
+    std::vector<std::string> paths_;
+    std::vector<std::unique_ptr<OutputSink>> sinks_;
+    std::vector<std::string> blocks_;
+    std::vector<size_t> counts_;
+};
+
+/*=====================================================================
+ *  Build side
+ *====================================================================*/
+
+/* Build records as raw lines in chunked storage, chained per join key */
+class BuildTable {
+public:
+    void add(const std::string& key, std::string_view line) {
+        if (rows_.size() >= kEnd) {
+            throw JsonError(JsonErrorCode::InputTooLarge, "join: too many build records");
+        }
+        uint32_t row = static_cast<uint32_t>(rows_.size());
+        rows_.push_back({store(line), line.size(), kEnd});
+        index_.update(key, [&](const Chain* chain) -> std::optional<Chain> {
+            if (!chain) {
+                bytes_ += key.size() + kKeyOverhead;
+                return Chain{row, row};
+            }
+            rows_[chain->tail].next = row;
+            return Chain{chain->head, row};
+        });
+        bytes_ += line.size() + sizeof(Row);
+    }
+
+    /* Call fn(line) for each record under @p key, in insertion order */
+    template <typename F>
+    void forEachMatch(const std::string& key, F&& fn) const {
+        std::optional<Chain> chain = index_.find(key);
+        if (!chain) {
+            return;
+        }
+        for (uint32_t row = chain->head; row != kEnd; row = rows_[row].next) {
+            fn(std::string_view(rows_[row].data, rows_[row].length));
+        }
+    }
+
+    /* Call fn(key, line) for every record */
+    template <typename F>
+    void forEach(F&& fn) const {
+        index_.forEach([&](const std::string& key, const Chain& chain) {
+            for (uint32_t row = chain.head; row != kEnd; row = rows_[row].next) {
+                fn(key, std::string_view(rows_[row].data, rows_[row].length));
+            }
+        });
+    }
+
+    size_t footprint() const noexcept { return bytes_; }
+
+private:
+    static constexpr uint32_t kEnd = UINT32_MAX;
+    static constexpr size_t kChunk = 1 << 20;
+
+    struct Row {
+        const char* data;
+        size_t length;
+        uint32_t next;
+    };
+
+    struct Chain {
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    const char* store(std::string_view line) {
+        if (line.size() > kChunk) {
+            // Oversized lines get a block of their own
+            large_.push_back(std::make_unique<char[]>(line.size()));
+            std::memcpy(large_.back().get(), line.data(), line.size());
+            return large_.back().get();
+        }
+        if (chunks_.empty() || line.size() > kChunk - used_) {
+            chunks_.push_back(std::make_unique<char[]>(kChunk));
+            used_ = 0;
+        }
+        char* copy = chunks_.back().get() + used_;
+        std::memcpy(copy, line.data(), line.size());
+        used_ += line.size();
+        return copy;
+    }
+
+    HashTable<std::string, Chain> index_;
+    std::vector<Row> rows_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::vector<std::unique_ptr<char[]>> large_;
+    size_t used_ = 0;
+    size_t bytes_ = 0;
+};
+
+/*=====================================================================
+ *  Probe side
+ *====================================================================*/
+
+/*
+ * Joined records are spliced from the input lines rather than dumped, so
+ * every member keeps its exact text.  Lines reaching this point have
+ * already been parsed once, so the scan below assumes valid JSON.
+ */
+
+/* Index just past the string whose opening quote is at @p pos */
+static size_t skipString(std::string_view text, size_t pos) {
+    for (++pos; pos < text.size(); ++pos) {
+        if (text[pos] == '\\') {
+            ++pos;
+        } else if (text[pos] == '"') {
+            return pos + 1;
+        }
+    }
+    return text.size();
+}
+
+/* Index just past the value starting at @p pos */
+static size_t skipValue(std::string_view text, size_t pos) {
+    size_t depth = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"') {
+            pos = skipString(text, pos);
+            if (depth == 0) {
+                return pos;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return pos; // Closes the enclosing container
+            }
+            if (--depth == 0) {
+                return pos + 1;
+            }
+        } else if (depth == 0 && (c == ',' || std::isspace(static_cast<unsigned char>(c)))) {
+            return pos; // End of a number or literal
+        }
+        ++pos;
+    }
+    return pos;
+}
+
+/* Text between the outer braces of an object line, trimmed; throws if not an object */
+static std::string_view objectBody(std::string_view line) {
+    Parser::skipWhitespace(line);
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+        line.remove_suffix(1);
+    }
+    if (line.size() < 2 || line.front() != '{' || line.back() != '}') {
+        throw JsonError(JsonErrorCode::WrongType, "join: matched records must be objects");
+    }
+    line = line.substr(1, line.size() - 2);
+    Parser::skipWhitespace(line);
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+static bool hasMember(const JsonValue& object, const std::string& key) {
+    const auto& data = object.raw_variant();
+    if (auto members = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+        return (*members)->keys().count(key) != 0;
+    }
+    return std::get<std::unique_ptr<OrderedObject>>(data)->contains(key);
+}
+
+/*
+ * Append the probe record with the build record's members it lacks: the
+ * probe line's members, then those build members, in build line order.
+ */
+static void appendJoined(std::string& out, std::string_view probeLine, const JsonValue& probe,
+                         std::string_view buildLine) {
+    if (probe.type() != JsonValue::Type::Object) {
+        throw JsonError(JsonErrorCode::WrongType, "join: matched records must be objects");
+    }
+    std::string_view probeBody = objectBody(probeLine);
+    std::string_view build = objectBody(buildLine);
+    out += '{';
+    out.append(probeBody.data(), probeBody.size());
+    bool first = probeBody.empty();
+    std::vector<std::string> added;
+    std::string key;
+    while (!build.empty()) {
+        size_t keyEnd = skipString(build, 0);
+        std::string_view escaped = build.substr(1, keyEnd - 2);
+        key = escaped.find('\\') == std::string_view::npos ? std::string(escaped)
+                                                            : Parser::unescape(escaped);
+        std::string_view rest = build.substr(keyEnd);
+        Parser::skipWhitespace(rest);
+        rest.remove_prefix(1); // ':'
+        Parser::skipWhitespace(rest);
+        size_t memberEnd = static_cast<size_t>(rest.data() - build.data()) + skipValue(rest, 0);
+        std::string_view member = build.substr(0, memberEnd);
+
+        // Duplicate build keys: the first one wins
+        if (!hasMember(probe, key) && std::find(added.begin(), added.end(), key) == added.end()) {
+            if (!first) {
+                out += ',';
+            }
+            out.append(member.data(), member.size());
+            first = false;
+            added.push_back(key);
+        }
+
+        build.remove_prefix(memberEnd);
+        Parser::skipWhitespace(build);
+        if (!build.empty()) {
+            build.remove_prefix(1); // ','
+            Parser::skipWhitespace(build);
+        }
+    }
+    out += '}';
+}
+
+/* Match one batch on worker threads, then write its output in order */
+static size_t probeBatch(Batch& batch, const BuildTable& table, const JsonPointer& pointer,
+                         const JoinOptions& options, NdjsonWriter& out) {
+    struct Output {
+        std::string text;
+        std::vector<size_t> ends;
+    };
+    const size_t n = batch.records.size();
+    unsigned parts = workerCount(options.threads, n);
+    std::vector<Output> outputs(parts);
+
+    runParts(parts, [&](unsigned part) {
+        ParseOptions probeOptions;
+        probeOptions.keyPredictor = std::make_shared<KeyOrderPredictor>();
+        Output& output = outputs[part];
+        for (size_t i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+            Batch::Record& record = batch.records[i];
+            if (record.state == KeyState::Unknown) {
+                extractKey(batch, record, pointer, probeOptions, true);
+            }
+            bool matched = false;
+            if (record.state == KeyState::Keyed) {
+                table.forEachMatch(record.key, [&](std::string_view line) {
+                    if (!record.value) {
+                        record.value = parseRecord(batch.lineAt(record), record.line, probeOptions);
+                    }
+                    appendJoined(output.text, batch.lineAt(record), *record.value, line);
+                    output.ends.push_back(output.text.size());
+                    matched = true;
+                });
+            }
+            if (!matched && options.type == JoinType::Left) {
+                // Unmatched records pass through byte for byte
+                output.text.append(batch.lineAt(record));
+                output.ends.push_back(output.text.size());
+            }
+            record.value = nullptr;
+        }
+    });
+
+    size_t written = 0;
+    for (const Output& output : outputs) {
+        size_t start = 0;
+        for (size_t end : output.ends) {
+            out.writeLine(std::string_view(output.text.data() + start, end - start));
+            start = end;
+        }
+        written += output.ends.size();
+    }
+    return written;
+}
+
+/*=====================================================================
+ *  Join
+ *====================================================================*/
+
+static size_t joinSources(Source& build, const JsonPointer& buildKey,
+                          Source& probe, const JsonPointer& probeKey,
+                          NdjsonWriter& out, const JoinOptions& options,
+                          ScratchFiles& scratch, unsigned depth) {
+    auto table = std::make_unique<BuildTable>();
+    Batch batch;
+    size_t resume = 0; // first record of the batch not yet in the table
+    bool overflow = false;
+    while (!overflow && build.next(batch)) {
+        extractKeys(batch, buildKey, options.threads);
+        for (resume = 0; resume < batch.records.size() && !overflow;) {
+            const Batch::Record& record = batch.records[resume++];
+            if (record.state == KeyState::Keyed) {
+                table->add(record.key, batch.lineAt(record));
+            }
+            // Past the last pass a partition is joined as is: one hot key cannot split
+            overflow = table->footprint() > options.memoryLimit && depth < kMaxDepth;
+        }
+    }
+
+    size_t written = 0;
+    if (!overflow) {
+        while (probe.next(batch)) {
+            written += probeBatch(batch, *table, probeKey, options, out);
+        }
+        return written;
+    }
+
+    // Grace hash join: spread both sides over partition files by key
+    Partitions builds(scratch, depth);
+    table->forEach([&](const std::string& key, std::string_view line) { builds.put(key, line); });
+    table.reset();
+    do {
+        for (; resume < batch.records.size(); ++resume) {
+            const Batch::Record& record = batch.records[resume];
+            if (record.state == KeyState::Keyed) {
+                builds.put(record.key, batch.lineAt(record));
+            }
+        }
+        resume = 0;
+        if (!build.next(batch)) {
+            break;
+        }
+        extractKeys(batch, buildKey, options.threads);
+    } while (true);
+    builds.close();
+
+    Partitions probes(scratch, depth);
+    while (probe.next(batch)) {
+        extractKeys(batch, probeKey, options.threads);
+        for (const Batch::Record& record : batch.records) {
+            if (record.state == KeyState::Keyed) {
+                probes.put(record.key, batch.lineAt(record));
+            } else if (options.type == JoinType::Left) {
+                out.writeLine(batch.lineAt(record));
+                ++written;
+            }
+        }
+    }
+    probes.close();
+
+    for (size_t i = 0; i < kPartitions; ++i) {
+        if (probes.count(i) > 0 && (builds.count(i) > 0 || options.type == JoinType::Left)) {
+            PartitionSource buildPart(builds.path(i));
+            PartitionSource probePart(probes.path(i));
+            written += joinSources(buildPart, buildKey, probePart, probeKey, out, options,
+                                   scratch, depth + 1);
+        }
+        scratch.remove(builds.path(i));
+        scratch.remove(probes.path(i));
+    }
+    return written;
+}
+
+size_t hashJoin(NdjsonReader& build, const JsonPointer& buildKey,
+                NdjsonReader& probe, const JsonPointer& probeKey,
+                NdjsonWriter& out, const JoinOptions& options) {
+    if (options.memoryLimit == 0) {
+        throw JsonError(JsonErrorCode::InvalidArgument, "join: memoryLimit must be positive");
+    }
+    ScratchFiles scratch(options.scratchDir, "jsson-join");
+    NdjsonSource buildSource(build);
+    NdjsonSource probeSource(probe);
+    return joinSources(buildSource, buildKey, probeSource, probeKey, out, options, scratch, 0);
+}
+
+} // namespace jsson
@@ -0,0 +1,115 @@
+#include "json_pointer.hpp"
+#include "error.hpp"
+
+namespace jsson {
+
+/* Parse an RFC 6901 array index: "0" or digits without a leading zero */
+static size_t parseIndex(const std::string& token) {
+    if (token.empty() || token.size() > 19 || (token[0] == '0' && token.size() > 1)) {
+        return JsonPointer::npos;
+    }
+    size_t index = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') {
+            return JsonPointer::npos;
+        }
+        index = index * 10 + static_cast<size_t>(c - '0');
+    }
+    return index;
+}
+
+JsonPointer::JsonPointer(std::string_view text) {
+    if (text.empty()) {
+        return;
+    }
+    if (text[0] != '/') {
+        throw JsonError(JsonErrorCode::InvalidFormat, "JSON pointer must start with '/'");
+    }
+
+    std::string key;
+    for (size_t i = 1; i <= text.size(); ++i) {
+        if (i == text.size() || text[i] == '/') {
+            size_t index = parseIndex(key);
+            tokens_.push_back(Token{std::move(key), index});
+            key.clear();
+        } else if (text[i] == '~') {
+            if (i + 1 < text.size() && (text[i + 1] == '0' || text[i + 1] == '1')) {
+                key.push_back(text[i + 1] == '0' ? '~' : '/');
+                ++i;
+            } else {
+                throw JsonError(JsonErrorCode::InvalidFormat, "invalid '~' escape in JSON pointer");
+            }
+        } else {
+            key.push_back(text[i]);
+        }
+    }
+}
+
+const JsonValue* JsonPointer::resolve(const JsonValue& root) const noexcept {
+    const JsonValue* current = &root;
+    for (const Token& token : tokens_) {
+        const auto& data = current->raw_variant();
+        if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+            const auto& map = (*object)->keys();
+            auto it = map.find(token.key);
+            if (it == map.end() || !it->second) {
+                return nullptr;
+            }
+            current = it->second.get();
+        } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+            const ValuePtr* slot = (*ordered)->find(token.key);
+            if (!slot || !*slot) {
+                return nullptr;
+            }
+            current = slot->get();
+        } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+            const auto& vec = (*array)->data();
+            if (token.index >= vec.size() || !vec[token.index]) {
+                return nullptr;
+            }
+            current = vec[token.index].get();
+        } else {
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+JsonValue* JsonPointer::resolve(JsonValue& root) const noexcept {
+    return const_cast<JsonValue*>(resolve(static_cast<const JsonValue&>(root)));
+}
+
+JsonPointer JsonPointer::parent() const {
+    JsonPointer result(*this);
+    if (!result.tokens_.empty()) {
+        result.tokens_.pop_back();
+    }
+    return result;
+}
+
+JsonPointer JsonPointer::child(std::string_view key) const {
+    JsonPointer result(*this);
+    std::string token(key);
+    size_t index = parseIndex(token);
+    result.tokens_.push_back(Token{std::move(token), index});
+    return result;
+}
+
+std::string JsonPointer::toString() const {
+    std::string text;
+    for (const Token& token : tokens_) {
+        text.push_back('/');
+        for (char c : token.key) {
+            if (c == '~') {
+                text += "~0";
+            } else if (c == '/') {
+                text += "~1";
+            } else {
+                text.push_back(c);
+            }
+        }
+    }
+    return text;
+}
+
+} // namespace jsson
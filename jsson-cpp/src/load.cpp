@@ -1,4 +1,10 @@
 #include "parser.hpp"
+#include "arena.hpp"
+#include "error.hpp"
+#include "io.hpp"
+#include "probes.hpp"
+#include "simd.hpp"
+#include "string_dictionary.hpp"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -6,54 +12,183 @@
 #include <cctype>
 #include <filesystem>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
 
 using namespace jsson;
 
-/* Helper to read entire file into a string using std::getline */
-static std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filename);
-    }
+/* Helper to read entire file into a string, decompressing gzip/zstd input */
+static std::string readFile(const std::string& filename, size_t maxBytes) {
+    auto source = openInput(filename);
 
     std::string content;
-    std::string line;
-    while (std::getline(file, line)) {
-        content += line;
-        content += '\n'; // Preserve line breaks
+    size_t chunk = 64 * 1024;
+    while (true) {
+        size_t old = content.size();
+        content.resize(old + chunk);
+        size_t n = source->read(&content[old], chunk);
+        content.resize(old + n);
+        if (n == 0) {
+            break;
+        }
+        // Stop early rather than inflating a compression bomb to the end
+        if (content.size() > maxBytes) {
+            throw JsonError(JsonErrorCode::InputTooLarge, "Input exceeds maxInputBytes");
+        }
     }
     return content;
 }
 
-/* Skip whitespace characters */
+namespace {
+
+// Elements parsed between limit checks inside one container
+constexpr size_t kCheckInterval = 256;
+// Nodes parsed between reads of the clock
+constexpr size_t kClockInterval = 4096;
+// Estimated tree bytes per value: the node plus its allocation header
+constexpr size_t kNodeBytes = sizeof(JsonValue) + 16;
+
+/* Per-parse state threaded through the recursive descent */
+struct ParseState {
+    explicit ParseState(const ParseOptions& opts)
+        : options(opts),
+          limits(opts.limits),
+          predictor(opts.keyPredictor.get()),
+          interning(opts.interning != StringInterning::Off),
+          deciding(opts.interning == StringInterning::Auto),
+          hasDeadline(opts.limits.deadline != std::chrono::steady_clock::time_point::max()) {
+        if (interning) {
+            dictionary = opts.dictionary ? opts.dictionary
+                                         : std::make_shared<StringDictionary>(false);
+        }
+    }
+
+    /* Wrap a parsed string value, interning it when enabled */
+    ValuePtr makeString(std::string&& value) {
+        if (!interning || value.size() > options.maxInternLength) {
+            return makeRef<JsonValue>(std::move(value));
+        }
+        InternedString entry = dictionary->intern(value);
+        if (deciding) {
+            // Dictionary + this entry = 2 owners; more means the value repeats
+            if (entry.entry.use_count() > 2) ++repeats;
+            if (++sampled >= options.internSampleSize) {
+                deciding = false;
+                interning = static_cast<double>(repeats) >=
+                            options.internMinRepeatRatio * static_cast<double>(sampled);
+            }
+        }
+        return makeRef<JsonValue>(std::move(entry));
+    }
+
+    /*
+     * Start the next document of a batch.  The string dictionary and the
+     * interning decision carry over; everything counted per document restarts.
+     */
+    void reset() {
+        source.reset();
+        inSitu = false;
+        objects = 0;
+        slots.clear();
+        depth = 0;
+        nodes = 0;
+        allocated = 0;
+        nextClockCheck = 0;
+    }
+
+    /* Reject a string of @p length input bytes if it is over the limit */
+    void checkString(size_t length) const {
+        if (length > limits.maxStringLength) {
+            throw JsonError(JsonErrorCode::StringTooLong, "String exceeds maxStringLength");
+        }
+    }
+
+    /* Enforce the amortized limits; called at container boundaries */
+    void checkpoint() {
+        if (nodes > limits.maxNodes) {
+            throw JsonError(JsonErrorCode::TooManyNodes, "Document exceeds maxNodes");
+        }
+        if (allocated > limits.maxAllocationBytes) {
+            throw JsonError(JsonErrorCode::MemoryLimitExceeded, "Document exceeds maxAllocationBytes");
+        }
+        if (limits.cancellation && limits.cancellation->cancelled()) {
+            throw JsonError(JsonErrorCode::Cancelled, "Parse cancelled");
+        }
+        if (hasDeadline && nodes >= nextClockCheck) {
+            nextClockCheck = nodes + kClockInterval;
+            if (std::chrono::steady_clock::now() >= limits.deadline) {
+                throw JsonError(JsonErrorCode::DeadlineExceeded, "Parse deadline exceeded");
+            }
+        }
+    }
+
+    const ParseOptions& options;
+    const ParseLimits& limits;
+    std::shared_ptr<StringDictionary> dictionary;
+    // Input buffer lazy or in-situ strings point into
+    std::shared_ptr<const void> source;
+    bool inSitu = false;
+    // Objects opened so far: the position key order predictions are kept for
+    KeyOrderPredictor* predictor;
+    size_t objects = 0;
+    // Members of predicted objects still waiting for their value, innermost last
+    std::vector<JsonObject::Map::iterator> slots;
+    bool interning;
+    bool deciding;
+    size_t sampled = 0;
+    size_t repeats = 0;
+    // Resource accounting against limits
+    bool hasDeadline;
+    size_t depth = 0;
+    size_t nodes = 0;
+    size_t allocated = 0;
+    size_t nextClockCheck = 0;
+};
+
+/* Next character, or '\0' at the end of input */
+inline char peek(std::string_view view) {
+    return view.empty() ? '\0' : view.front();
+}
+
+} // namespace
+
+static ValuePtr parseNode(std::string_view& view, ParseState& state);
+
+/* Skip JSON whitespace: space, tab, line feed and carriage return */
 void Parser::skipWhitespace(std::string_view& view) {
-    view.remove_prefix(std::distance(view.begin(), std::find_if(view.begin(), view.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    })));
+    // Most tokens follow no whitespace at all; skip the kernel call for them
+    if (view.empty() || (view.front() != ' ' && view.front() != '\n' && view.front() != '\r' &&
+                         view.front() != '\t')) {
+        return;
+    }
+    view.remove_prefix(simd::kernels().whitespacePrefix(view.data(), view.size()));
 }
 
 /* Parse a JSON literal (true, false, null) */
-static std::shared_ptr<JsonValue> parseLiteral(std::string_view& view) {
+static ValuePtr parseLiteral(std::string_view& view) {
     Parser::skipWhitespace(view);
 
     if (view.substr(0, 4) == "true") {
         view.remove_prefix(4);
-        return std::make_shared<JsonValue>(true);
+        return makeRef<JsonValue>(true);
     } else if (view.substr(0, 5) == "false") {
         view.remove_prefix(5);
-        return std::make_shared<JsonValue>(false);
+        return makeRef<JsonValue>(false);
     } else if (view.substr(0, 4) == "null") {
         view.remove_prefix(4);
-        return std::make_shared<JsonValue>();
+        return makeRef<JsonValue>();
     }
 
-    throw std::runtime_error("Invalid literal in JSON input");
+    throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid literal in JSON input");
 }
 
-/* Parse a JSON number (integer or double) */
-static std::shared_ptr<JsonValue> parseNumber(std::string_view& view) {
+/*
+ * Scan a JSON number.  Returns true with @p integer set when the literal is
+ * an integer that fits int64_t, false with @p real set otherwise.
+ */
+static bool scanNumber(std::string_view& view, int64_t& integer, double& real) {
     Parser::skipWhitespace(view);
-    size_t start = view.size();
 
     // Capture the full numeric literal into a string
     std::string numStr;
@@ -93,33 +228,67 @@ static std::shared_ptr<JsonValue> parseNumber(std::string_view& view) {
             try {
                 int64_t intVal = static_cast<int64_t>(value);
                 if (std::to_string(intVal) == numStr) {
-                    return std::make_shared<JsonValue>(intVal);
+                    integer = intVal;
+                    return true;
                 }
             } catch (...) {
                 // Ignore overflow, fall back to double
             }
         }
-        return std::make_shared<JsonValue>(value);
+        real = value;
+        return false;
     } catch (...) {
-        throw std::runtime_error("Failed to parse JSON number: " + numStr);
+        throw JsonError(JsonErrorCode::InvalidNumber, "Failed to parse JSON number: " + numStr);
     }
 }
 
-/* Parse a JSON string */
-static std::shared_ptr<JsonValue> parseString(std::string_view& view) {
-    Parser::skipWhitespace(view);
-    if (view.empty() || view.front() != '"') {
-        throw std::runtime_error("Expected string literal");
+/* Parse a JSON number (integer or double) */
+static ValuePtr parseNumber(std::string_view& view) {
+    int64_t integer = 0;
+    double real = 0;
+    if (scanNumber(view, integer, real)) {
+        return makeRef<JsonValue>(integer);
     }
+    return makeRef<JsonValue>(real);
+}
 
-    view.remove_prefix(1); // Skip opening quote
-    std::string result;
+/* Writes characters straight into a buffer (in-situ parsing) */
+struct InPlaceWriter {
+    char* pos;
+
+    InPlaceWriter& operator+=(char c) {
+        *pos++ = c;
+        return *this;
+    }
+
+    /* @p run may overlap the destination (it is the input ahead of pos) */
+    InPlaceWriter& operator+=(std::string_view run) {
+        std::memmove(pos, run.data(), run.size());
+        pos += run.size();
+        return *this;
+    }
+};
+
+/*
+ * Append unescaped characters from @p view up to (not including) the
+ * closing quote.  @p result may write into the characters already read.
+ */
+template <typename Output>
+static void appendUnescaped(std::string_view& view, Output& result) {
+    const auto findSpecial = simd::kernels().findQuoteOrBackslash;
     while (!view.empty() && view.front() != '"') {
+        // Copy the run up to the next quote or escape in one step
+        size_t run = findSpecial(view.data(), view.size());
+        if (run > 0) {
+            result += view.substr(0, run);
+            view.remove_prefix(run);
+            continue;
+        }
         char c = view.front();
         view.remove_prefix(1);
         if (c == '\\') {
             if (view.empty()) {
-                throw std::runtime_error("Unexpected end of string");
+                throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
             }
             char esc = view.front();
             view.remove_prefix(1);
@@ -135,7 +304,7 @@ static std::shared_ptr<JsonValue> parseString(std::string_view& view) {
                 case 'u': {
                     // Parse Unicode escape
                     if (view.size() < 4) {
-                        throw std::runtime_error("Invalid Unicode escape");
+                        throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid Unicode escape");
                     }
                     std::string hex = std::string(view.substr(0, 4));
                     view.remove_prefix(4);
@@ -145,8 +314,10 @@ static std::shared_ptr<JsonValue> parseString(std::string_view& view) {
                         value <<= 4;
                         if (std::isdigit(static_cast<unsigned char>(ch))) {
                             value += ch - '0';
-                        } else if (std::isalpha(static_cast<unsigned char>(ch))) {
+                        } else if (std::isxdigit(static_cast<unsigned char>(ch))) {
                             value += std::tolower(ch) - 'a' + 10;
+                        } else {
+                            throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid Unicode escape");
                         }
                     }
                     // Encode as UTF-8
@@ -168,136 +339,820 @@ static std::shared_ptr<JsonValue> parseString(std::string_view& view) {
                     break;
                 }
                 default:
-                    throw std::runtime_error("Invalid escape sequence");
+                    throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid escape sequence");
             }
         } else {
             result += c;
         }
     }
+}
+
+/* Parse a JSON string literal into @p result, replacing its contents */
+static void parseStringInto(std::string_view& view, ParseState& state, std::string& result) {
+    Parser::skipWhitespace(view);
+    if (view.empty() || view.front() != '"') {
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Expected string literal");
+    }
+
+    view.remove_prefix(1); // Skip opening quote
+    result.clear();
+    appendUnescaped(view, result);
+    if (view.empty()) {
+        throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+    }
+
+    view.remove_prefix(1); // Skip closing quote
+    state.checkString(result.size());
+}
+
+/* Parse a JSON string literal into its unescaped characters */
+static std::string parseStringRaw(std::string_view& view, ParseState& state) {
+    std::string result;
+    parseStringInto(view, state, result);
+    state.allocated += result.size();
+    return result;
+}
+
+std::string Parser::unescape(std::string_view escaped) {
+    std::string result;
+    result.reserve(escaped.size());
+    appendUnescaped(escaped, result);
+    return result;
+}
+
+/* Find the end of a string literal without unescaping it (lazyStrings) */
+static ValuePtr parseLazyString(std::string_view& view, ParseState& state) {
+    view.remove_prefix(1); // Skip opening quote
+    bool hasEscapes = false;
+    size_t i = 0;
+    const auto findSpecial = simd::kernels().findQuoteOrBackslash;
+    while (true) {
+        i += findSpecial(view.data() + i, view.size() - i);
+        if (i >= view.size()) {
+            throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+        }
+        if (view[i] == '"') {
+            break;
+        }
+        // Validate the escape now so that unescaping later cannot fail
+        hasEscapes = true;
+        char esc = i + 1 < view.size() ? view[i + 1] : '\0';
+        if (esc == 'u') {
+            if (i + 6 > view.size() ||
+                !std::all_of(view.begin() + i + 2, view.begin() + i + 6,
+                             [](char ch) { return std::isxdigit(static_cast<unsigned char>(ch)); })) {
+                throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid Unicode escape");
+            }
+            i += 6;
+        } else if (esc != '\0' && std::strchr("\"\\/bfnrt", esc)) {
+            i += 2;
+        } else {
+            throw JsonError(JsonErrorCode::InvalidSyntax, "Invalid escape sequence");
+        }
+    }
+    state.checkString(i);
+    state.allocated += i;
+    std::string_view escaped = view.substr(0, i);
+    view.remove_prefix(i + 1); // Skip characters and closing quote
+    return makeRef<JsonValue>(RawString(state.source, escaped, hasEscapes));
+}
 
+/* Unescape a string literal into the input buffer itself (parseInSitu) */
+static ValuePtr parseInSituString(std::string_view& view, ParseState& state) {
+    view.remove_prefix(1); // Skip opening quote
+    // The caller handed the buffer over for writing; view only reads it
+    char* begin = const_cast<char*>(view.data());
+    size_t i = simd::kernels().findQuoteOrBackslash(view.data(), view.size());
+    if (i == view.size()) {
+        throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+    }
+
+    bool hasEscapes = view[i] == '\\';
+    size_t length = i;
+    view.remove_prefix(i);
+    if (hasEscapes) {
+        InPlaceWriter out{begin + i};
+        appendUnescaped(view, out);
+        if (view.empty()) {
+            throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+        }
+        length = static_cast<size_t>(out.pos - begin);
+    }
     view.remove_prefix(1); // Skip closing quote
-    return std::make_shared<JsonValue>(std::move(result));
+    state.checkString(length);
+
+    std::string_view text(begin, length);
+    if (state.interning) {
+        return state.makeString(std::string(text));
+    }
+    return makeRef<JsonValue>(hasEscapes ? RawString::unescaped(state.source, text)
+                                         : RawString(state.source, text, false));
 }
 
+/* Parse a JSON string value */
+static ValuePtr parseString(std::string_view& view, ParseState& state) {
+    if (state.inSitu) {
+        return parseInSituString(view, state);
+    }
+    if (state.source && !state.interning) {
+        return parseLazyString(view, state);
+    }
+    return state.makeString(parseStringRaw(view, state));
+}
+
+/*=====================================================================
+ *  KeyOrderPredictor
+ *====================================================================*/
+
+const std::string* KeyOrderPredictor::match(size_t position, size_t index,
+                                            std::string_view input) noexcept {
+    if (position >= shapes_.size() || index >= shapes_[position].keys.size()) {
+        return nullptr;
+    }
+    const Key& key = shapes_[position].keys[index];
+    const size_t n = key.text.size();
+    if (key.predictable && input.size() > n + 1 && input[0] == '"' && input[n + 1] == '"' &&
+        std::memcmp(input.data() + 1, key.text.data(), n) == 0) {
+        ++hits_;
+        return &key.text;
+    }
+    ++misses_;
+    return nullptr;
+}
+
+void KeyOrderPredictor::learn(size_t position, size_t index, std::string_view key) {
+    if (position >= maxPositions_) {
+        return;
+    }
+    if (position >= shapes_.size()) {
+        shapes_.resize(position + 1);
+    }
+    Shape& shape = shapes_[position];
+    if (index >= shape.keys.size()) {
+        shape.keys.resize(index + 1);
+    }
+    // Only escape-free keys appear verbatim in the input
+    shape.keys[index].text.assign(key);
+    shape.keys[index].predictable = key.find_first_of("\"\\") == std::string_view::npos;
+    shape.changed = true;
+    shape.prototype.reset();
+}
+
+void KeyOrderPredictor::finish(size_t position, size_t count) {
+    if (position >= shapes_.size()) {
+        return;
+    }
+    Shape& shape = shapes_[position];
+    if (shape.keys.size() > count) {
+        shape.keys.resize(count);
+        shape.changed = true;
+        shape.prototype.reset();
+    }
+    // Build the prototype once an object has repeated the shape in full
+    if (shape.changed) {
+        shape.changed = false;
+        return;
+    }
+    if (shape.prototype || shape.keys.empty()) {
+        return;
+    }
+    HeapScope heap; // The prototype outlives any arena the parse runs in
+    auto prototype = std::make_shared<JsonObject::Map>();
+    prototype->reserve(shape.keys.size());
+    for (size_t i = 0; i < shape.keys.size(); ++i) {
+        ValuePtr marker = makeRef<JsonValue>(static_cast<int64_t>(i));
+        // Copies of the predictor share the prototype across threads
+        marker->setAtomicRefCount(true);
+        prototype->emplace(shape.keys[i].text, std::move(marker));
+    }
+    if (prototype->size() == shape.keys.size()) { // No repeated keys
+        shape.prototype = std::move(prototype);
+    }
+}
+
+size_t KeyOrderPredictor::expectedSize(size_t position) const noexcept {
+    return position < shapes_.size() ? shapes_[position].keys.size() : 0;
+}
+
+const JsonObject::Map* KeyOrderPredictor::prototype(size_t position) const noexcept {
+    return position < shapes_.size() ? shapes_[position].prototype.get() : nullptr;
+}
+
+/*=====================================================================
+ *  Recursive descent
+ *====================================================================*/
+
 /* Parse a JSON object */
-static std::shared_ptr<JsonValue> parseObject(std::string_view& view) {
+static ValuePtr parseObject(std::string_view& view, ParseState& state) {
     Parser::skipWhitespace(view);
     if (view.empty() || view.front() != '{') {
-        throw std::runtime_error("Expected object start");
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Expected object start");
     }
     view.remove_prefix(1); // Skip '{'
 
     auto obj = std::make_unique<JsonObject>();
+    std::unique_ptr<OrderedObject> ordered;
+    KeyOrderPredictor* predictor = state.predictor;
+    const size_t position = state.objects++;
+    // Members [0, placing) sit in state.slots from base on, awaiting values
+    const size_t base = state.slots.size();
+    size_t placing = 0;
+    if (predictor) {
+        const JsonObject::Map* prototype = predictor->prototype(position);
+        if (prototype && prototype->size() < state.options.orderedObjectMinSize) {
+            // The copy keeps every key's cached hash: nothing is rehashed
+            obj->keys() = *prototype;
+            placing = prototype->size();
+            state.slots.resize(base + placing);
+            for (auto it = obj->keys().begin(); it != obj->keys().end(); ++it) {
+                state.slots[base + static_cast<size_t>(std::get<int64_t>(it->second->raw_variant()))] = it;
+            }
+        } else {
+            obj->keys().reserve(predictor->expectedSize(position));
+        }
+    }
+    // Remove the predicted members from index on, which the input lacks
+    auto dropSlots = [&](size_t index) {
+        for (size_t i = index; i < placing; ++i) {
+            obj->keys().erase(state.slots[base + i]);
+        }
+        placing = std::min(placing, index);
+    };
     Parser::skipWhitespace(view);
 
-    if (view.front() == '}') {
+    if (peek(view) == '}') {
         view.remove_prefix(1);
-        return std::make_shared<JsonValue>(*obj);
+        dropSlots(0);
+        state.slots.resize(base);
+        if (predictor) {
+            predictor->finish(position, 0);
+        }
+        return makeRef<JsonValue>(std::move(*obj));
     }
 
-    while (true) {
-        // Parse key (string)
-        auto keyValue = parseString(view);
-        if (!keyValue->isString()) {
-            throw std::runtime_error("Expected string key");
+    for (size_t count = 1;; ++count) {
+        const size_t index = count - 1;
+        // Parse key (string), or take it from the prediction
+        std::string key;
+        const std::string* predicted = predictor ? predictor->match(position, index, view) : nullptr;
+        if (predicted) {
+            view.remove_prefix(predicted->size() + 2);
+            state.checkString(predicted->size());
+            state.allocated += predicted->size();
+            if (index >= placing) {
+                key = *predicted;
+            }
+        } else {
+            dropSlots(index);
+            key = parseStringRaw(view, state);
+            if (predictor) {
+                predictor->learn(position, index, key);
+            }
         }
-        std::string key = keyValue->asString();
 
         Parser::skipWhitespace(view);
-        if (view.front() != ':') {
-            throw std::runtime_error("Expected ':' after key");
+        if (peek(view) != ':') {
+            throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ':' after key");
         }
         view.remove_prefix(1); // Skip ':'
 
         // Parse value
-        auto value = Parser::parseValue(view);
-        obj->keys()[key] = std::move(value);
+        auto value = parseNode(view, state);
+        if (index < placing) {
+            state.slots[base + index]->second = std::move(value);
+        } else if (ordered) {
+            ordered->insert(key, std::move(value));
+        } else {
+            obj->keys()[std::move(key)] = std::move(value);
+            if (obj->size() >= state.options.orderedObjectMinSize) {
+                ordered = std::make_unique<OrderedObject>(std::move(*obj));
+            }
+        }
+        state.allocated += sizeof(JsonObject::Map::value_type) + 2 * sizeof(void*);
+        if (count % kCheckInterval == 0) {
+            state.checkpoint();
+        }
 
         Parser::skipWhitespace(view);
-        if (view.front() == '}') {
+        if (peek(view) == '}') {
             view.remove_prefix(1);
-            return std::make_shared<JsonValue>(*obj);
+            dropSlots(count);
+            state.slots.resize(base);
+            if (predictor) {
+                predictor->finish(position, count);
+            }
+            if (ordered) {
+                return makeRef<JsonValue>(std::move(*ordered));
+            }
+            return makeRef<JsonValue>(std::move(*obj));
         }
-        if (view.front() == ',') {
+        if (peek(view) == ',') {
             view.remove_prefix(1);
             Parser::skipWhitespace(view);
             continue;
         }
-        throw std::runtime_error("Expected ',' or '}'");
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ',' or '}'");
     }
 }
 
 /* Parse a JSON array */
-static std::shared_ptr<JsonValue> parseArray(std::string_view& view) {
+static ValuePtr parseArray(std::string_view& view, ParseState& state) {
     Parser::skipWhitespace(view);
     if (view.empty() || view.front() != '[') {
-        throw std::runtime_error("Expected array start");
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Expected array start");
     }
     view.remove_prefix(1); // Skip '['
 
     auto arr = std::make_unique<JsonArray>();
     Parser::skipWhitespace(view);
 
-    if (view.front() == ']') {
+    if (peek(view) == ']') {
         view.remove_prefix(1);
-        return std::make_shared<JsonValue>(*arr);
+        return makeRef<JsonValue>(std::move(*arr));
     }
 
-    while (true) {
-        auto element = Parser::parseValue(view);
+    for (size_t count = 1;; ++count) {
+        auto element = parseNode(view, state);
         arr->data().push_back(std::move(element));
+        state.allocated += sizeof(ValuePtr);
+        if (count % kCheckInterval == 0) {
+            state.checkpoint();
+        }
 
         Parser::skipWhitespace(view);
-        if (view.front() == ']') {
+        if (peek(view) == ']') {
             view.remove_prefix(1);
-            return std::make_shared<JsonValue>(*arr);
+            return makeRef<JsonValue>(std::move(*arr));
         }
-        if (view.front() == ',') {
+        if (peek(view) == ',') {
             view.remove_prefix(1);
             Parser::skipWhitespace(view);
             continue;
         }
-        throw std::runtime_error("Expected ',' or ']'");
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ',' or ']'");
     }
 }
 
 /* Parse a JSON value (object, array, literal, string, number) */
-std::shared_ptr<JsonValue> Parser::parseValue(std::string_view& view) {
+static ValuePtr parseNode(std::string_view& view, ParseState& state) {
     Parser::skipWhitespace(view);
     if (view.empty()) {
-        throw std::runtime_error("Unexpected end of input");
+        throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of input");
     }
 
     char c = view.front();
-    if (c == '{') {
-        return parseObject(view);
-    } else if (c == '[') {
-        return parseArray(view);
+    ValuePtr node;
+    if (c == '{' || c == '[') {
+        if (++state.depth > state.limits.maxDepth) {
+            throw JsonError(JsonErrorCode::DepthLimitExceeded, "Document exceeds maxDepth");
+        }
+        state.checkpoint();
+        node = c == '{' ? parseObject(view, state) : parseArray(view, state);
+        --state.depth;
     } else if (c == '"') {
-        return parseString(view);
+        node = parseString(view, state);
     } else if (c == 't' || c == 'f' || c == 'n') {
-        return parseLiteral(view);
+        node = parseLiteral(view);
+    } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+        node = parseNumber(view);
+    } else {
+        throw JsonError(JsonErrorCode::InvalidSyntax, "Unexpected character");
+    }
+    ++state.nodes;
+    state.allocated += kNodeBytes;
+    // Nodes are still private to this parse, so the count mode can change
+    node->setAtomicRefCount(state.options.atomicRefCounts);
+    return node;
+}
+
+/* Parse a JSON value with default options */
+ValuePtr Parser::parseValue(std::string_view& view) {
+    ParseOptions options;
+    ParseState state(options);
+    return parseNode(view, state);
+}
+
+/*=====================================================================
+ *  Reparsing into an existing document
+ *====================================================================*/
+
+namespace {
+
+/* Per-thread scratch, so reparsing an unchanged shape allocates nothing */
+struct ReparseScratch {
+    std::string key;
+    std::string value;
+    // Members matched so far, per open object (stack of slices)
+    std::vector<const JsonValue*> seen;
+};
+
+thread_local ReparseScratch reparseScratch;
+
+} // namespace
+
+static bool reparseNode(JsonValue& target, std::string_view& view, ParseState& state);
+
+/* Replace @p target by a freshly parsed value where the shapes differ */
+static bool replaceNode(JsonValue& target, std::string_view& view, ParseState& state) {
+    ValuePtr fresh = parseNode(view, state);
+    target = std::move(*fresh);
+    return true;
+}
+
+/* Reparse an object over @p object or @p ordered (exactly one is set) */
+static bool reparseObject(JsonObject* object, OrderedObject* ordered, std::string_view& view,
+                          ParseState& state) {
+    ReparseScratch& scratch = reparseScratch;
+    const size_t base = scratch.seen.size();
+    bool changed = false;
+
+    view.remove_prefix(1); // Skip '{'
+    Parser::skipWhitespace(view);
+    if (peek(view) == '}') {
+        view.remove_prefix(1);
+    } else {
+        for (size_t count = 1;; ++count) {
+            parseStringInto(view, state, scratch.key);
+            Parser::skipWhitespace(view);
+            if (peek(view) != ':') {
+                throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ':' after key");
+            }
+            view.remove_prefix(1); // Skip ':'
+
+            JsonValue* member = nullptr;
+            if (object) {
+                auto it = object->keys().find(scratch.key);
+                member = it != object->keys().end() ? it->second.get() : nullptr;
+            } else if (const ValuePtr* slot = ordered->find(scratch.key)) {
+                member = slot->get();
+            }
+
+            if (member) {
+                changed |= reparseNode(*member, view, state);
+            } else {
+                // The value's own keys reuse the scratch key
+                std::string key(scratch.key);
+                ValuePtr fresh = parseNode(view, state);
+                member = fresh.get();
+                if (object) {
+                    object->keys()[std::move(key)] = std::move(fresh);
+                } else {
+                    ordered->insert(key, std::move(fresh));
+                }
+                changed = true;
+            }
+            scratch.seen.push_back(member);
+            if (count % kCheckInterval == 0) {
+                state.checkpoint();
+            }
+
+            Parser::skipWhitespace(view);
+            if (peek(view) == '}') {
+                view.remove_prefix(1);
+                break;
+            }
+            if (peek(view) != ',') {
+                throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ',' or '}'");
+            }
+            view.remove_prefix(1);
+        }
+    }
+
+    // Drop the members the input no longer has (duplicate keys match twice)
+    auto first = scratch.seen.begin() + static_cast<std::ptrdiff_t>(base);
+    std::sort(first, scratch.seen.end());
+    auto last = std::unique(first, scratch.seen.end());
+    size_t size = object ? object->size() : ordered->size();
+    if (static_cast<size_t>(last - first) != size) {
+        auto absent = [&](const ValuePtr& value) { return !std::binary_search(first, last, value.get()); };
+        if (object) {
+            auto& map = object->keys();
+            for (auto it = map.begin(); it != map.end();) {
+                it = absent(it->second) ? map.erase(it) : std::next(it);
+            }
+        } else {
+            std::vector<std::string> stale;
+            for (auto it = ordered->begin(); it != ordered->end(); ++it) {
+                if (absent(it.value())) {
+                    stale.emplace_back(it.key());
+                }
+            }
+            for (const std::string& key : stale) {
+                ordered->erase(key);
+            }
+        }
+        changed = true;
+    }
+    scratch.seen.resize(base);
+    return changed;
+}
+
+/* Reparse an array over @p array, reusing its elements by position */
+static bool reparseArray(JsonArray& array, std::string_view& view, ParseState& state) {
+    auto& vec = array.data();
+    size_t index = 0;
+    bool changed = false;
+
+    view.remove_prefix(1); // Skip '['
+    Parser::skipWhitespace(view);
+    if (peek(view) == ']') {
+        view.remove_prefix(1);
+    } else {
+        for (;; ++index) {
+            if (index < vec.size() && vec[index]) {
+                changed |= reparseNode(*vec[index], view, state);
+            } else if (index < vec.size()) {
+                vec[index] = parseNode(view, state);
+                changed = true;
+            } else {
+                vec.push_back(parseNode(view, state));
+                changed = true;
+            }
+            if ((index + 1) % kCheckInterval == 0) {
+                state.checkpoint();
+            }
+
+            Parser::skipWhitespace(view);
+            if (peek(view) == ']') {
+                view.remove_prefix(1);
+                ++index;
+                break;
+            }
+            if (peek(view) != ',') {
+                throw JsonError(JsonErrorCode::InvalidSyntax, "Expected ',' or ']'");
+            }
+            view.remove_prefix(1);
+        }
+    }
+    if (index < vec.size()) {
+        vec.erase(vec.begin() + static_cast<std::ptrdiff_t>(index), vec.end());
+        changed = true;
+    }
+    return changed;
+}
+
+/* Reparse one value over @p target; returns true if it changed */
+static bool reparseNode(JsonValue& target, std::string_view& view, ParseState& state) {
+    Parser::skipWhitespace(view);
+    if (view.empty()) {
+        throw JsonError(JsonErrorCode::PrematureEndOfInput, "Unexpected end of input");
+    }
+
+    const auto& data = target.raw_variant();
+    char c = view.front();
+    bool changed = false;
+    if (c == '{' || c == '[') {
+        auto object = std::get_if<std::unique_ptr<JsonObject>>(&data);
+        auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data);
+        auto array = std::get_if<std::unique_ptr<JsonArray>>(&data);
+        if (c == '{' ? !object && !ordered : !array) {
+            return replaceNode(target, view, state);
+        }
+        if (++state.depth > state.limits.maxDepth) {
+            throw JsonError(JsonErrorCode::DepthLimitExceeded, "Document exceeds maxDepth");
+        }
+        state.checkpoint();
+        changed = c == '{' ? reparseObject(object ? object->get() : nullptr,
+                                           ordered ? ordered->get() : nullptr, view, state)
+                           : reparseArray(**array, view, state);
+        --state.depth;
+    } else if (c == '"') {
+        std::string& value = reparseScratch.value;
+        parseStringInto(view, state, value);
+        if (!target.isString() || target.asStringView() != value) {
+            if (std::holds_alternative<std::string>(data)) {
+                target.asString() = value; // keeps the string's capacity
+            } else {
+                target = std::string(value);
+            }
+            changed = true;
+        }
     } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
-        return parseNumber(view);
+        int64_t integer = 0;
+        double real = 0;
+        if (scanNumber(view, integer, real)) {
+            auto current = std::get_if<int64_t>(&data);
+            changed = !current || *current != integer;
+            if (changed) {
+                target = integer;
+            }
+        } else {
+            auto current = std::get_if<double>(&data);
+            changed = !current || *current != real;
+            if (changed) {
+                target = real;
+            }
+        }
+    } else if (view.substr(0, 4) == "true" || view.substr(0, 5) == "false") {
+        bool value = c == 't';
+        view.remove_prefix(value ? 4 : 5);
+        auto current = std::get_if<bool>(&data);
+        changed = !current || *current != value;
+        if (changed) {
+            target = value;
+        }
+    } else if (view.substr(0, 4) == "null") {
+        view.remove_prefix(4);
+        changed = !target.isNull();
+        if (changed) {
+            target = JsonValue();
+        }
     } else {
-        throw std::runtime_error("Unexpected character");
+        return replaceNode(target, view, state);
     }
+    ++state.nodes;
+    return changed;
+}
+
+bool Parser::reparseInto(JsonValue& existing, std::string_view text, const ParseOptions& options) {
+    if (text.size() > options.limits.maxInputBytes) {
+        throw JsonError(JsonErrorCode::InputTooLarge, "Input exceeds maxInputBytes");
+    }
+    std::string_view view(text);
+    ParseState state(options);
+    try {
+        bool changed = reparseNode(existing, view, state);
+        state.checkpoint();
+        Parser::skipWhitespace(view);
+        if (!view.empty()) {
+            throw JsonError(JsonErrorCode::EndOfInputExpected, "Extra data after valid JSON value");
+        }
+        return changed;
+    } catch (...) {
+        reparseScratch.seen.clear();
+        throw;
+    }
+}
+
+/* Parse a whole document with a fresh or reset @p state */
+static ValuePtr parseDocument(std::string_view text, ParseState& state) {
+    if (text.size() > state.limits.maxInputBytes) {
+        throw JsonError(JsonErrorCode::InputTooLarge, "Input exceeds maxInputBytes");
+    }
+    JSSON_PROBE1(parse_start, text.size());
+    std::string_view view(text);
+
+    try {
+        // Parse the content
+        auto root = parseNode(view, state);
+        state.checkpoint();
+
+        // Ensure we consumed the entire input
+        Parser::skipWhitespace(view);
+        if (!view.empty()) {
+            throw JsonError(JsonErrorCode::EndOfInputExpected, "Extra data after valid JSON value");
+        }
+
+        JSSON_PROBE2(parse_done, text.size(), state.nodes);
+        return root;
+    } catch (const JsonError& e) {
+        JSSON_PROBE1(parse_error, e.code().value());
+        throw;
+    }
+}
+
+/* Parse a whole document; @p source owns @p text for lazy and in-situ strings */
+static ValuePtr parseDocument(std::string_view text, const ParseOptions& options,
+                              std::shared_ptr<const void> source, bool inSitu = false) {
+    ParseState state(options);
+    state.source = std::move(source);
+    state.inSitu = inSitu;
+    return parseDocument(text, state);
 }
 
 /* Public parse method */
-std::shared_ptr<JsonValue> Parser::parse(const std::string& filename) {
+ValuePtr Parser::parse(const std::string& filename, const ParseOptions& options) {
     // Read file content
-    std::string fileContent = readFile(filename);
-    std::string_view view(fileContent);
+    std::string fileContent = readFile(filename, options.limits.maxInputBytes);
+    if (options.lazyStrings) {
+        // The document keeps the file content alive instead of a copy of it
+        auto source = std::make_shared<const std::string>(std::move(fileContent));
+        return parseDocument(*source, options, source);
+    }
+    return parseDocument(fileContent, options, nullptr);
+}
 
-    // Parse the content
-    auto root = Parser::parseValue(view);
+/* Parse JSON text held in memory */
+ValuePtr Parser::parseText(std::string_view text, const ParseOptions& options) {
+    if (options.lazyStrings) {
+        auto source = std::make_shared<const std::string>(text);
+        return parseDocument(*source, options, source);
+    }
+    return parseDocument(text, options, nullptr);
+}
 
-    // Ensure we consumed the entire input
-    Parser::skipWhitespace(view);
-    if (!view.empty()) {
-        throw std::runtime_error("Extra data after valid JSON value");
+/*
+ * Parse messages [begin, end) of a batch on this thread, into one arena and
+ * with one ParseState reset between messages.
+ */
+static void parseBatchRange(const std::string_view* messages, size_t begin, size_t end,
+                            const ParseOptions& options,
+                            const std::shared_ptr<const std::string>& joined,
+                            const std::vector<size_t>& offsets, ParsedBatch& batch,
+                            std::vector<std::pair<size_t, JsonError>>& errors) {
+    NodeArena arena;
+    ArenaScope scope(arena);
+    ParseOptions local(options);
+    if (local.interning != StringInterning::Off && !local.dictionary) {
+        local.dictionary = std::make_shared<StringDictionary>(false);
+    }
+    ParseState state(local);
+    for (size_t i = begin; i < end; ++i) {
+        state.reset();
+        try {
+            if (joined) {
+                state.source = joined;
+                std::string_view text(joined->data() + offsets[i], messages[i].size());
+                batch.roots[i] = parseDocument(text, state);
+            } else {
+                batch.roots[i] = parseDocument(messages[i], state);
+            }
+        } catch (const JsonError& e) {
+            errors.emplace_back(i, e);
+        }
+    }
+}
+
+ParsedBatch Parser::parseBatch(const std::string_view* messages, size_t count,
+                               const ParseOptions& options, size_t threads) {
+    ParsedBatch batch;
+    batch.roots.resize(count);
+
+    std::shared_ptr<const std::string> joined;
+    std::vector<size_t> offsets;
+    if (options.lazyStrings) {
+        // One shared source for every document instead of one per message
+        size_t total = 0;
+        offsets.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            offsets.push_back(total);
+            total += messages[i].size();
+        }
+        auto text = std::make_shared<std::string>();
+        text->reserve(total);
+        for (size_t i = 0; i < count; ++i) {
+            text->append(messages[i]);
+        }
+        joined = std::move(text);
+    }
+
+    // Threads only pay off with a few dozen messages each
+    constexpr size_t kMinPerThread = 64;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
     }
+    threads = std::max<size_t>(1, std::min(threads, count / kMinPerThread));
 
-    return root;
-}
\ No newline at end of file
+    if (threads == 1) {
+        parseBatchRange(messages, 0, count, options, joined, offsets, batch, batch.errors);
+        return batch;
+    }
+
+    std::vector<std::vector<std::pair<size_t, JsonError>>> errors(threads);
+    // A predictor is single-threaded: workers learn in copies taken up front
+    std::vector<ParseOptions> workerOptions(threads, options);
+    if (options.keyPredictor) {
+        for (size_t t = 1; t < threads; ++t) {
+            workerOptions[t].keyPredictor = std::make_shared<KeyOrderPredictor>(*options.keyPredictor);
+        }
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    size_t share = (count + threads - 1) / threads;
+    for (size_t t = 1; t < threads; ++t) {
+        size_t begin = std::min(count, t * share);
+        size_t end = std::min(count, begin + share);
+        workers.emplace_back([&, t, begin, end] {
+            parseBatchRange(messages, begin, end, workerOptions[t], joined, offsets, batch,
+                            errors[t]);
+        });
+    }
+    try {
+        parseBatchRange(messages, 0, std::min(count, share), options, joined, offsets, batch, errors[0]);
+    } catch (...) {
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        throw;
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (auto& part : errors) {
+        batch.errors.insert(batch.errors.end(), std::make_move_iterator(part.begin()),
+                            std::make_move_iterator(part.end()));
+    }
+    return batch;
+}
+
+ParsedBatch Parser::parseBatch(const std::vector<std::string_view>& messages,
+                               const ParseOptions& options, size_t threads) {
+    return parseBatch(messages.data(), messages.size(), options, threads);
+}
+
+/* Parse a caller-provided buffer, unescaping strings in place */
+ValuePtr Parser::parseInSitu(std::unique_ptr<char[]> buf, size_t len, const ParseOptions& options) {
+    std::string_view text(buf.get(), len);
+    std::shared_ptr<const void> source(std::move(buf));
+    return parseDocument(text, options, std::move(source), true);
+}
@@ -8,18 +8,6 @@
 namespace jsson {
 namespace memory {
 
-template <typename T>
-std::unique_ptr<T[]> Allocator::make_unique_array(std::size_t count) noexcept {
-    if (count == 0) {
-        return std::unique_ptr<T[]>(nullptr);
-    }
-    try {
-        return std::unique_ptr<T[]>(new T[count]());
-    } catch (...) {
-        return std::unique_ptr<T[]>(nullptr);
-    }
-}
-
 std::unique_ptr<void, decltype(&std::free)> Allocator::aligned_alloc(
     std::size_t alignment, std::size_t size) noexcept {
 
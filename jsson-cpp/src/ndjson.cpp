@@ -0,0 +1,136 @@
+#include "ndjson.hpp"
+#include "error.hpp"
+#include "parser.hpp"
+#include <cstring>
+
+namespace jsson {
+
+/*=====================================================================
+ *  NdjsonReader
+ *====================================================================*/
+
+NdjsonReader::NdjsonReader(std::unique_ptr<InputSource> source, size_t chunkSize)
+    : source_(std::move(source)), chunkSize_(chunkSize ? chunkSize : kDefaultChunkSize) {
+    options_.keyPredictor = std::make_shared<KeyOrderPredictor>();
+}
+
+NdjsonReader NdjsonReader::open(const std::string& filename) {
+    return NdjsonReader(openInput(filename));
+}
+
+/* Drop consumed bytes and append one more chunk from the source */
+bool NdjsonReader::fill() {
+    if (eof_) {
+        return false;
+    }
+    if (pos_ > 0) {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+    }
+    size_t old = buffer_.size();
+    buffer_.resize(old + chunkSize_);
+    size_t n = source_->read(&buffer_[old], chunkSize_);
+    buffer_.resize(old + n);
+    if (n == 0) {
+        eof_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool NdjsonReader::nextLine(std::string_view& line) {
+    size_t scanFrom = pos_;
+    while (true) {
+        const char* base = buffer_.data();
+        const void* nl = std::memchr(base + scanFrom, '\n', buffer_.size() - scanFrom);
+        size_t end;
+        if (nl) {
+            end = static_cast<size_t>(static_cast<const char*>(nl) - base);
+        } else {
+            // fill() moves the unread tail to the front of the buffer
+            size_t scanned = buffer_.size() - pos_;
+            if (fill()) {
+                scanFrom = scanned;
+                continue;
+            }
+            if (pos_ == buffer_.size()) {
+                return false;
+            }
+            end = buffer_.size(); // last line without a trailing newline
+        }
+
+        size_t start = pos_;
+        pos_ = nl ? end + 1 : end;
+        ++lineNumber_;
+
+        size_t stop = end;
+        if (stop > start && buffer_[stop - 1] == '\r') --stop;
+        std::string_view candidate(buffer_.data() + start, stop - start);
+        if (candidate.find_first_not_of(" \t") == std::string_view::npos) {
+            scanFrom = pos_;
+            continue; // blank line
+        }
+        line = candidate;
+        return true;
+    }
+}
+
+bool NdjsonReader::next(ValuePtr& value) {
+    std::string_view line;
+    if (!nextLine(line)) {
+        return false;
+    }
+    try {
+        value = Parser::parseText(line, options_);
+    } catch (const JsonError& e) {
+        throw JsonError(static_cast<JsonErrorCode>(e.code().value()),
+                        "line " + std::to_string(lineNumber_) + ": " + e.what());
+    } catch (const std::exception& e) {
+        throw JsonError(JsonErrorCode::InvalidSyntax,
+                        "line " + std::to_string(lineNumber_) + ": " + e.what());
+    }
+    return true;
+}
+
+/*=====================================================================
+ *  NdjsonWriter
+ *====================================================================*/
+
+NdjsonWriter::NdjsonWriter(std::unique_ptr<OutputSink> sink)
+    : sink_(std::move(sink)), out_(*sink_) {}
+
+NdjsonWriter::~NdjsonWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() to observe errors
+    }
+}
+
+std::unique_ptr<NdjsonWriter> NdjsonWriter::open(const std::string& filename,
+                                                 Compression format, unsigned threads) {
+    return std::make_unique<NdjsonWriter>(openOutput(filename, format, threads));
+}
+
+void NdjsonWriter::write(const ValuePtr& value) {
+    dumper_.dump(value, out_);
+    out_.put('\n');
+    ++count_;
+}
+
+void NdjsonWriter::writeLine(std::string_view line) {
+    out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+    out_.put('\n');
+    ++count_;
+}
+
+void NdjsonWriter::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    out_.commit();
+    sink_->close();
+}
+
+} // namespace jsson
@@ -0,0 +1,449 @@
+#include "json_value.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace jsson {
+
+// Members per leaf and children per inner node before a split
+static constexpr size_t kLeafCapacity = 64;
+static constexpr size_t kInnerCapacity = 64;
+
+/* Length of the common prefix of @p a and @p b */
+static size_t commonPrefix(std::string_view a, std::string_view b) noexcept {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+static bool startsWith(std::string_view text, std::string_view prefix) noexcept {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+/*=====================================================================
+ *  Nodes
+ *====================================================================*/
+
+struct OrderedObject::Node {
+    explicit Node(bool leaf) : isLeaf(leaf) {}
+    virtual ~Node() = default;
+
+    static void* operator new(size_t size) { return allocateNode(size); }
+    static void operator delete(void* pointer) noexcept { deallocateNode(pointer); }
+
+    bool isLeaf;
+};
+
+/*
+ * Sorted members sharing one key prefix.  Key i is prefix + suffix(i);
+ * the suffixes are packed back to back in one buffer, ends[i] marking
+ * where suffix i stops.
+ */
+struct OrderedObject::Leaf : Node {
+    Leaf() : Node(true) {}
+
+    std::string prefix;
+    std::string suffixes;
+    std::vector<uint32_t, NodeAllocator<uint32_t>> ends;
+    std::vector<ValuePtr, NodeAllocator<ValuePtr>> values;
+    Leaf* next = nullptr;
+
+    size_t size() const noexcept { return values.size(); }
+
+    std::string_view suffix(size_t i) const noexcept {
+        size_t begin = i ? ends[i - 1] : 0;
+        return std::string_view(suffixes).substr(begin, ends[i] - begin);
+    }
+
+    std::string key(size_t i) const {
+        std::string result = prefix;
+        result.append(suffix(i));
+        return result;
+    }
+
+    /* Position of the first key not less than @p key; @p found if equal */
+    size_t lowerBound(std::string_view key, bool& found) const noexcept {
+        found = false;
+        size_t m = std::min(key.size(), prefix.size());
+        int c = key.substr(0, m).compare(std::string_view(prefix).substr(0, m));
+        // A key diverging from the prefix (or a prefix of it) orders against all members at once
+        if (c < 0 || (c == 0 && key.size() < prefix.size())) return 0;
+        if (c > 0) return size();
+
+        std::string_view rest = key.substr(prefix.size());
+        size_t lo = 0;
+        size_t hi = size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (suffix(mid) < rest) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        found = lo < size() && suffix(lo) == rest;
+        return lo;
+    }
+
+    /* Insert @p key at @p pos, which must keep the keys sorted */
+    void insertAt(size_t pos, std::string_view key, ValuePtr value) {
+        if (values.empty()) {
+            prefix.assign(key);
+            suffixes.clear();
+            ends.clear();
+        } else if (!startsWith(key, prefix)) {
+            shortenPrefix(commonPrefix(key, prefix));
+        }
+        std::string_view rest = key.substr(prefix.size());
+        uint32_t begin = pos ? ends[pos - 1] : 0;
+        suffixes.insert(begin, rest);
+        ends.insert(ends.begin() + pos, begin + static_cast<uint32_t>(rest.size()));
+        for (size_t i = pos + 1; i < ends.size(); ++i) {
+            ends[i] += static_cast<uint32_t>(rest.size());
+        }
+        values.insert(values.begin() + pos, std::move(value));
+    }
+
+    void eraseAt(size_t pos) {
+        uint32_t begin = pos ? ends[pos - 1] : 0;
+        uint32_t length = ends[pos] - begin;
+        suffixes.erase(begin, length);
+        ends.erase(ends.begin() + pos);
+        for (size_t i = pos; i < ends.size(); ++i) {
+            ends[i] -= length;
+        }
+        values.erase(values.begin() + pos);
+        if (values.empty()) {
+            prefix.clear();
+        }
+    }
+
+    /* Move the prefix characters past @p length into every suffix */
+    void shortenPrefix(size_t length) {
+        std::string_view moved = std::string_view(prefix).substr(length);
+        std::string rebuilt;
+        rebuilt.reserve(suffixes.size() + moved.size() * size());
+        uint32_t begin = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            rebuilt.append(moved);
+            rebuilt.append(suffixes, begin, ends[i] - begin);
+            begin = ends[i];
+            ends[i] = static_cast<uint32_t>(rebuilt.size());
+        }
+        suffixes.swap(rebuilt);
+        prefix.resize(length);
+    }
+
+    /* Replace the contents with sorted @p keys (at least one) */
+    void assign(const std::vector<std::string>& keys) {
+        prefix.assign(keys.front(), 0, commonPrefix(keys.front(), keys.back()));
+        suffixes.clear();
+        ends.clear();
+        for (const std::string& key : keys) {
+            suffixes.append(key, prefix.size(), std::string::npos);
+            ends.push_back(static_cast<uint32_t>(suffixes.size()));
+        }
+    }
+};
+
+/*
+ * separators[i] is not greater than any key under children[i + 1] and
+ * greater than every key under children[i].
+ */
+struct OrderedObject::Inner : Node {
+    Inner() : Node(false) {}
+
+    std::vector<std::string> separators;
+    std::vector<std::unique_ptr<Node>> children;
+
+    size_t childFor(std::string_view key) const {
+        return static_cast<size_t>(std::upper_bound(separators.begin(), separators.end(), key,
+                                                    [](std::string_view k, const std::string& s) {
+                                                        return k < s;
+                                                    }) - separators.begin());
+    }
+};
+
+/* Split an overfull leaf; the new right sibling starts at @p separator */
+std::unique_ptr<OrderedObject::Node> OrderedObject::splitLeaf(Leaf& leaf, size_t insertedAt,
+                                                              std::string& separator) {
+    // Appending to the last leaf (bulk loads, rising ids) leaves it full
+    size_t count = leaf.size();
+    size_t mid = (insertedAt == count - 1 && !leaf.next) ? count - 1 : count / 2;
+
+    std::vector<std::string> left;
+    std::vector<std::string> right;
+    for (size_t i = 0; i < count; ++i) {
+        (i < mid ? left : right).push_back(leaf.key(i));
+    }
+
+    auto sibling = std::make_unique<Leaf>();
+    sibling->assign(right);
+    sibling->values.assign(std::make_move_iterator(leaf.values.begin() + mid),
+                           std::make_move_iterator(leaf.values.end()));
+    leaf.values.resize(mid);
+    leaf.assign(left);
+
+    sibling->next = leaf.next;
+    leaf.next = sibling.get();
+    separator = std::move(right.front());
+    return sibling;
+}
+
+/* Split an overfull inner node; the new right sibling starts at @p separator */
+std::unique_ptr<OrderedObject::Node> OrderedObject::splitInner(Inner& inner, std::string& separator) {
+    size_t mid = inner.children.size() / 2;
+    auto sibling = std::make_unique<Inner>();
+    sibling->children.assign(std::make_move_iterator(inner.children.begin() + mid),
+                             std::make_move_iterator(inner.children.end()));
+    sibling->separators.assign(std::make_move_iterator(inner.separators.begin() + mid),
+                               std::make_move_iterator(inner.separators.end()));
+    separator = std::move(inner.separators[mid - 1]);
+    inner.children.resize(mid);
+    inner.separators.resize(mid - 1);
+    return sibling;
+}
+
+std::unique_ptr<OrderedObject::Node> OrderedObject::insertInto(Node* node, std::string_view key,
+                                                               ValuePtr& value, bool& inserted,
+                                                               std::string& separator) {
+    if (node->isLeaf) {
+        auto* leaf = static_cast<Leaf*>(node);
+        bool found = false;
+        size_t pos = leaf->lowerBound(key, found);
+        if (found) {
+            leaf->values[pos] = std::move(value);
+            inserted = false;
+            return nullptr;
+        }
+        leaf->insertAt(pos, key, std::move(value));
+        inserted = true;
+        return leaf->size() > kLeafCapacity ? splitLeaf(*leaf, pos, separator) : nullptr;
+    }
+
+    auto* inner = static_cast<Inner*>(node);
+    size_t i = inner->childFor(key);
+    std::string childSeparator;
+    auto sibling = insertInto(inner->children[i].get(), key, value, inserted, childSeparator);
+    if (!sibling) {
+        return nullptr;
+    }
+    inner->separators.insert(inner->separators.begin() + i, std::move(childSeparator));
+    inner->children.insert(inner->children.begin() + i + 1, std::move(sibling));
+    return inner->children.size() > kInnerCapacity ? splitInner(*inner, separator) : nullptr;
+}
+
+/*=====================================================================
+ *  Iterator
+ *====================================================================*/
+
+OrderedObject::iterator::iterator(Leaf* leaf, size_t index) : leaf_(leaf), index_(index) {
+    // Skip past the end of a leaf (and leaves emptied by erase)
+    while (leaf_ && index_ >= leaf_->size()) {
+        leaf_ = leaf_->next;
+        index_ = 0;
+    }
+}
+
+std::string_view OrderedObject::iterator::key() const {
+    key_.assign(leaf_->prefix);
+    key_.append(leaf_->suffix(index_));
+    return key_;
+}
+
+ValuePtr& OrderedObject::iterator::value() const {
+    return leaf_->values[index_];
+}
+
+OrderedObject::iterator& OrderedObject::iterator::operator++() {
+    *this = iterator(leaf_, index_ + 1);
+    return *this;
+}
+
+/*=====================================================================
+ *  OrderedObject
+ *====================================================================*/
+
+OrderedObject::OrderedObject() : root_(std::make_unique<Leaf>()) {}
+
+OrderedObject::~OrderedObject() = default;
+
+OrderedObject::OrderedObject(const OrderedObject& other) : OrderedObject() {
+    for (auto it = other.begin(); it != other.end(); ++it) {
+        insert(it.key(), it.value());
+    }
+}
+
+OrderedObject& OrderedObject::operator=(const OrderedObject& other) {
+    if (this != &other) {
+        OrderedObject copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+OrderedObject::OrderedObject(OrderedObject&& other) noexcept
+    : root_(std::move(other.root_)), size_(other.size_) {
+    other.size_ = 0;
+}
+
+OrderedObject& OrderedObject::operator=(OrderedObject&& other) noexcept {
+    root_ = std::move(other.root_);
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+OrderedObject::OrderedObject(JsonObject&& object) : OrderedObject() {
+    std::vector<JsonObject::Map::value_type*> entries;
+    entries.reserve(object.size());
+    for (auto& entry : object.keys()) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const auto* a, const auto* b) { return a->first < b->first; });
+    for (auto* entry : entries) {
+        insert(entry->first, std::move(entry->second));
+    }
+    object.keys().clear();
+}
+
+OrderedObject::Leaf* OrderedObject::findLeaf(std::string_view key) const {
+    Node* node = root_.get();
+    while (node && !node->isLeaf) {
+        auto* inner = static_cast<Inner*>(node);
+        node = inner->children[inner->childFor(key)].get();
+    }
+    return static_cast<Leaf*>(node);
+}
+
+bool OrderedObject::insert(std::string_view key, ValuePtr value) {
+    if (!root_) {
+        root_ = std::make_unique<Leaf>();
+    }
+    bool inserted = false;
+    std::string separator;
+    auto sibling = insertInto(root_.get(), key, value, inserted, separator);
+    if (sibling) {
+        auto root = std::make_unique<Inner>();
+        root->children.push_back(std::move(root_));
+        root->children.push_back(std::move(sibling));
+        root->separators.push_back(std::move(separator));
+        root_ = std::move(root);
+    }
+    if (inserted) {
+        ++size_;
+    }
+    return inserted;
+}
+
+JsonValue& OrderedObject::operator[](std::string_view key) {
+    if (const ValuePtr* slot = find(key)) {
+        return **slot;
+    }
+    ValuePtr value = makeRef<JsonValue>();
+    JsonValue& result = *value;
+    insert(key, std::move(value));
+    return result;
+}
+
+const ValuePtr* OrderedObject::find(std::string_view key) const {
+    Leaf* leaf = findLeaf(key);
+    if (!leaf) {
+        return nullptr;
+    }
+    bool found = false;
+    size_t pos = leaf->lowerBound(key, found);
+    return found ? &leaf->values[pos] : nullptr;
+}
+
+JsonValue& OrderedObject::at(std::string_view key) {
+    if (const ValuePtr* slot = find(key)) {
+        return **slot;
+    }
+    throw JsonError(JsonErrorCode::ItemNotFound, "Key not found: " + std::string(key));
+}
+
+const JsonValue& OrderedObject::at(std::string_view key) const {
+    return const_cast<OrderedObject*>(this)->at(key);
+}
+
+bool OrderedObject::erase(std::string_view key) {
+    Leaf* leaf = findLeaf(key);
+    if (!leaf) {
+        return false;
+    }
+    bool found = false;
+    size_t pos = leaf->lowerBound(key, found);
+    if (!found) {
+        return false;
+    }
+    leaf->eraseAt(pos);
+    --size_;
+    return true;
+}
+
+OrderedObject::iterator OrderedObject::begin() const {
+    Node* node = root_.get();
+    while (node && !node->isLeaf) {
+        node = static_cast<Inner*>(node)->children.front().get();
+    }
+    return iterator(static_cast<Leaf*>(node), 0);
+}
+
+OrderedObject::iterator OrderedObject::lower_bound(std::string_view key) const {
+    Leaf* leaf = findLeaf(key);
+    if (!leaf) {
+        return end();
+    }
+    bool found = false;
+    return iterator(leaf, leaf->lowerBound(key, found));
+}
+
+OrderedObject::iterator OrderedObject::upper_bound(std::string_view key) const {
+    iterator it = lower_bound(key);
+    if (it != end() && it.key() == key) {
+        ++it;
+    }
+    return it;
+}
+
+OrderedObject::Range OrderedObject::range(std::string_view from, std::string_view to) const {
+    if (!(from < to)) {
+        return Range{end(), end()};
+    }
+    return Range{lower_bound(from), lower_bound(to)};
+}
+
+OrderedObject::Range OrderedObject::prefix(std::string_view prefix) const {
+    // The smallest string greater than every key starting with the prefix
+    std::string limit(prefix);
+    while (!limit.empty() && static_cast<unsigned char>(limit.back()) == 0xFF) {
+        limit.pop_back();
+    }
+    if (limit.empty()) {
+        return Range{lower_bound(prefix), end()};
+    }
+    limit.back() = static_cast<char>(static_cast<unsigned char>(limit.back()) + 1);
+    return Range{lower_bound(prefix), lower_bound(limit)};
+}
+
+OrderedObject::Page OrderedObject::listPage(std::optional<std::string_view> after, size_t limit,
+                                            std::string_view prefix) const {
+    if (limit == 0) {
+        throw JsonError(JsonErrorCode::InvalidArgument, "listPage: limit must be positive");
+    }
+    Page page;
+    iterator it = (after && !(*after < prefix)) ? upper_bound(*after) : lower_bound(prefix);
+    for (; it != end() && startsWith(it.key(), prefix); ++it) {
+        if (page.entries.size() == limit) {
+            page.next = page.entries.back().first;
+            break;
+        }
+        page.entries.emplace_back(std::string(it.key()), it.value());
+    }
+    return page;
+}
+
+} // namespace jsson
@@ -0,0 +1,54 @@
+#include "raw_string.hpp"
+#include "parser.hpp"
+
+namespace jsson {
+
+RawString::RawString(const RawString& other)
+    : source_(other.source_), span_(other.span_), hasEscapes_(other.hasEscapes_),
+      verbatim_(other.verbatim_) {}
+
+RawString::RawString(RawString&& other) noexcept
+    : source_(std::move(other.source_)), span_(other.span_), hasEscapes_(other.hasEscapes_),
+      verbatim_(other.verbatim_) {
+    decoded_.store(other.decoded_.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+}
+
+RawString& RawString::operator=(const RawString& other) {
+    if (this != &other) {
+        RawString copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+RawString& RawString::operator=(RawString&& other) noexcept {
+    if (this != &other) {
+        delete decoded_.exchange(other.decoded_.exchange(nullptr, std::memory_order_acq_rel),
+                                 std::memory_order_acq_rel);
+        source_ = std::move(other.source_);
+        span_ = other.span_;
+        hasEscapes_ = other.hasEscapes_;
+        verbatim_ = other.verbatim_;
+    }
+    return *this;
+}
+
+RawString::~RawString() {
+    delete decoded_.load(std::memory_order_acquire);
+}
+
+const std::string& RawString::str() const {
+    const std::string* decoded = decoded_.load(std::memory_order_acquire);
+    if (decoded) {
+        return *decoded;
+    }
+    auto fresh = std::make_unique<std::string>(hasEscapes_ ? Parser::unescape(span_)
+                                                           : std::string(span_));
+    // Concurrent first readers may both decode; the loser drops its copy
+    if (decoded_.compare_exchange_strong(decoded, fresh.get(), std::memory_order_acq_rel)) {
+        return *fresh.release();
+    }
+    return *decoded;
+}
+
+} // namespace jsson
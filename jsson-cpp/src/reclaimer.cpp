@@ -0,0 +1,135 @@
+#include "reclaimer.hpp"
+
+namespace jsson {
+
+Reclaimer::Reclaimer(Mode mode, size_t slice)
+    : slice_(slice ? slice : kDefaultSlice) {
+    if (mode == Mode::Background) {
+        worker_ = std::thread(&Reclaimer::run, this);
+    }
+}
+
+Reclaimer::~Reclaimer() {
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        worker_.join();
+    }
+    drain();
+}
+
+Reclaimer& Reclaimer::global() {
+    static Reclaimer instance;
+    return instance;
+}
+
+void Reclaimer::retire(ValuePtr value) {
+    if (!value) {
+        return;
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        incoming_.push_back(std::move(value));
+    }
+    wakeup_.notify_one();
+}
+
+void Reclaimer::retireOpaque(std::unique_ptr<Retired> owner) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        incomingOpaque_.push_back(std::move(owner));
+    }
+    wakeup_.notify_one();
+}
+
+size_t Reclaimer::reclaim(size_t maxNodes) {
+    std::lock_guard<std::mutex> work(workMutex_);
+
+    std::vector<std::unique_ptr<Retired>> opaque;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (work_.empty()) {
+            work_.swap(incoming_);
+        } else {
+            work_.insert(work_.end(), std::make_move_iterator(incoming_.begin()),
+                         std::make_move_iterator(incoming_.end()));
+            incoming_.clear();
+        }
+        opaque.swap(incomingOpaque_);
+    }
+
+    size_t freed = opaque.size();
+    pending_.fetch_sub(opaque.size(), std::memory_order_relaxed);
+    opaque.clear();
+
+    while (freed < maxNodes && !work_.empty()) {
+        ValuePtr node = std::move(work_.back());
+        work_.pop_back();
+
+        // Only the last owner detaches children; shared subtrees just lose a reference
+        if (node && node.use_count() == 1) {
+            size_t children = 0;
+            const auto& data = node->raw_variant();
+            if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+                for (auto& entry : (*object)->keys()) {
+                    if (entry.second) {
+                        work_.push_back(std::move(entry.second));
+                        ++children;
+                    }
+                }
+            } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+                for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+                    if (it.value()) {
+                        work_.push_back(std::move(it.value()));
+                        ++children;
+                    }
+                }
+            } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+                for (auto& element : (*array)->data()) {
+                    if (element) {
+                        work_.push_back(std::move(element));
+                        ++children;
+                    }
+                }
+            }
+            pending_.fetch_add(children, std::memory_order_relaxed);
+        }
+        node.reset();
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        ++freed;
+    }
+    return freed;
+}
+
+void Reclaimer::drain() {
+    while (pending() > 0) {
+        if (reclaim(static_cast<size_t>(-1)) == 0) {
+            std::this_thread::yield(); // the worker holds the remaining items
+        }
+    }
+}
+
+void Reclaimer::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            wakeup_.wait(lock, [this] {
+                return stop_ || !incoming_.empty() || !incomingOpaque_.empty();
+            });
+            if (stop_) {
+                return;
+            }
+        }
+        // Bounded slices keep the work mutex free for reclaim()/drain() callers
+        while (reclaim(slice_) > 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace jsson
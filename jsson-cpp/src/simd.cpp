@@ -0,0 +1,152 @@
+#include "simd.hpp"
+#include <atomic>
+#include <cstdlib>
+
+namespace jsson {
+namespace simd {
+
+/*=====================================================================
+ *  Scalar kernels
+ *====================================================================*/
+
+static size_t findQuoteOrBackslashScalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && data[i] != '"' && data[i] != '\\') {
+        ++i;
+    }
+    return i;
+}
+
+static size_t findEscapableScalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && data[i] != '"' && data[i] != '\\' && static_cast<unsigned char>(data[i]) >= 0x20) {
+        ++i;
+    }
+    return i;
+}
+
+static size_t asciiPrefixScalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+static size_t whitespacePrefixScalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && (data[i] == ' ' || data[i] == '\n' || data[i] == '\r' || data[i] == '\t')) {
+        ++i;
+    }
+    return i;
+}
+
+static const SimdKernels kScalar = {
+    SimdLevel::Scalar,
+    findQuoteOrBackslashScalar,
+    findEscapableScalar,
+    asciiPrefixScalar,
+    whitespacePrefixScalar,
+};
+
+const SimdKernels* scalarKernels() noexcept {
+    return &kScalar;
+}
+
+/*=====================================================================
+ *  Dispatch
+ *====================================================================*/
+
+static std::atomic<const SimdKernels*> gActive{nullptr};
+
+/* Kernels built for @p level, or nullptr */
+static const SimdKernels* kernelsFor(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::AVX512: return avx512Kernels();
+        case SimdLevel::AVX2: return avx2Kernels();
+        case SimdLevel::SSE42: return sse42Kernels();
+        case SimdLevel::Scalar: break;
+    }
+    return scalarKernels();
+}
+
+/* Ask the CPU (cpuid, with OS state support for AVX) */
+static SimdLevel cpuLevel() noexcept {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return SimdLevel::SSE42;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel supportedLevel() noexcept {
+    static const SimdLevel supported = [] {
+        SimdLevel level = cpuLevel();
+        while (level != SimdLevel::Scalar && !kernelsFor(level)) {
+            level = static_cast<SimdLevel>(static_cast<int>(level) - 1);
+        }
+        return level;
+    }();
+    return supported;
+}
+
+SimdLevel setLevel(SimdLevel level) noexcept {
+    SimdLevel supported = supportedLevel();
+    if (level > supported) {
+        level = supported;
+    }
+    while (!kernelsFor(level)) {
+        level = static_cast<SimdLevel>(static_cast<int>(level) - 1);
+    }
+    gActive.store(kernelsFor(level), std::memory_order_release);
+    return level;
+}
+
+const SimdKernels& kernels() noexcept {
+    const SimdKernels* active = gActive.load(std::memory_order_acquire);
+    if (!active) {
+        SimdLevel level = supportedLevel();
+        if (const char* forced = std::getenv("JSSON_SIMD")) {
+            if (auto parsed = parseLevel(forced)) {
+                level = *parsed;
+            }
+        }
+        // Racing first callers pick the same level
+        setLevel(level);
+        active = gActive.load(std::memory_order_acquire);
+    }
+    return *active;
+}
+
+SimdLevel activeLevel() noexcept {
+    return kernels().level;
+}
+
+const char* levelName(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE42: return "sse4.2";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+std::optional<SimdLevel> parseLevel(std::string_view name) noexcept {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (name == levelName(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace simd
+} // namespace jsson
@@ -0,0 +1,104 @@
+#include "simd.hpp"
+
+/* Built with -mavx2 (see CMakeLists.txt); empty elsewhere */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSSON_SIMD_AVX2 1
+#endif
+
+namespace jsson {
+namespace simd {
+
+#ifdef JSSON_SIMD_AVX2
+
+/* Index of the lowest set bit of a non-zero 32-bit movemask */
+static inline size_t lowestBit(int mask) noexcept {
+    return static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+}
+
+static size_t findQuoteOrBackslashAvx2(const char* data, size_t size) noexcept {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    size_t i = 0;
+    for (; size - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+        int mask = _mm256_movemask_epi8(hit);
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->findQuoteOrBackslash(data + i, size - i);
+}
+
+static size_t findEscapableAvx2(const char* data, size_t size) noexcept {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i lastControl = _mm256_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; size - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // Unsigned chunk <= 0x1f
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, lastControl), chunk);
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+        int mask = _mm256_movemask_epi8(_mm256_or_si256(hit, control));
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->findEscapable(data + i, size - i);
+}
+
+static size_t asciiPrefixAvx2(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    for (; size - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        int mask = _mm256_movemask_epi8(chunk);
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->asciiPrefix(data + i, size - i);
+}
+
+static size_t whitespacePrefixAvx2(const char* data, size_t size) noexcept {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; size - i >= 32; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newline), _mm256_cmpeq_epi8(chunk, carriage)));
+        int mask = ~_mm256_movemask_epi8(ws);
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->whitespacePrefix(data + i, size - i);
+}
+
+static const SimdKernels kAvx2 = {
+    SimdLevel::AVX2,
+    findQuoteOrBackslashAvx2,
+    findEscapableAvx2,
+    asciiPrefixAvx2,
+    whitespacePrefixAvx2,
+};
+
+const SimdKernels* avx2Kernels() noexcept {
+    return &kAvx2;
+}
+
+#else
+
+const SimdKernels* avx2Kernels() noexcept {
+    return nullptr;
+}
+
+#endif // JSSON_SIMD_AVX2
+
+} // namespace simd
+} // namespace jsson
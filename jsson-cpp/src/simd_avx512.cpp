@@ -0,0 +1,98 @@
+#include "simd.hpp"
+
+/* Built with -mavx512f -mavx512bw (see CMakeLists.txt); empty elsewhere */
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#include <immintrin.h>
+#define JSSON_SIMD_AVX512 1
+#endif
+
+namespace jsson {
+namespace simd {
+
+#ifdef JSSON_SIMD_AVX512
+
+static inline size_t lowestBit(__mmask64 mask) noexcept {
+    return static_cast<size_t>(__builtin_ctzll(mask));
+}
+
+static size_t findQuoteOrBackslashAvx512(const char* data, size_t size) noexcept {
+    const __m512i quote = _mm512_set1_epi8('"');
+    const __m512i backslash = _mm512_set1_epi8('\\');
+    size_t i = 0;
+    for (; size - i >= 64; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(data + i);
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(chunk, quote) | _mm512_cmpeq_epi8_mask(chunk, backslash);
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->findQuoteOrBackslash(data + i, size - i);
+}
+
+static size_t findEscapableAvx512(const char* data, size_t size) noexcept {
+    const __m512i quote = _mm512_set1_epi8('"');
+    const __m512i backslash = _mm512_set1_epi8('\\');
+    const __m512i lastControl = _mm512_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; size - i >= 64; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(data + i);
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(chunk, quote) | _mm512_cmpeq_epi8_mask(chunk, backslash) |
+                         _mm512_cmple_epu8_mask(chunk, lastControl);
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->findEscapable(data + i, size - i);
+}
+
+static size_t asciiPrefixAvx512(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    for (; size - i >= 64; i += 64) {
+        __mmask64 mask = _mm512_movepi8_mask(_mm512_loadu_si512(data + i));
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+    }
+    return i + scalarKernels()->asciiPrefix(data + i, size - i);
+}
+
+static size_t whitespacePrefixAvx512(const char* data, size_t size) noexcept {
+    const __m512i space = _mm512_set1_epi8(' ');
+    const __m512i tab = _mm512_set1_epi8('\t');
+    const __m512i newline = _mm512_set1_epi8('\n');
+    const __m512i carriage = _mm512_set1_epi8('\r');
+    size_t i = 0;
+    for (; size - i >= 64; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(data + i);
+        __mmask64 ws = _mm512_cmpeq_epi8_mask(chunk, space) | _mm512_cmpeq_epi8_mask(chunk, tab) |
+                       _mm512_cmpeq_epi8_mask(chunk, newline) |
+                       _mm512_cmpeq_epi8_mask(chunk, carriage);
+        if (~ws != 0) {
+            return i + lowestBit(~ws);
+        }
+    }
+    return i + scalarKernels()->whitespacePrefix(data + i, size - i);
+}
+
+static const SimdKernels kAvx512 = {
+    SimdLevel::AVX512,
+    findQuoteOrBackslashAvx512,
+    findEscapableAvx512,
+    asciiPrefixAvx512,
+    whitespacePrefixAvx512,
+};
+
+const SimdKernels* avx512Kernels() noexcept {
+    return &kAvx512;
+}
+
+#else
+
+const SimdKernels* avx512Kernels() noexcept {
+    return nullptr;
+}
+
+#endif // JSSON_SIMD_AVX512
+
+} // namespace simd
+} // namespace jsson
@@ -0,0 +1,90 @@
+#include "simd.hpp"
+
+/* Built with -msse4.2 (see CMakeLists.txt); empty elsewhere */
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define JSSON_SIMD_SSE42 1
+#endif
+
+namespace jsson {
+namespace simd {
+
+#ifdef JSSON_SIMD_SSE42
+
+static constexpr int kAnyOf = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+
+static size_t findQuoteOrBackslashSse42(const char* data, size_t size) noexcept {
+    const __m128i set = _mm_setr_epi8('"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+    for (; size - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Explicit lengths: NUL bytes in the input must not end the string
+        int index = _mm_cmpestri(set, 2, chunk, 16, kAnyOf);
+        if (index < 16) {
+            return i + static_cast<size_t>(index);
+        }
+    }
+    return i + scalarKernels()->findQuoteOrBackslash(data + i, size - i);
+}
+
+static size_t findEscapableSse42(const char* data, size_t size) noexcept {
+    // Pairs of inclusive ranges: controls, quote, backslash
+    const __m128i ranges = _mm_setr_epi8(0x00, 0x1f, '"', '"', '\\', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+    for (; size - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int index = _mm_cmpestri(ranges, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16) {
+            return i + static_cast<size_t>(index);
+        }
+    }
+    return i + scalarKernels()->findEscapable(data + i, size - i);
+}
+
+static size_t asciiPrefixSse42(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    for (; size - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int high = _mm_movemask_epi8(chunk);
+        if (high != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(high)));
+        }
+    }
+    return i + scalarKernels()->asciiPrefix(data + i, size - i);
+}
+
+static size_t whitespacePrefixSse42(const char* data, size_t size) noexcept {
+    const __m128i set = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+    for (; size - i >= 16; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int index = _mm_cmpestri(set, 4, chunk, 16, kAnyOf | _SIDD_NEGATIVE_POLARITY);
+        if (index < 16) {
+            return i + static_cast<size_t>(index);
+        }
+    }
+    return i + scalarKernels()->whitespacePrefix(data + i, size - i);
+}
+
+static const SimdKernels kSse42 = {
+    SimdLevel::SSE42,
+    findQuoteOrBackslashSse42,
+    findEscapableSse42,
+    asciiPrefixSse42,
+    whitespacePrefixSse42,
+};
+
+const SimdKernels* sse42Kernels() noexcept {
+    return &kSse42;
+}
+
+#else
+
+const SimdKernels* sse42Kernels() noexcept {
+    return nullptr;
+}
+
+#endif // JSSON_SIMD_SSE42
+
+} // namespace simd
+} // namespace jsson
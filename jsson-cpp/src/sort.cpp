@@ -0,0 +1,723 @@
+#include "sort.hpp"
+#include "error.hpp"
+#include "io.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace jsson {
+
+/*=====================================================================
+ *  Normalized sort keys
+ *====================================================================*/
+
+/* Type classes in sort order */
+enum class KeyRank : uint8_t {
+    Missing,
+    Null,
+    Boolean,
+    Number,
+    NaN,
+    String,
+    Array,
+    Object
+};
+
+/*
+ * One element's key.  Strings keep their first eight bytes as a
+ * big-endian integer so most comparisons never dereference the string.
+ */
+struct SortKey {
+    KeyRank rank;
+    bool integer;
+    uint32_t index;
+    union {
+        int64_t i;
+        double d;
+        uint64_t prefix;
+    };
+    const char* str;
+    size_t length;
+};
+
+/* Arrays with fewer elements are sorted on the calling thread */
+static constexpr size_t kParallelThreshold = 1 << 15;
+
+static uint64_t stringPrefix(std::string_view s) noexcept {
+    unsigned char bytes[8] = {0};
+    std::memcpy(bytes, s.data(), std::min<size_t>(s.size(), 8));
+    uint64_t prefix = 0;
+    for (unsigned char b : bytes) {
+        prefix = (prefix << 8) | b;
+    }
+    return prefix;
+}
+
+static SortKey makeKey(const JsonValue* element, const JsonPointer& pointer, uint32_t index) {
+    SortKey key;
+    key.rank = KeyRank::Missing;
+    key.integer = false;
+    key.index = index;
+    key.i = 0;
+    key.str = nullptr;
+    key.length = 0;
+
+    const JsonValue* value = element ? pointer.resolve(*element) : nullptr;
+    if (!value) {
+        return key;
+    }
+    switch (value->type()) {
+    case JsonValue::Type::Null:
+        key.rank = KeyRank::Null;
+        break;
+    case JsonValue::Type::Boolean:
+        key.rank = KeyRank::Boolean;
+        key.integer = true;
+        key.i = value->asBoolean() ? 1 : 0;
+        break;
+    case JsonValue::Type::Number:
+        if (auto i = std::get_if<int64_t>(&value->raw_variant())) {
+            key.rank = KeyRank::Number;
+            key.integer = true;
+            key.i = *i;
+        } else {
+            key.d = value->asNumber();
+            key.rank = std::isnan(key.d) ? KeyRank::NaN : KeyRank::Number;
+        }
+        break;
+    case JsonValue::Type::String: {
+        std::string_view s = value->asStringView();
+        key.rank = KeyRank::String;
+        key.prefix = stringPrefix(s);
+        key.str = s.data();
+        key.length = s.size();
+        break;
+    }
+    case JsonValue::Type::Array:
+        key.rank = KeyRank::Array;
+        break;
+    case JsonValue::Type::Object:
+        key.rank = KeyRank::Object;
+        break;
+    }
+    return key;
+}
+
+/*
+ * Compare @p i with a non-NaN @p d exactly.  Converting i to double
+ * rounds above 2^53, which would make 2^53 + 1 equal to 2^53 (as a
+ * double) but greater than 2^53 (as an int64) and break transitivity.
+ */
+static int compareIntDouble(int64_t i, double d) noexcept {
+    // Every int64 lies in [-2^63, 2^63)
+    if (d >= 9223372036854775808.0) {
+        return -1;
+    }
+    if (d < -9223372036854775808.0) {
+        return 1;
+    }
+    double whole = std::trunc(d);
+    int64_t j = static_cast<int64_t>(whole);
+    if (i != j) {
+        return i < j ? -1 : 1;
+    }
+    // Same integer part: the fraction decides
+    return whole < d ? -1 : (d < whole ? 1 : 0);
+}
+
+static int compareNumbers(const SortKey& a, const SortKey& b) noexcept {
+    if (a.integer && b.integer) {
+        return a.i < b.i ? -1 : (b.i < a.i ? 1 : 0);
+    }
+    if (a.integer) {
+        return compareIntDouble(a.i, b.d);
+    }
+    if (b.integer) {
+        return -compareIntDouble(b.i, a.d);
+    }
+    return a.d < b.d ? -1 : (b.d < a.d ? 1 : 0);
+}
+
+static int compareKeys(const SortKey& a, const SortKey& b) noexcept {
+    if (a.rank != b.rank) {
+        return a.rank < b.rank ? -1 : 1;
+    }
+    switch (a.rank) {
+    case KeyRank::Boolean:
+    case KeyRank::Number:
+        return compareNumbers(a, b);
+    case KeyRank::String:
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix ? -1 : 1;
+        }
+        {
+            int c = std::string_view(a.str, a.length).compare(std::string_view(b.str, b.length));
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        }
+    default:
+        return 0;
+    }
+}
+
+/* Strict total order: the key, then the original position */
+struct KeyLess {
+    bool descending;
+
+    bool operator()(const SortKey& a, const SortKey& b) const noexcept {
+        int c = compareKeys(a, b);
+        if (c != 0) {
+            return descending ? c > 0 : c < 0;
+        }
+        return a.index < b.index;
+    }
+};
+
+/*=====================================================================
+ *  Parallel helpers
+ *====================================================================*/
+
+static unsigned workerCount(unsigned threads, size_t size) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (size < kParallelThreshold) {
+        return 1;
+    }
+    return static_cast<unsigned>(std::min<size_t>(threads, size / (kParallelThreshold / 4)));
+}
+
+/* Run body(part) for part in [0, parts), on worker threads when parts > 1 */
+template <typename Body>
+static void runParts(unsigned parts, Body body) {
+    if (parts <= 1) {
+        body(0u);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (unsigned part = 1; part < parts; ++part) {
+        workers.emplace_back(body, part);
+    }
+    body(0u);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+static std::vector<SortKey> extractKeys(const JsonArray::Vec& elements, const JsonPointer& pointer,
+                                        unsigned parts) {
+    if (elements.size() > UINT32_MAX) {
+        throw JsonError(JsonErrorCode::InvalidArgument, "array too large to sort");
+    }
+    std::vector<SortKey> keys(elements.size());
+    const size_t n = elements.size();
+    runParts(parts, [&](unsigned part) {
+        size_t begin = n * part / parts;
+        size_t end = n * (part + 1) / parts;
+        for (size_t i = begin; i < end; ++i) {
+            keys[i] = makeKey(elements[i].get(), pointer, static_cast<uint32_t>(i));
+        }
+    });
+    return keys;
+}
+
+/*
+ * Sort each of @p parts runs on its own thread, then merge neighbouring
+ * runs pairwise, one thread per pair, until a single run remains.
+ */
+static void parallelMergeSort(std::vector<SortKey>& keys, KeyLess less, unsigned parts) {
+    const size_t n = keys.size();
+    if (parts <= 1) {
+        std::sort(keys.begin(), keys.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds(parts + 1);
+    for (unsigned part = 0; part <= parts; ++part) {
+        bounds[part] = n * part / parts;
+    }
+    runParts(parts, [&](unsigned part) {
+        std::sort(keys.begin() + bounds[part], keys.begin() + bounds[part + 1], less);
+    });
+
+    std::vector<SortKey> buffer(n);
+    for (unsigned width = 1; width < parts; width *= 2) {
+        unsigned pairs = (parts + 2 * width - 1) / (2 * width);
+        runParts(pairs, [&](unsigned pair) {
+            size_t lo = bounds[std::min(parts, pair * 2 * width)];
+            size_t mid = bounds[std::min(parts, pair * 2 * width + width)];
+            size_t hi = bounds[std::min(parts, pair * 2 * width + 2 * width)];
+            std::merge(keys.begin() + lo, keys.begin() + mid,
+                       keys.begin() + mid, keys.begin() + hi,
+                       buffer.begin() + lo, less);
+        });
+        keys.swap(buffer);
+    }
+}
+
+/*=====================================================================
+ *  Public API
+ *====================================================================*/
+
+void sortBy(JsonArray& array, const JsonPointer& key, SortOrder order, unsigned threads) {
+    JsonArray::Vec& elements = array.data();
+    unsigned parts = workerCount(threads, elements.size());
+
+    std::vector<SortKey> keys = extractKeys(elements, key, parts);
+    parallelMergeSort(keys, KeyLess{order == SortOrder::Descending}, parts);
+
+    JsonArray::Vec sorted;
+    sorted.reserve(elements.size());
+    for (const SortKey& k : keys) {
+        sorted.push_back(std::move(elements[k.index]));
+    }
+    elements.swap(sorted);
+}
+
+JsonArray topK(const JsonArray& array, const JsonPointer& key, size_t k,
+               SortOrder order, unsigned threads) {
+    const JsonArray::Vec& elements = array.data();
+    const size_t n = elements.size();
+    k = std::min(k, n);
+    unsigned parts = workerCount(threads, n);
+    KeyLess less{order == SortOrder::Descending};
+
+    std::vector<SortKey> keys = extractKeys(elements, key, parts);
+
+    // Each part moves its best k keys to the front of its range
+    std::vector<size_t> kept(parts);
+    runParts(parts, [&](unsigned part) {
+        auto begin = keys.begin() + n * part / parts;
+        auto end = keys.begin() + n * (part + 1) / parts;
+        size_t take = std::min<size_t>(k, static_cast<size_t>(end - begin));
+        std::nth_element(begin, begin + take, end, less);
+        kept[part] = take;
+    });
+
+    std::vector<SortKey> candidates;
+    candidates.reserve(std::min(n, k * parts));
+    for (unsigned part = 0; part < parts; ++part) {
+        auto begin = keys.begin() + n * part / parts;
+        candidates.insert(candidates.end(), begin, begin + kept[part]);
+    }
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(), less);
+
+    JsonArray::Vec selected;
+    selected.reserve(k);
+    for (size_t i = 0; i < k; ++i) {
+        selected.push_back(elements[candidates[i].index]);
+    }
+    return JsonArray(std::move(selected));
+}
+
+/*=====================================================================
+ *  External sort
+ *====================================================================*/
+
+/* Bytes a run file record starts with: rank, integer flag, payload, two lengths */
+static constexpr size_t kRunHeader = 2 + 8 + 4 + 4;
+
+/* Run writes are batched into blocks of this size */
+static constexpr size_t kRunBlock = 1 << 20;
+
+/* Stable storage for key strings copied out of parsed records */
+class KeyText {
+public:
+    const char* add(std::string_view text) {
+        if (text.size() > kChunk) {
+            // Oversized strings get a block of their own
+            large_.push_back(std::make_unique<char[]>(text.size()));
+            std::memcpy(large_.back().get(), text.data(), text.size());
+            return large_.back().get();
+        }
+        if (chunks_.empty() || text.size() > kChunk - used_) {
+            chunks_.push_back(std::make_unique<char[]>(kChunk));
+            used_ = 0;
+        }
+        char* copy = chunks_.back().get() + used_;
+        std::memcpy(copy, text.data(), text.size());
+        used_ += text.size();
+        return copy;
+    }
+
+private:
+    static constexpr size_t kChunk = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::vector<std::unique_ptr<char[]>> large_;
+    size_t used_ = 0;
+};
+
+/* Records buffered in memory; lines are kept verbatim */
+struct Run {
+    struct Entry {
+        size_t offset;
+        size_t length;
+        size_t line;
+    };
+
+    std::string bytes;
+    std::vector<Entry> entries;
+    std::vector<SortKey> keys;
+    std::vector<KeyText> text;
+
+    std::string_view lineAt(const Entry& entry) const {
+        return std::string_view(bytes.data() + entry.offset, entry.length);
+    }
+
+    size_t footprint() const noexcept {
+        return bytes.size() + entries.size() * (sizeof(Entry) + sizeof(SortKey));
+    }
+};
+
+/* Parse every record of @p run in parallel and sort its keys */
+static void sortRun(Run& run, const JsonPointer& pointer, KeyLess less, unsigned threads) {
+    const size_t n = run.entries.size();
+    unsigned parts = workerCount(threads, n);
+    run.keys.assign(n, SortKey());
+    run.text.clear();
+    run.text.resize(parts);
+    std::vector<std::exception_ptr> errors(parts);
+
+    runParts(parts, [&](unsigned part) {
+        try {
+            ParseOptions options;
+            options.keyPredictor = std::make_shared<KeyOrderPredictor>();
+            KeyText& text = run.text[part];
+            for (size_t i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+                const Run::Entry& entry = run.entries[i];
+                ValuePtr record;
+                try {
+                    record = Parser::parseText(run.lineAt(entry), options);
+                } catch (const JsonError& e) {
+                    throw JsonError(static_cast<JsonErrorCode>(e.code().value()),
+                                    "line " + std::to_string(entry.line) + ": " + e.what());
+                }
+                SortKey key = makeKey(record.get(), pointer, static_cast<uint32_t>(i));
+                if (key.rank == KeyRank::String) {
+                    // The parsed record dies here; keep the key bytes
+                    key.str = text.add(std::string_view(key.str, key.length));
+                }
+                run.keys[i] = key;
+            }
+        } catch (...) {
+            errors[part] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    parallelMergeSort(run.keys, less, parts);
+}
+
+/* Append-only run file: header, key bytes, line bytes per record */
+class RunWriter {
+public:
+    explicit RunWriter(const std::string& path) : sink_(openOutput(path)) {
+        block_.reserve(kRunBlock + kRunHeader);
+    }
+
+    void put(const SortKey& key, std::string_view line) {
+        size_t keyLength = key.rank == KeyRank::String ? key.length : 0;
+        if (keyLength > UINT32_MAX || line.size() > UINT32_MAX) {
+            throw JsonError(JsonErrorCode::InputTooLarge, "external sort: record over 4 GiB");
+        }
+        char header[kRunHeader];
+        header[0] = static_cast<char>(key.rank);
+        header[1] = static_cast<char>(key.integer);
+        std::memcpy(header + 2, &key.i, 8);
+        uint32_t lengths[2] = {static_cast<uint32_t>(keyLength), static_cast<uint32_t>(line.size())};
+        std::memcpy(header + 10, lengths, 8);
+        block_.append(header, kRunHeader);
+        block_.append(key.str ? key.str : "", keyLength);
+        block_.append(line.data(), line.size());
+        if (block_.size() >= kRunBlock) {
+            sink_->write(block_.data(), block_.size());
+            block_.clear();
+        }
+    }
+
+    void close() {
+        sink_->write(block_.data(), block_.size());
+        block_.clear();
+        sink_->close();
+    }
+
+private:
+    std::unique_ptr<OutputSink> sink_;
+    std::string block_;
+};
+
+/* Sequential reader of one run file; key and line stay valid until next() */
+class RunReader {
+public:
+    RunReader(const std::string& path, size_t chunk)
+        : source_(openInput(path)), chunk_(chunk) {}
+
+    bool next() {
+        pos_ += consumed_;
+        consumed_ = 0;
+        if (!need(kRunHeader)) {
+            if (pos_ != buffer_.size()) {
+                throw JsonError(JsonErrorCode::PrematureEndOfInput, "external sort: truncated run file");
+            }
+            return false;
+        }
+        const char* header = buffer_.data() + pos_;
+        uint32_t lengths[2];
+        std::memcpy(lengths, header + 10, 8);
+        if (!need(kRunHeader + size_t(lengths[0]) + lengths[1])) {
+            throw JsonError(JsonErrorCode::PrematureEndOfInput, "external sort: truncated run file");
+        }
+        header = buffer_.data() + pos_;
+        key.rank = static_cast<KeyRank>(header[0]);
+        key.integer = header[1] != 0;
+        key.index = 0;
+        std::memcpy(&key.i, header + 2, 8);
+        key.str = header + kRunHeader;
+        key.length = lengths[0];
+        line = std::string_view(key.str + lengths[0], lengths[1]);
+        consumed_ = kRunHeader + size_t(lengths[0]) + lengths[1];
+        return true;
+    }
+
+    SortKey key;
+    std::string_view line;
+
+private:
+    /* Make @p size bytes from pos_ available; false if the file ends first */
+    bool need(size_t size) {
+        if (buffer_.size() - pos_ >= size) {
+            return true;
+        }
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        while (buffer_.size() < size) {
+            size_t old = buffer_.size();
+            size_t want = std::max(chunk_, size - old);
+            buffer_.resize(old + want);
+            size_t n = source_->read(&buffer_[old], want);
+            buffer_.resize(old + n);
+            if (n == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<InputSource> source_;
+    size_t chunk_;
+    std::string buffer_;
+    size_t pos_ = 0;
+    size_t consumed_ = 0;
+};
+
+/*
+ * Tournament tree over k runs.  Leaves are runs, each internal node keeps
+ * the loser of the match played there and the overall winner sits on
+ * top, so replacing the winner's record replays one root path: log2(k)
+ * comparisons per record rather than a heap's 2 log2(k).
+ */
+class LoserTree {
+public:
+    LoserTree(std::vector<RunReader>& runs, bool descending)
+        : runs_(runs), done_(runs.size()), tree_(std::max<size_t>(runs.size(), 1)),
+          descending_(descending) {
+        for (size_t i = 0; i < runs_.size(); ++i) {
+            done_[i] = !runs_[i].next();
+        }
+        if (!runs_.empty()) {
+            tree_[0] = build(1);
+        }
+    }
+
+    /* The run holding the smallest record, or none when all are drained */
+    bool top(size_t& run) const noexcept {
+        if (runs_.empty() || done_[tree_[0]]) {
+            return false;
+        }
+        run = tree_[0];
+        return true;
+    }
+
+    /* Move the winning run to its next record and replay its path */
+    void pop() {
+        size_t winner = tree_[0];
+        done_[winner] = !runs_[winner].next();
+        for (size_t node = (winner + runs_.size()) / 2; node >= 1; node /= 2) {
+            if (beats(tree_[node], winner)) {
+                std::swap(tree_[node], winner);
+            }
+        }
+        tree_[0] = winner;
+    }
+
+private:
+    /* Leaves are nodes k..2k-1; returns the subtree's winner */
+    size_t build(size_t node) {
+        const size_t k = runs_.size();
+        if (node >= k) {
+            return node - k;
+        }
+        size_t a = build(2 * node);
+        size_t b = build(2 * node + 1);
+        bool aWins = beats(a, b);
+        tree_[node] = aWins ? b : a;
+        return aWins ? a : b;
+    }
+
+    /* Drained runs lose; equal keys go to the earlier run, keeping the sort stable */
+    bool beats(size_t a, size_t b) const noexcept {
+        if (done_[a] != done_[b]) {
+            return done_[b];
+        }
+        if (done_[a]) {
+            return a < b;
+        }
+        int c = compareKeys(runs_[a].key, runs_[b].key);
+        if (c != 0) {
+            return descending_ ? c > 0 : c < 0;
+        }
+        return a < b;
+    }
+
+    std::vector<RunReader>& runs_;
+    std::vector<char> done_;
+    std::vector<size_t> tree_;
+    bool descending_;
+};
+
+/* Merge @p paths in order, handing each record to emit(key, line) */
+template <typename Emit>
+static void mergeRuns(const std::vector<std::string>& paths, bool descending, size_t memoryLimit,
+                      Emit emit) {
+    std::vector<RunReader> runs;
+    runs.reserve(paths.size());
+    size_t chunk = std::max<size_t>(64 * 1024, memoryLimit / (paths.size() + 1));
+    for (const std::string& path : paths) {
+        runs.emplace_back(path, chunk);
+    }
+    LoserTree tree(runs, descending);
+    size_t run;
+    while (tree.top(run)) {
+        emit(runs[run].key, runs[run].line);
+        tree.pop();
+    }
+}
+
+static void spillRun(const Run& run, const std::string& path) {
+    RunWriter writer(path);
+    for (const SortKey& key : run.keys) {
+        writer.put(key, run.lineAt(run.entries[key.index]));
+    }
+    writer.close();
+}
+
+size_t sortNdjson(NdjsonReader& in, NdjsonWriter& out, const JsonPointer& key,
+                  const ExternalSortOptions& options) {
+    if (options.memoryLimit == 0 || options.maxFanIn < 2) {
+        throw JsonError(JsonErrorCode::InvalidArgument,
+                        "external sort: memoryLimit must be positive and maxFanIn at least 2");
+    }
+    const KeyLess less{options.order == SortOrder::Descending};
+    const size_t runLimit = std::max<size_t>(options.memoryLimit / 2, 1);
+    ScratchFiles scratch(options.scratchDir, "jsson-sort");
+    std::vector<std::string> runs;
+
+    // One run spills in the background while the next one fills
+    Run filling;
+    Run spilling;
+    std::thread spiller;
+    std::exception_ptr spillError;
+    auto joinSpiller = [&] {
+        if (spiller.joinable()) {
+            spiller.join();
+        }
+        if (spillError) {
+            std::rethrow_exception(spillError);
+        }
+    };
+
+    size_t total = 0;
+    bool more = true;
+    try {
+        while (more) {
+            std::string_view line;
+            while ((more = in.nextLine(line))) {
+                filling.entries.push_back({filling.bytes.size(), line.size(), in.lineNumber()});
+                filling.bytes.append(line.data(), line.size());
+                if (filling.footprint() >= runLimit || filling.entries.size() == UINT32_MAX) {
+                    break;
+                }
+            }
+            if (filling.entries.empty() && !runs.empty()) {
+                break; // the previous run ended exactly at end of input
+            }
+            total += filling.entries.size();
+            sortRun(filling, key, less, options.threads);
+
+            if (!more && runs.empty()) {
+                // Everything fit in one run: no scratch files at all
+                for (const SortKey& k : filling.keys) {
+                    out.writeLine(filling.lineAt(filling.entries[k.index]));
+                }
+                return total;
+            }
+
+            joinSpiller();
+            std::swap(filling, spilling);
+            filling = Run();
+            runs.push_back(scratch.create());
+            spiller = std::thread([&spilling, &spillError, path = runs.back()] {
+                try {
+                    spillRun(spilling, path);
+                } catch (...) {
+                    spillError = std::current_exception();
+                }
+            });
+        }
+        joinSpiller();
+    } catch (...) {
+        if (spiller.joinable()) {
+            spiller.join();
+        }
+        throw;
+    }
+    spilling = Run();
+
+    // Merge consecutive groups until one pass can reach every run
+    while (runs.size() > options.maxFanIn) {
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runs.size(); first += options.maxFanIn) {
+            std::vector<std::string> group(runs.begin() + static_cast<std::ptrdiff_t>(first),
+                                           runs.begin() + static_cast<std::ptrdiff_t>(
+                                               std::min(runs.size(), first + options.maxFanIn)));
+            if (group.size() == 1) {
+                merged.push_back(group[0]);
+                continue;
+            }
+            merged.push_back(scratch.create());
+            RunWriter writer(merged.back());
+            mergeRuns(group, less.descending, options.memoryLimit,
+                      [&](const SortKey& k, std::string_view line) { writer.put(k, line); });
+            writer.close();
+            for (const std::string& path : group) {
+                scratch.remove(path);
+            }
+        }
+        runs.swap(merged);
+    }
+
+    mergeRuns(runs, less.descending, options.memoryLimit,
+              [&](const SortKey&, std::string_view line) { out.writeLine(line); });
+    return total;
+}
+
+} // namespace jsson
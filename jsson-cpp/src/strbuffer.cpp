@@ -1,4 +1,5 @@
 #include "strbuffer.hpp"
+#include "base64.hpp"
 #include <algorithm>
 #include <cstring>
 
@@ -26,6 +27,16 @@ StringBuffer& StringBuffer::append(const char* data, size_t size) {
     return *this;
 }
 
+StringBuffer& StringBuffer::appendBase64(const void* data, size_t size) {
+    if (size > 0) {
+        size_t length = Base64::encodedLength(size);
+        ensure_capacity(size_ + length + 1);
+        size_ += Base64::encode(data, size, &buffer_[size_]);
+        buffer_[size_] = '\0';
+    }
+    return *this;
+}
+
 StringBuffer& StringBuffer::prepend(char c) {
     return prepend(&c, 1);
 }
@@ -59,7 +70,7 @@ const char* StringBuffer::value() const {
 }
 
 std::string StringBuffer::str() const {
-    return buffer_;
+    return buffer_.substr(0, size_);
 }
 
 size_t StringBuffer::size() const {
@@ -72,16 +83,16 @@ void StringBuffer::clear() {
 }
 
 std::string StringBuffer::steal() {
-    buffer_[size_] = '\0';
-    return std::move(buffer_);
+    buffer_.resize(size_);
+    std::string result = std::move(buffer_);
+    buffer_.assign(1, '\0');
+    size_ = 0;
+    return result;
 }
 
 void StringBuffer::ensure_capacity(size_t min_capacity) {
-    if (buffer_.capacity() >= min_capacity) return;
-    // Reserve new capacity, preserving existing content and null terminator
-    std::string new_buffer;
-    new_buffer.reserve(min_capacity);
-    new_buffer.append(buffer_, size_); // copy existing characters
-    new_buffer.push_back('\0');        // add null terminator
-    buffer_.swap(new_buffer);
+    if (buffer_.size() >= min_capacity) return;
+    // Grow the string itself (not just its capacity) so writes past size_
+    // stay inside it; characters beyond size_ are scratch space
+    buffer_.resize(std::max(min_capacity, buffer_.size() * 2), '\0');
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "string_dictionary.hpp"
+#include <mutex>
+
+namespace jsson {
+
+InternedString StringDictionary::intern(std::string_view value) {
+    if (threadSafe_) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(value);
+        if (it != entries_.end()) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            lookups_.fetch_add(1, std::memory_order_relaxed);
+            return InternedString{it->second};
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (threadSafe_) {
+        lock.lock();
+    }
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    auto it = entries_.find(value);
+    if (it != entries_.end()) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return InternedString{it->second};
+    }
+    auto entry = std::make_shared<const std::string>(value);
+    entries_.emplace(std::string_view(*entry), entry);
+    return InternedString{std::move(entry)};
+}
+
+InternedString StringDictionary::find(std::string_view value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (threadSafe_) {
+        lock.lock();
+    }
+    auto it = entries_.find(value);
+    if (it == entries_.end()) {
+        return InternedString{};
+    }
+    return InternedString{it->second};
+}
+
+size_t StringDictionary::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (threadSafe_) {
+        lock.lock();
+    }
+    return entries_.size();
+}
+
+size_t StringDictionary::purge() {
+    std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (threadSafe_) {
+        lock.lock();
+    }
+    size_t removed = 0;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.use_count() == 1) {
+            it = entries_.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+} // namespace jsson
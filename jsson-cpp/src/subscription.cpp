@@ -0,0 +1,289 @@
+#include "subscription.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace jsson {
+
+/*=====================================================================
+ *  Pattern trie
+ *====================================================================*/
+
+/* One reference token position; ids live on the node their pattern ends at */
+struct SubscriptionIndex::Node {
+    std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    std::unique_ptr<Node> wildcard;
+    std::vector<Id> exact;     // every subscription ending here
+    std::vector<Id> deep;      // the subset that also watches descendants
+    Node* parent = nullptr;    // nullptr for the root
+    std::string key;           // token of the edge from parent; "*" for the wildcard
+
+    bool empty() const noexcept { return exact.empty() && children.empty() && !wildcard; }
+};
+
+struct SubscriptionIndex::Subscription {
+    std::shared_ptr<const Callback> callback;
+    Node* node;
+};
+
+SubscriptionIndex::SubscriptionIndex() : root_(std::make_unique<Node>()) {}
+
+SubscriptionIndex::~SubscriptionIndex() = default;
+
+static void removeId(std::vector<SubscriptionIndex::Id>& ids, SubscriptionIndex::Id id) {
+    auto it = std::find(ids.begin(), ids.end(), id);
+    if (it != ids.end()) {
+        *it = ids.back();
+        ids.pop_back();
+    }
+}
+
+/* Collect every subscription ending at or below @p node */
+template<typename Node, typename Id>
+static void collectSubtree(const Node& node, std::vector<Id>& out) {
+    out.insert(out.end(), node.exact.begin(), node.exact.end());
+    for (const auto& [key, child] : node.children) {
+        collectSubtree(*child, out);
+    }
+    if (node.wildcard) {
+        collectSubtree(*node.wildcard, out);
+    }
+}
+
+SubscriptionIndex::Id SubscriptionIndex::subscribe(std::string_view pattern, Callback callback,
+                                                   bool watchDescendants) {
+    JsonPointer pointer(pattern);
+    auto shared = std::make_shared<const Callback>(std::move(callback));
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Node* node = root_.get();
+    for (const JsonPointer::Token& token : pointer.tokens()) {
+        std::unique_ptr<Node>& next = token.key == "*" ? node->wildcard : node->children[token.key];
+        if (!next) {
+            next = std::make_unique<Node>();
+            next->parent = node;
+            next->key = token.key;
+            ++nodes_;
+        }
+        node = next.get();
+    }
+    Id id = nextId_++;
+    node->exact.push_back(id);
+    if (watchDescendants) {
+        node->deep.push_back(id);
+    }
+    subscriptions_.emplace(id, Subscription{std::move(shared), node});
+    return id;
+}
+
+bool SubscriptionIndex::unsubscribe(Id id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = subscriptions_.find(id);
+    if (it == subscriptions_.end()) {
+        return false;
+    }
+    Node* node = it->second.node;
+    removeId(node->exact, id);
+    removeId(node->deep, id);
+    subscriptions_.erase(it);
+
+    // Drop the nodes no pattern needs any more, so churn does not grow the trie
+    while (node->parent && node->empty()) {
+        Node* parent = node->parent;
+        if (node->key == "*") {
+            parent->wildcard.reset();
+        } else {
+            parent->children.erase(parent->children.find(node->key));
+        }
+        node = parent;
+        --nodes_;
+    }
+    return true;
+}
+
+size_t SubscriptionIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return subscriptions_.size();
+}
+
+size_t SubscriptionIndex::nodeCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return nodes_;
+}
+
+void SubscriptionIndex::match(const JsonPointer& path, std::vector<Id>& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<const Node*> active{root_.get()};
+    std::vector<const Node*> next;
+    for (const JsonPointer::Token& token : path.tokens()) {
+        for (const Node* node : active) {
+            // The change lies below these patterns
+            out.insert(out.end(), node->deep.begin(), node->deep.end());
+            auto it = node->children.find(token.key);
+            if (it != node->children.end()) {
+                next.push_back(it->second.get());
+            }
+            if (node->wildcard) {
+                next.push_back(node->wildcard.get());
+            }
+        }
+        active.swap(next);
+        next.clear();
+        if (active.empty()) {
+            return;
+        }
+    }
+    // Nodes reached at the same depth have disjoint subtrees, so no id repeats
+    for (const Node* node : active) {
+        collectSubtree(*node, out);
+    }
+}
+
+void SubscriptionIndex::notify(const std::vector<JsonPointer>& changes) const {
+    if (changes.empty()) {
+        return;
+    }
+
+    // Group the batch by subscriber, keeping first-seen order for delivery
+    std::vector<Id> order;
+    std::unordered_map<Id, std::vector<size_t>> matched;
+    std::vector<Id> ids;
+    for (size_t i = 0; i < changes.size(); ++i) {
+        ids.clear();
+        match(changes[i], ids);
+        for (Id id : ids) {
+            auto& indices = matched[id];
+            if (indices.empty()) {
+                order.push_back(id);
+            }
+            indices.push_back(i);
+        }
+    }
+    if (order.empty()) {
+        return;
+    }
+
+    // Callbacks run unlocked so they may subscribe or unsubscribe
+    std::vector<std::pair<Id, std::shared_ptr<const Callback>>> targets;
+    targets.reserve(order.size());
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (Id id : order) {
+            auto it = subscriptions_.find(id);
+            if (it != subscriptions_.end()) {
+                targets.emplace_back(id, it->second.callback);
+            }
+        }
+    }
+
+    std::vector<JsonPointer> paths;
+    for (const auto& [id, callback] : targets) {
+        paths.clear();
+        for (size_t index : matched[id]) {
+            paths.push_back(changes[index]);
+        }
+        (*callback)(paths);
+    }
+}
+
+/*=====================================================================
+ *  Transaction
+ *====================================================================*/
+
+Transaction::~Transaction() {
+    try {
+        commit();
+    } catch (...) {
+        // A throwing callback must not escape a destructor
+    }
+}
+
+void Transaction::touch(const JsonPointer& path) {
+    if (seen_.insert(path.toString()).second) {
+        changes_.push_back(path);
+    }
+}
+
+void Transaction::set(const JsonPointer& path, ValuePtr value) {
+    if (!value) {
+        value = makeRef<JsonValue>();
+    }
+    if (path.empty()) {
+        root_ = *value;
+        touch(path);
+        return;
+    }
+
+    JsonValue* parent = path.parent().resolve(root_);
+    if (!parent) {
+        throw JsonError(JsonErrorCode::ItemNotFound, "JSON pointer parent does not exist");
+    }
+    const JsonPointer::Token& token = path.tokens().back();
+    const auto& data = parent->raw_variant();
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+        (*object)->keys()[token.key] = std::move(value);
+        touch(path);
+    } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+        (*ordered)->insert(token.key, std::move(value));
+        touch(path);
+    } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+        auto& vec = (*array)->data();
+        if (token.key == "-" || token.index == vec.size()) {
+            vec.push_back(std::move(value));
+            touch(path.parent().child(std::to_string(vec.size() - 1)));
+        } else if (token.index < vec.size()) {
+            vec[token.index] = std::move(value);
+            touch(path);
+        } else {
+            throw JsonError(JsonErrorCode::IndexOutOfRange, "JSON pointer index past the end of the array");
+        }
+    } else {
+        throw JsonError(JsonErrorCode::WrongType, "JSON pointer parent is not a container");
+    }
+}
+
+void Transaction::append(const JsonPointer& path, ValuePtr value) {
+    set(path.child("-"), std::move(value));
+}
+
+bool Transaction::erase(const JsonPointer& path) {
+    if (path.empty()) {
+        return false;
+    }
+    JsonValue* parent = path.parent().resolve(root_);
+    if (!parent) {
+        return false;
+    }
+    const JsonPointer::Token& token = path.tokens().back();
+    const auto& data = parent->raw_variant();
+    bool erased = false;
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+        erased = (*object)->erase(token.key);
+    } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+        erased = (*ordered)->erase(token.key);
+    } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+        auto& vec = (*array)->data();
+        if (token.index < vec.size()) {
+            vec.erase(vec.begin() + static_cast<std::ptrdiff_t>(token.index));
+            erased = true;
+        }
+    }
+    if (!erased) {
+        return false;
+    }
+    // Later elements shift down, so the array itself changed
+    touch(parent->isArray() ? path.parent() : path);
+    return true;
+}
+
+void Transaction::commit() {
+    if (changes_.empty()) {
+        return;
+    }
+    std::vector<JsonPointer> batch;
+    batch.swap(changes_);
+    seen_.clear();
+    index_.notify(batch);
+}
+
+} // namespace jsson
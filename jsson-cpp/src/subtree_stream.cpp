@@ -0,0 +1,293 @@
+#include "subtree_stream.hpp"
+
+namespace jsson {
+
+SubtreeStream::SubtreeStream(std::unique_ptr<InputSource> source, std::string_view pattern,
+                             const ParseOptions& options, size_t chunkSize)
+    : source_(std::move(source)),
+      pattern_(JsonPointer(pattern).tokens()),
+      options_(options),
+      chunkSize_(chunkSize ? chunkSize : kDefaultChunkSize) {}
+
+SubtreeStream SubtreeStream::open(const std::string& filename, std::string_view pattern,
+                                  const ParseOptions& options) {
+    return SubtreeStream(openInput(filename), pattern, options);
+}
+
+/*=====================================================================
+ *  Input window
+ *====================================================================*/
+
+/* Drop consumed bytes and append one more chunk from the source */
+bool SubtreeStream::fill() {
+    if (eof_) {
+        return false;
+    }
+    if (pos_ > 0) {
+        buffer_.erase(0, pos_);
+        dropped_ += pos_;
+        pos_ = 0;
+    }
+    size_t old = buffer_.size();
+    buffer_.resize(old + chunkSize_);
+    size_t n = source_->read(&buffer_[old], chunkSize_);
+    buffer_.resize(old + n);
+    if (n == 0) {
+        eof_ = true;
+        return false;
+    }
+    return true;
+}
+
+int SubtreeStream::peek() {
+    if (pos_ == buffer_.size() && !fill()) {
+        return -1;
+    }
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+void SubtreeStream::fail(JsonErrorCode code, const char* message) const {
+    throw JsonError(code, std::string(message) + " at byte " + std::to_string(offset()));
+}
+
+void SubtreeStream::expect(char c) {
+    skipWhitespace();
+    int next = peek();
+    if (next < 0) {
+        fail(JsonErrorCode::PrematureEndOfInput, "unexpected end of input");
+    }
+    if (next != static_cast<unsigned char>(c)) {
+        fail(JsonErrorCode::InvalidSyntax, "unexpected character");
+    }
+    ++pos_;
+}
+
+void SubtreeStream::skipWhitespace() {
+    while (true) {
+        int c = peek();
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return;
+        }
+        ++pos_;
+    }
+}
+
+/*=====================================================================
+ *  Skip mode
+ *====================================================================*/
+
+/*
+ * Move past one value, appending its text to @p out when capturing.
+ * Only brackets and string boundaries are tracked; the bytes in between
+ * are validated later by the parser, and only for captured values.
+ */
+void SubtreeStream::scanValue(std::string* out) {
+    skipWhitespace();
+    size_t depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    bool started = false;
+
+    while (true) {
+        if (pos_ == buffer_.size() && !fill()) {
+            if (started && depth == 0 && !inString) {
+                return; // scalar ending the input
+            }
+            fail(JsonErrorCode::PrematureEndOfInput, "unexpected end of input");
+        }
+
+        const char* begin = buffer_.data() + pos_;
+        const char* end = buffer_.data() + buffer_.size();
+        const char* p = begin;
+        bool done = false;
+        for (; p < end && !done; ++p) {
+            char c = *p;
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    inString = false;
+                    done = (depth == 0);
+                }
+                continue;
+            }
+            switch (c) {
+            case '"':
+                inString = true;
+                break;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    if (!started && p == begin) {
+                        fail(JsonErrorCode::InvalidSyntax, "unexpected character");
+                    }
+                    // A bare scalar ends at its container's closing bracket
+                    --p;
+                    done = true;
+                } else {
+                    done = (--depth == 0);
+                }
+                break;
+            case ',':
+            case ':':
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                if (depth == 0) {
+                    --p;
+                    done = true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (out) {
+            out->append(begin, static_cast<size_t>(p - begin));
+        }
+        pos_ += static_cast<size_t>(p - begin);
+        started = started || p != begin;
+        if (done) {
+            if (!started) {
+                fail(JsonErrorCode::InvalidSyntax, "expected a value");
+            }
+            return;
+        }
+    }
+}
+
+void SubtreeStream::readKey(std::string& key) {
+    skipWhitespace();
+    if (peek() != '"') {
+        fail(JsonErrorCode::InvalidSyntax, "expected an object key");
+    }
+    std::string raw;
+    scanValue(&raw);
+    try {
+        key = Parser::parseText(raw)->asString();
+    } catch (const std::exception&) {
+        fail(JsonErrorCode::InvalidSyntax, "malformed object key");
+    }
+}
+
+bool SubtreeStream::matches(const Frame& frame) const {
+    const JsonPointer::Token& token = pattern_[stack_.size() - 1];
+    if (token.key == "*") {
+        return true;
+    }
+    return frame.isArray ? token.index == frame.index : token.key == frame.key;
+}
+
+/*=====================================================================
+ *  Matching
+ *====================================================================*/
+
+bool SubtreeStream::next(ValuePtr& value) {
+    if (finished_) {
+        return false;
+    }
+
+    if (!started_) {
+        started_ = true;
+        skipWhitespace();
+        int c = peek();
+        if (c < 0) {
+            fail(JsonErrorCode::PrematureEndOfInput, "empty input");
+        }
+        if (pattern_.empty()) {
+            capture_.clear();
+            scanValue(&capture_);
+            finished_ = true;
+            value = Parser::parseText(capture_, options_);
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            ++pos_;
+            stack_.push_back(Frame{c == '[', true, 0, std::string()});
+        } else {
+            scanValue(nullptr);
+        }
+    }
+
+    while (!stack_.empty()) {
+        Frame& frame = stack_.back();
+        skipWhitespace();
+        int c = peek();
+        if (c < 0) {
+            fail(JsonErrorCode::PrematureEndOfInput, "unexpected end of input");
+        }
+        if (c == (frame.isArray ? ']' : '}')) {
+            ++pos_;
+            stack_.pop_back();
+            continue;
+        }
+
+        if (frame.first) {
+            frame.first = false;
+        } else {
+            expect(',');
+            ++frame.index;
+        }
+        if (!frame.isArray) {
+            readKey(frame.key);
+            expect(':');
+        }
+
+        if (!matches(frame)) {
+            scanValue(nullptr);
+            continue;
+        }
+        skipWhitespace();
+        if (stack_.size() == pattern_.size()) {
+            capture_.clear();
+            scanValue(&capture_);
+            value = Parser::parseText(capture_, options_);
+            return true;
+        }
+        c = peek();
+        if (c == '{' || c == '[') {
+            ++pos_;
+            stack_.push_back(Frame{c == '[', true, 0, std::string()});
+        } else {
+            scanValue(nullptr); // a scalar cannot contain deeper matches
+        }
+    }
+
+    skipWhitespace();
+    if (peek() >= 0) {
+        fail(JsonErrorCode::EndOfInputExpected, "trailing data after the document");
+    }
+    finished_ = true;
+    return false;
+}
+
+std::string SubtreeStream::path() const {
+    std::string text;
+    for (const Frame& frame : stack_) {
+        text.push_back('/');
+        if (frame.isArray) {
+            text += std::to_string(frame.index);
+            continue;
+        }
+        for (char c : frame.key) {
+            if (c == '~') {
+                text += "~0";
+            } else if (c == '/') {
+                text += "~1";
+            } else {
+                text.push_back(c);
+            }
+        }
+    }
+    return text;
+}
+
+} // namespace jsson
@@ -0,0 +1,509 @@
+#include "tape.hpp"
+#include "error.hpp"
+#include "parser.hpp"
+#include <charconv>
+#include <cstring>
+#include <string>
+
+namespace jsson {
+
+/*=====================================================================
+ *  TapeBuilder
+ *====================================================================*/
+
+/**
+ * @brief Single-pass recursive-descent parser writing straight to a tape.
+ *
+ * The document storage is sized up front from the input length: every
+ * value consumes at least as many input bytes as it needs tape words (plus
+ * the two root words), and an unescaped string never needs more than
+ * 2.5x its quoted length once the length prefix and NUL are included.
+ */
+class TapeBuilder {
+public:
+    static constexpr size_t kMaxDepth = 2048;
+
+    explicit TapeBuilder(std::string_view json)
+        : p_(json.data()), end_(json.data() + json.size()) {
+        size_t tapeWords = json.size() + 4;
+        size_t stringBytes = json.size() / 2 * 5 + 16;
+        size_t stringWords = (stringBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        doc_.storage_.reset(new uint64_t[tapeWords + stringWords]);
+        doc_.tape_ = doc_.storage_.get();
+        doc_.strings_ = reinterpret_cast<char*>(doc_.tape_ + tapeWords);
+        doc_.capacityBytes_ = (tapeWords + stringWords) * sizeof(uint64_t);
+    }
+
+    TapeDocument build() {
+        append(TapeTag::Root, 0);
+        skipWhitespace();
+        parseValue(0);
+        skipWhitespace();
+        if (p_ != end_) {
+            fail(JsonErrorCode::EndOfInputExpected, "Extra data after valid JSON value");
+        }
+        size_t rootEnd = tape_;
+        append(TapeTag::Root, 0);
+        doc_.tape_[0] = makeWord(TapeTag::Root, rootEnd);
+        doc_.tapeLength_ = tape_;
+        doc_.stringLength_ = strings_;
+        return std::move(doc_);
+    }
+
+private:
+    static uint64_t makeWord(TapeTag tag, uint64_t payload) noexcept {
+        return (static_cast<uint64_t>(static_cast<unsigned char>(tag)) << 56) |
+               (payload & TapeDocument::kPayloadMask);
+    }
+
+    void append(TapeTag tag, uint64_t payload) noexcept {
+        doc_.tape_[tape_++] = makeWord(tag, payload);
+    }
+
+    void appendRaw(uint64_t bits) noexcept {
+        doc_.tape_[tape_++] = bits;
+    }
+
+    [[noreturn]] void fail(JsonErrorCode code, const char* what) const {
+        throw JsonError(code, what);
+    }
+
+    void skipWhitespace() noexcept {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+            ++p_;
+        }
+    }
+
+    void expectLiteral(const char* word, size_t len) {
+        if (static_cast<size_t>(end_ - p_) < len || std::memcmp(p_, word, len) != 0) {
+            fail(JsonErrorCode::InvalidSyntax, "Invalid literal in JSON input");
+        }
+        p_ += len;
+    }
+
+    void parseValue(size_t depth) {
+        if (p_ == end_) {
+            fail(JsonErrorCode::PrematureEndOfInput, "Unexpected end of input");
+        }
+        switch (*p_) {
+            case '{': parseObject(depth + 1); break;
+            case '[': parseArray(depth + 1); break;
+            case '"': parseString(); break;
+            case 't': expectLiteral("true", 4); append(TapeTag::True, 0); break;
+            case 'f': expectLiteral("false", 5); append(TapeTag::False, 0); break;
+            case 'n': expectLiteral("null", 4); append(TapeTag::Null, 0); break;
+            default:
+                if (*p_ == '-' || (*p_ >= '0' && *p_ <= '9')) {
+                    parseNumber();
+                } else {
+                    fail(JsonErrorCode::InvalidSyntax, "Unexpected character");
+                }
+        }
+    }
+
+    /* Write the end word with the count, then point the start word past it */
+    void closeContainer(size_t start, TapeTag open, TapeTag close, size_t count) noexcept {
+        append(close, count);
+        doc_.tape_[start] = makeWord(open, tape_);
+    }
+
+    void parseObject(size_t depth) {
+        if (depth > kMaxDepth) {
+            fail(JsonErrorCode::StackOverflow, "Maximum nesting depth exceeded");
+        }
+        size_t start = tape_;
+        append(TapeTag::StartObject, 0);
+        ++p_; // Skip '{'
+        skipWhitespace();
+
+        size_t count = 0;
+        if (p_ != end_ && *p_ == '}') {
+            ++p_;
+            closeContainer(start, TapeTag::StartObject, TapeTag::EndObject, count);
+            return;
+        }
+        while (true) {
+            if (p_ == end_ || *p_ != '"') {
+                fail(JsonErrorCode::InvalidSyntax, "Expected string key");
+            }
+            parseString();
+            skipWhitespace();
+            if (p_ == end_ || *p_ != ':') {
+                fail(JsonErrorCode::InvalidSyntax, "Expected ':' after key");
+            }
+            ++p_;
+            skipWhitespace();
+            parseValue(depth);
+            ++count;
+            skipWhitespace();
+            if (p_ == end_) {
+                fail(JsonErrorCode::PrematureEndOfInput, "Unexpected end of object");
+            }
+            if (*p_ == '}') {
+                ++p_;
+                closeContainer(start, TapeTag::StartObject, TapeTag::EndObject, count);
+                return;
+            }
+            if (*p_ != ',') {
+                fail(JsonErrorCode::InvalidSyntax, "Expected ',' or '}'");
+            }
+            ++p_;
+            skipWhitespace();
+        }
+    }
+
+    void parseArray(size_t depth) {
+        if (depth > kMaxDepth) {
+            fail(JsonErrorCode::StackOverflow, "Maximum nesting depth exceeded");
+        }
+        size_t start = tape_;
+        append(TapeTag::StartArray, 0);
+        ++p_; // Skip '['
+        skipWhitespace();
+
+        size_t count = 0;
+        if (p_ != end_ && *p_ == ']') {
+            ++p_;
+            closeContainer(start, TapeTag::StartArray, TapeTag::EndArray, count);
+            return;
+        }
+        while (true) {
+            parseValue(depth);
+            ++count;
+            skipWhitespace();
+            if (p_ == end_) {
+                fail(JsonErrorCode::PrematureEndOfInput, "Unexpected end of array");
+            }
+            if (*p_ == ']') {
+                ++p_;
+                closeContainer(start, TapeTag::StartArray, TapeTag::EndArray, count);
+                return;
+            }
+            if (*p_ != ',') {
+                fail(JsonErrorCode::InvalidSyntax, "Expected ',' or ']'");
+            }
+            ++p_;
+            skipWhitespace();
+        }
+    }
+
+    unsigned readHex4() {
+        if (end_ - p_ < 4) {
+            fail(JsonErrorCode::InvalidSyntax, "Invalid Unicode escape");
+        }
+        unsigned value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char ch = *p_++;
+            value <<= 4;
+            if (ch >= '0' && ch <= '9') {
+                value |= static_cast<unsigned>(ch - '0');
+            } else if (ch >= 'a' && ch <= 'f') {
+                value |= static_cast<unsigned>(ch - 'a' + 10);
+            } else if (ch >= 'A' && ch <= 'F') {
+                value |= static_cast<unsigned>(ch - 'A' + 10);
+            } else {
+                fail(JsonErrorCode::InvalidSyntax, "Invalid Unicode escape");
+            }
+        }
+        return value;
+    }
+
+    static char* encodeUtf8(unsigned cp, char* out) noexcept {
+        if (cp <= 0x7F) {
+            *out++ = static_cast<char>(cp);
+        } else if (cp <= 0x7FF) {
+            *out++ = static_cast<char>(0xC0 | (cp >> 6));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp <= 0xFFFF) {
+            *out++ = static_cast<char>(0xE0 | (cp >> 12));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (cp >> 18));
+            *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        return out;
+    }
+
+    void parseString() {
+        ++p_; // Skip opening quote
+        char* lengthSlot = doc_.strings_ + strings_;
+        char* out = lengthSlot + sizeof(uint32_t);
+        char* const begin = out;
+
+        while (true) {
+            // Copy the unescaped run in one go
+            const char* run = p_;
+            while (p_ != end_ && *p_ != '"' && *p_ != '\\') {
+                if (static_cast<unsigned char>(*p_) < 0x20) {
+                    fail(JsonErrorCode::InvalidSyntax, "Control character in string");
+                }
+                ++p_;
+            }
+            std::memcpy(out, run, static_cast<size_t>(p_ - run));
+            out += p_ - run;
+
+            if (p_ == end_) {
+                fail(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+            }
+            if (*p_ == '"') {
+                ++p_;
+                break;
+            }
+
+            ++p_; // Skip backslash
+            if (p_ == end_) {
+                fail(JsonErrorCode::PrematureEndOfInput, "Unexpected end of string");
+            }
+            char esc = *p_++;
+            switch (esc) {
+                case '"': *out++ = '"'; break;
+                case '\\': *out++ = '\\'; break;
+                case '/': *out++ = '/'; break;
+                case 'b': *out++ = '\b'; break;
+                case 'f': *out++ = '\f'; break;
+                case 'n': *out++ = '\n'; break;
+                case 'r': *out++ = '\r'; break;
+                case 't': *out++ = '\t'; break;
+                case 'u': {
+                    unsigned cp = readHex4();
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                            fail(JsonErrorCode::InvalidUTF8, "Unpaired high surrogate");
+                        }
+                        p_ += 2;
+                        unsigned low = readHex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            fail(JsonErrorCode::InvalidUTF8, "Invalid low surrogate");
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        fail(JsonErrorCode::InvalidUTF8, "Unpaired low surrogate");
+                    }
+                    out = encodeUtf8(cp, out);
+                    break;
+                }
+                default:
+                    fail(JsonErrorCode::InvalidSyntax, "Invalid escape sequence");
+            }
+        }
+
+        if (static_cast<uint64_t>(out - begin) > UINT32_MAX) {
+            fail(JsonErrorCode::StringTooLong, "Tape string over 4 GiB");
+        }
+        uint32_t length = static_cast<uint32_t>(out - begin);
+        std::memcpy(lengthSlot, &length, sizeof(length));
+        *out++ = '\0';
+
+        append(TapeTag::String, strings_);
+        strings_ = static_cast<size_t>(out - doc_.strings_);
+    }
+
+    void parseNumber() {
+        const char* start = p_;
+        bool integral = true;
+
+        if (*p_ == '-') ++p_;
+        if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+            fail(JsonErrorCode::InvalidNumber, "Invalid number");
+        }
+        if (*p_ == '0') {
+            ++p_;
+        } else {
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+        if (p_ != end_ && *p_ == '.') {
+            integral = false;
+            ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+                fail(JsonErrorCode::InvalidNumber, "Invalid number");
+            }
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+        if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+            integral = false;
+            ++p_;
+            if (p_ != end_ && (*p_ == '+' || *p_ == '-')) ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+                fail(JsonErrorCode::InvalidNumber, "Invalid number");
+            }
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+
+        if (integral) {
+            int64_t value = 0;
+            auto result = std::from_chars(start, p_, value);
+            if (result.ec == std::errc() && result.ptr == p_) {
+                append(TapeTag::Int64, 0);
+                appendRaw(static_cast<uint64_t>(value));
+                return;
+            }
+            // Out of int64 range: fall back to double like the tree parser
+        }
+
+        double value = 0.0;
+        auto result = std::from_chars(start, p_, value);
+        if (result.ptr != p_ || (result.ec != std::errc() && result.ec != std::errc::result_out_of_range)) {
+            fail(JsonErrorCode::InvalidNumber, "Invalid number");
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        append(TapeTag::Double, 0);
+        appendRaw(bits);
+    }
+
+    const char* p_;
+    const char* end_;
+    size_t tape_ = 0;
+    size_t strings_ = 0;
+    TapeDocument doc_;
+};
+
+TapeDocument TapeDocument::parse(std::string_view json) {
+    return TapeBuilder(json).build();
+}
+
+TapeDocument Parser::parseTape(std::string_view json) {
+    return TapeDocument::parse(json);
+}
+
+/*=====================================================================
+ *  TapeRef
+ *====================================================================*/
+
+bool TapeRef::asBoolean() const {
+    switch (tag()) {
+        case TapeTag::True: return true;
+        case TapeTag::False: return false;
+        default: throw JsonError(JsonErrorCode::WrongType, "Tape value is not a boolean");
+    }
+}
+
+double TapeRef::asNumber() const {
+    switch (tag()) {
+        case TapeTag::Int64:
+            return static_cast<double>(static_cast<int64_t>(doc_->word(index_ + 1)));
+        case TapeTag::Double: {
+            uint64_t bits = doc_->word(index_ + 1);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        default:
+            throw JsonError(JsonErrorCode::WrongType, "Tape value is not a number");
+    }
+}
+
+int64_t TapeRef::asInt64() const {
+    if (tag() != TapeTag::Int64) {
+        throw JsonError(JsonErrorCode::WrongType, "Tape value is not an integer");
+    }
+    return static_cast<int64_t>(doc_->word(index_ + 1));
+}
+
+std::string_view TapeRef::asString() const {
+    if (tag() != TapeTag::String) {
+        throw JsonError(JsonErrorCode::WrongType, "Tape value is not a string");
+    }
+    const char* entry = doc_->strings() + (word() & TapeDocument::kPayloadMask);
+    uint32_t length;
+    std::memcpy(&length, entry, sizeof(length));
+    return std::string_view(entry + sizeof(length), length);
+}
+
+TapeObject TapeRef::asObject() const {
+    if (tag() != TapeTag::StartObject) {
+        throw JsonError(JsonErrorCode::WrongType, "Tape value is not an object");
+    }
+    return TapeObject(*this);
+}
+
+TapeArray TapeRef::asArray() const {
+    if (tag() != TapeTag::StartArray) {
+        throw JsonError(JsonErrorCode::WrongType, "Tape value is not an array");
+    }
+    return TapeArray(*this);
+}
+
+/*=====================================================================
+ *  Container cursors
+ *====================================================================*/
+
+/* Index of the end word of the container starting at @p start */
+static size_t containerEnd(const TapeRef& start) noexcept {
+    uint64_t word = start.document()->word(start.index());
+    return static_cast<size_t>(word & TapeDocument::kPayloadMask) - 1;
+}
+
+/* Element count stored in the end word of the container starting at @p start */
+static size_t storedCount(const TapeRef& start) noexcept {
+    uint64_t word = start.document()->word(containerEnd(start));
+    return static_cast<size_t>(word & TapeDocument::kPayloadMask);
+}
+
+size_t TapeArray::size() const noexcept {
+    return storedCount(start_);
+}
+
+TapeRef TapeArray::at(size_t index) const {
+    auto it = begin();
+    for (size_t i = 0; i < index && it != end(); ++i) ++it;
+    if (it == end()) {
+        throw JsonError(JsonErrorCode::IndexOutOfRange, "Tape array index out of range");
+    }
+    return *it;
+}
+
+TapeArray::iterator TapeArray::begin() const noexcept {
+    return iterator(TapeRef(start_.document(), start_.index() + 1));
+}
+
+TapeArray::iterator TapeArray::end() const noexcept {
+    return iterator(TapeRef(start_.document(), containerEnd(start_)));
+}
+
+TapeObject::Member TapeObject::iterator::operator*() const {
+    return Member{key_.asString(), key_.nextSibling()};
+}
+
+size_t TapeObject::size() const noexcept {
+    return storedCount(start_);
+}
+
+std::optional<TapeRef> TapeObject::find_field(std::string_view key) const noexcept {
+    const TapeDocument* doc = start_.document();
+    size_t last = containerEnd(start_);
+    size_t i = start_.index() + 1;
+    while (i < last) {
+        TapeRef value(doc, i + 1);
+        const char* entry = doc->strings() + (doc->word(i) & TapeDocument::kPayloadMask);
+        uint32_t length;
+        std::memcpy(&length, entry, sizeof(length));
+        if (length == key.size() && std::memcmp(entry + sizeof(length), key.data(), length) == 0) {
+            return value;
+        }
+        i = value.nextSibling().index();
+    }
+    return std::nullopt;
+}
+
+TapeRef TapeObject::at(std::string_view key) const {
+    auto found = find_field(key);
+    if (!found) {
+        throw JsonError(JsonErrorCode::ItemNotFound, "Key not found: " + std::string(key));
+    }
+    return *found;
+}
+
+TapeObject::iterator TapeObject::begin() const noexcept {
+    return iterator(TapeRef(start_.document(), start_.index() + 1));
+}
+
+TapeObject::iterator TapeObject::end() const noexcept {
+    return iterator(TapeRef(start_.document(), containerEnd(start_)));
+}
+
+} // namespace jsson
@@ -1,12 +1,19 @@
 #include "../include/utf8.hpp"
+#include "../include/simd.hpp"
 #include <stdexcept>
 
 namespace Utf8 {
 
 bool isValid(const std::string& str)
 {
+    const auto asciiPrefix = jsson::simd::kernels().asciiPrefix;
     size_t i = 0;
     while (i < str.size()) {
+        // ASCII runs need no decoding
+        i += asciiPrefix(str.data() + i, str.size() - i);
+        if (i == str.size()) {
+            break;
+        }
         unsigned char c = static_cast<unsigned char>(str[i]);
         size_t len = 0;
 
@@ -0,0 +1,238 @@
+#include "json_value.hpp"
+#include "base64.hpp"
+#include "dump.hpp"
+#include "error.hpp"
+#include <sstream>
+#include <type_traits>
+
+namespace jsson {
+
+/*=====================================================================
+ *  Copying
+ *====================================================================*/
+
+/* Copy the alternative held by @p data; containers are cloned one level deep */
+static JsonValue::Data copyData(const JsonValue::Data& data) {
+    return std::visit([](const auto& value) -> JsonValue::Data {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, std::unique_ptr<JsonObject>>) {
+            return std::make_unique<JsonObject>(*value);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<JsonArray>>) {
+            return std::make_unique<JsonArray>(*value);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<OrderedObject>>) {
+            return std::make_unique<OrderedObject>(*value);
+        } else {
+            return value;
+        }
+    }, data);
+}
+
+JsonValue::JsonValue(const JsonValue& other)
+    : type_(other.type_), data_(copyData(other.data_)) {}
+
+JsonValue& JsonValue::operator=(const JsonValue& other) {
+    if (this != &other) {
+        data_ = copyData(other.data_);
+        type_ = other.type_;
+    }
+    return *this;
+}
+
+JsonValue::JsonValue(const OrderedObject& object)
+    : type_(Type::Object), data_(std::make_unique<OrderedObject>(object)) {}
+
+JsonValue::JsonValue(OrderedObject&& object)
+    : type_(Type::Object), data_(std::make_unique<OrderedObject>(std::move(object))) {}
+
+/*=====================================================================
+ *  Scalar accessors
+ *====================================================================*/
+
+OrderedObject& JsonValue::asOrderedObject() {
+    if (auto object = std::get_if<std::unique_ptr<OrderedObject>>(&data_)) {
+        return **object;
+    }
+    throw JsonError(JsonErrorCode::WrongType, "JSON value is not an ordered object");
+}
+
+const OrderedObject& JsonValue::asOrderedObject() const {
+    return const_cast<JsonValue*>(this)->asOrderedObject();
+}
+
+bool JsonValue::asBoolean() const {
+    if (auto b = std::get_if<bool>(&data_)) {
+        return *b;
+    }
+    throw JsonError(JsonErrorCode::WrongType, "JSON value is not a boolean");
+}
+
+double JsonValue::asNumber() const {
+    if (auto d = std::get_if<double>(&data_)) {
+        return *d;
+    }
+    if (auto i = std::get_if<int64_t>(&data_)) {
+        return static_cast<double>(*i);
+    }
+    throw JsonError(JsonErrorCode::WrongType, "JSON value is not a number");
+}
+
+const std::string& JsonValue::asString() const {
+    if (auto s = std::get_if<std::string>(&data_)) {
+        return *s;
+    }
+    if (auto interned = std::get_if<InternedString>(&data_)) {
+        return interned->str();
+    }
+    if (auto raw = std::get_if<RawString>(&data_)) {
+        return raw->str();
+    }
+    throw JsonError(JsonErrorCode::WrongType, "JSON value is not a string");
+}
+
+std::string& JsonValue::asString() {
+    if (auto interned = std::get_if<InternedString>(&data_)) {
+        // Detach from the dictionary before handing out a mutable reference
+        std::string copy = interned->str();
+        data_ = std::move(copy);
+    } else if (auto raw = std::get_if<RawString>(&data_)) {
+        // Likewise stop referencing the shared input buffer
+        std::string copy = raw->str();
+        data_ = std::move(copy);
+    }
+    if (auto s = std::get_if<std::string>(&data_)) {
+        return *s;
+    }
+    throw JsonError(JsonErrorCode::WrongType, "JSON value is not a string");
+}
+
+std::string_view JsonValue::asStringView() const {
+    if (auto raw = std::get_if<RawString>(&data_)) {
+        return raw->view();
+    }
+    return asString();
+}
+
+bool JsonValue::stringEquals(const JsonValue& other) const {
+    if (type_ != Type::String || other.type_ != Type::String) {
+        return false;
+    }
+    auto lhs = std::get_if<InternedString>(&data_);
+    auto rhs = std::get_if<InternedString>(&other.data_);
+    if (lhs && rhs && lhs->entry == rhs->entry) {
+        return true;
+    }
+    auto rawLhs = std::get_if<RawString>(&data_);
+    auto rawRhs = std::get_if<RawString>(&other.data_);
+    if (rawLhs && rawRhs && rawLhs->hasEscapes() == rawRhs->hasEscapes()) {
+        // Identical escaped forms decode identically; escape-free spans are the values
+        if (rawLhs->span() == rawRhs->span()) {
+            return true;
+        }
+        if (!rawLhs->hasEscapes()) {
+            return false;
+        }
+    }
+    return other.stringEquals(asStringView());
+}
+
+bool JsonValue::stringEquals(std::string_view text) const {
+    if (type_ != Type::String) {
+        return false;
+    }
+    if (auto raw = std::get_if<RawString>(&data_)) {
+        if (!raw->hasEscapes()) {
+            return raw->span() == text;
+        }
+        // Unescaping only ever shrinks the text
+        if (text.size() > raw->span().size()) {
+            return false;
+        }
+    }
+    return asStringView() == text;
+}
+
+size_t JsonValue::decodeBase64InPlace() {
+    std::string& s = asString();
+    size_t written = 0;
+    size_t consumed = 0;
+    if (!Base64::tryDecode(s.data(), s.size(), &s[0], written, consumed)) {
+        // Re-encode the prefix already overwritten so the value is unchanged
+        std::string prefix = Base64::encode(std::string_view(s.data(), written));
+        s.replace(0, prefix.size(), prefix);
+        throw JsonError(JsonErrorCode::InvalidFormat, "base64: invalid character or padding");
+    }
+    s.resize(written);
+    return written;
+}
+
+std::string JsonValue::toString() const {
+    std::ostringstream out;
+    JsonDumper().dump(*this, out);
+    return out.str();
+}
+
+/*=====================================================================
+ *  Assignment Operators
+ *====================================================================*/
+
+JsonValue& JsonValue::operator=(bool value) {
+    type_ = Type::Boolean;
+    data_ = value;
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(double value) {
+    type_ = Type::Number;
+    data_ = value;
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(int64_t value) {
+    type_ = Type::Number;
+    data_ = value;
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(const std::string& value) {
+    type_ = Type::String;
+    data_ = value;
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(std::string&& value) {
+    type_ = Type::String;
+    data_ = std::move(value);
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(InternedString value) {
+    type_ = Type::String;
+    data_ = std::move(value);
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(const JsonObject& object) {
+    type_ = Type::Object;
+    data_ = std::make_unique<JsonObject>(object);
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(JsonObject&& object) {
+    type_ = Type::Object;
+    data_ = std::make_unique<JsonObject>(std::move(object));
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(const JsonArray& array) {
+    type_ = Type::Array;
+    data_ = std::make_unique<JsonArray>(array);
+    return *this;
+}
+
+JsonValue& JsonValue::operator=(JsonArray&& array) {
+    type_ = Type::Array;
+    data_ = std::make_unique<JsonArray>(std::move(array));
+    return *this;
+}
+
+} // namespace jsson
@@ -0,0 +1,78 @@
+#include "base64.hpp"
+#include "dump.hpp"
+#include "json_value.hpp"
+#include "util.hpp"
+#include <sstream>
+#include <string>
+
+using namespace jsson;
+
+static std::string bytes(size_t size) {
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 131 + 7);
+    }
+    return data;
+}
+
+static void test_known_vectors() {
+    // RFC 4648 section 10
+    const char* vectors[][2] = {{"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+                                {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}};
+    for (const auto& vector : vectors) {
+        check(Base64::encode(vector[0]) == vector[1]);
+        check(Base64::decode(vector[1]) == vector[0]);
+    }
+}
+
+static void test_round_trip() {
+    // Sizes around the 12/16-byte vector groups and their remainders
+    for (size_t size = 0; size < 200; ++size) {
+        std::string data = bytes(size);
+        std::string text = Base64::encode(data);
+        check(text.size() == Base64::encodedLength(size));
+        check(Base64::decode(text) == data);
+
+        // In place: output never overtakes the input
+        std::string buffer = text;
+        size_t n = Base64::decode(buffer.data(), buffer.size(), buffer.data());
+        check(n <= Base64::maxDecodedLength(text.size()) && buffer.substr(0, n) == data);
+    }
+}
+
+static void test_invalid() {
+    check_throws(JsonErrorCode::InvalidFormat, Base64::decode("Zm9"));
+    check_throws(JsonErrorCode::InvalidFormat, Base64::decode("Zm=v"));
+    check_throws(JsonErrorCode::InvalidFormat, Base64::decode(std::string(40, 'A') + "*AAA"));
+
+    std::string text = Base64::encode(bytes(60));
+    text[50] = '!';
+    std::string out(Base64::maxDecodedLength(text.size()), '\0');
+    size_t written = 0, consumed = 0;
+    check(!Base64::tryDecode(text.data(), text.size(), out.data(), written, consumed));
+    check(consumed <= 50 && written == consumed / 4 * 3);
+    check(out.substr(0, written) == bytes(60).substr(0, written));
+}
+
+static void test_json_value() {
+    std::string data = bytes(1000);
+    JsonValue value(Base64::encode(data));
+    check(value.decodeBase64InPlace() == data.size());
+    check(value.asString() == data);
+
+    JsonValue bad(std::string("not base64!"));
+    check_throws(JsonErrorCode::InvalidFormat, bad.decodeBase64InPlace());
+    check(bad.asString() == "not base64!");
+    check_throws(JsonErrorCode::WrongType, JsonValue(int64_t(1)).decodeBase64InPlace());
+
+    std::ostringstream out;
+    JsonDumper().dumpBase64("foobar", 6, out);
+    check(out.str() == "\"Zm9vYmFy\"");
+}
+
+static void run_tests() {
+    test_known_vectors();
+    test_round_trip();
+    test_invalid();
+    test_json_value();
+}
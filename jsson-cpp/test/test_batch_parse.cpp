@@ -0,0 +1,122 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace jsson;
+
+static std::vector<std::string> messages() {
+    std::vector<std::string> texts;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 97 == 13) {
+            texts.push_back("{\"id\": " + std::to_string(i) + ", broken");
+        } else {
+            texts.push_back("{\"id\": " + std::to_string(i) + ", \"kind\": \"event\", \"tag\": \"t\\u0041" +
+                            std::to_string(i % 5) + "\", \"values\": [" + std::to_string(i) + ", 1.5]}");
+        }
+    }
+    return texts;
+}
+
+static void checkBatch(const std::vector<std::string>& texts, const ParsedBatch& batch,
+                       const ParseOptions& options = ParseOptions()) {
+    check(batch.roots.size() == texts.size());
+    size_t failed = 0;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (i % 97 == 13) {
+            check(!batch.roots[i]);
+            check(failed < batch.errors.size() && batch.errors[failed].first == i);
+            check(batch.errors[failed].second.code().value() ==
+                  static_cast<int>(JsonErrorCode::InvalidSyntax));
+            ++failed;
+        } else {
+            check(batch.roots[i] && canonical(*batch.roots[i]) == canonical(*Parser::parseText(texts[i], options)));
+        }
+    }
+    check(failed == batch.errors.size());
+}
+
+static void test_threads_and_options() {
+    std::vector<std::string> texts = messages();
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+
+    for (size_t threads : {size_t(1), size_t(3), size_t(0)}) {
+        checkBatch(texts, Parser::parseBatch(views, ParseOptions(), threads));
+    }
+
+    ParseOptions lazy;
+    lazy.lazyStrings = true;
+    std::vector<std::string> scratch = messages();
+    std::vector<std::string_view> scratchViews(scratch.begin(), scratch.end());
+    ParsedBatch batch = Parser::parseBatch(scratchViews.data(), scratchViews.size(), lazy, 4);
+    for (std::string& text : scratch) {
+        text.assign(text.size(), 'X'); // the batch keeps its own copy
+    }
+    checkBatch(texts, batch, lazy);
+    check(JsonPointer("/tag").resolve(*batch.roots[2])->asStringView() == "tA2");
+
+    ParseOptions interned;
+    interned.interning = StringInterning::On;
+    checkBatch(texts, Parser::parseBatch(views, interned, 2), interned);
+}
+
+static void test_roots_outlive_batch() {
+    std::vector<std::string> texts = messages();
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+    ValuePtr kept;
+    {
+        ParsedBatch batch = Parser::parseBatch(views, ParseOptions(), 2);
+        kept = batch.roots[500];
+    }
+    check(JsonPointer("/values/0").resolve(*kept)->asNumber() == 500);
+}
+
+static void test_limits_per_message() {
+    std::vector<std::string_view> views = {"[1]", "[1, 2, 3, 4, 5, 6, 7, 8]", "[[[[[1]]]]]", "{}"};
+    ParseOptions options;
+    options.limits.maxNodes = 4;
+    ParsedBatch batch = Parser::parseBatch(views, options);
+    check(batch.roots[0] && !batch.roots[1] && batch.roots[3]);
+    check(batch.errors.size() == 2 && batch.errors[0].first == 1 && batch.errors[1].first == 2);
+    check(batch.errors[0].second.code().value() == static_cast<int>(JsonErrorCode::TooManyNodes));
+
+    check(Parser::parseBatch(nullptr, 0).roots.empty());
+}
+
+static bool interned(const JsonValue& value) {
+    return std::holds_alternative<InternedString>(value.raw_variant());
+}
+
+static void test_state_per_worker() {
+    // Auto interning samples across messages, not afresh in each one
+    std::vector<std::string> texts;
+    for (int i = 0; i < 100; ++i) {
+        texts.push_back("[\"unique " + std::to_string(i) + "\"]");
+    }
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+    ParseOptions options;
+    options.interning = StringInterning::Auto;
+    options.internSampleSize = 10;
+    ParsedBatch batch = Parser::parseBatch(views, options);
+    check(interned(*JsonPointer("/0").resolve(*batch.roots[0])));
+    check(!interned(*JsonPointer("/0").resolve(*batch.roots[99])));
+
+    // Workers beyond the calling thread learn in their own predictors
+    std::vector<std::string> records = messages();
+    std::vector<std::string_view> recordViews(records.begin(), records.end());
+    ParseOptions predicted;
+    predicted.keyPredictor = std::make_shared<KeyOrderPredictor>();
+    checkBatch(records, Parser::parseBatch(recordViews, predicted, 4));
+    // Only the calling thread's quarter of the records, four keys each, counts
+    size_t hits = predicted.keyPredictor->hits();
+    check(hits > 0 && hits <= 4 * (records.size() / 4));
+}
+
+static void run_tests() {
+    test_threads_and_options();
+    test_roots_outlive_batch();
+    test_limits_per_message();
+    test_state_per_worker();
+}
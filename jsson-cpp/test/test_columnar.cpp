@@ -0,0 +1,147 @@
+#include "columnar.hpp"
+#include "compression.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(std::string& out) : out_(out) {}
+    void write(const char* data, size_t size) override { out_.append(data, size); }
+
+private:
+    std::string& out_;
+};
+
+static std::vector<std::string> records() {
+    std::vector<std::string> lines;
+    for (int i = 0; i < 1000; ++i) {
+        std::string s = "{\"id\": " + std::to_string(i * 7 - 300) + ", \"d\": " + std::to_string(i) + ".5";
+        s += ", \"exact\": " + std::to_string((int64_t(1) << 40) + i);
+        s += ", \"b\": " + std::string(i % 3 ? "true" : "false");
+        s += ", \"cat\": \"c" + std::to_string(i % 4) + "\", \"u\": \"u\\n" + std::to_string(i) + "\"";
+        if (i % 5) {
+            s += ", \"opt\": null";
+        }
+        if (i % 7 == 0) {
+            s += ", \"user\": {\"name\": \"n\", \"a/b~\": [1, 2]}";
+        }
+        s += ", \"mix\": " + std::string(i % 2 ? "1" : "\"x\"") + ", \"e\": {}}";
+        lines.push_back(s);
+    }
+    lines.push_back("42");
+    lines.push_back("[1, {\"a\": 2}]");
+    return lines;
+}
+
+static std::string encode(const std::vector<std::string>& lines, size_t batchSize) {
+    std::string data;
+    ColumnarWriter writer(std::make_unique<StringSink>(data), batchSize);
+    for (const std::string& line : lines) {
+        writer.write(Parser::parseText(line));
+    }
+    writer.close();
+    check(writer.count() == lines.size());
+    return data;
+}
+
+static void test_round_trip() {
+    std::vector<std::string> lines = records();
+    std::string data = encode(lines, 300);
+    ColumnarReader reader(std::make_unique<MemorySource>(data.data(), data.size()));
+    ValuePtr record;
+    size_t i = 0;
+    while (reader.next(record)) {
+        check(i < lines.size());
+        // canonical() tells integers from reals, so types survive too
+        check(canonical(*record) == canonical(*Parser::parseText(lines[i])));
+        ++i;
+    }
+    check(i == lines.size());
+}
+
+static void test_columns_and_selection() {
+    std::vector<std::string> lines = records();
+    std::string data = encode(lines, 300);
+    ColumnarReader reader(std::make_unique<MemorySource>(data.data(), data.size()));
+    reader.select({"/user", "/cat"});
+    std::vector<ValuePtr> batch;
+    check(reader.nextBatch(batch) && batch.size() == 300);
+
+    std::map<std::string, ColumnInfo> columns;
+    for (const ColumnInfo& column : reader.columns()) {
+        columns.emplace(column.path, column);
+    }
+    check(columns.at("/id").type == ColumnType::Int64);
+    check(columns.at("/id").encoding == ColumnEncoding::Delta);
+    check(columns.at("/d").type == ColumnType::Double);
+    check(columns.at("/b").type == ColumnType::Boolean);
+    check(columns.at("/cat").type == ColumnType::String);
+    check(columns.at("/cat").encoding == ColumnEncoding::Dictionary);
+    check(columns.at("/opt").type == ColumnType::Null);
+    check(columns.at("/mix").type == ColumnType::Json);
+    check(columns.at("/user/a~1b~0").type == ColumnType::Json);
+    // Four distinct strings pack far below one byte per row
+    check(columns.at("/cat").bytes < columns.at("/u").bytes / 4);
+
+    // Only the selected leaves come back
+    check(canonical(*batch[0]) == "{\"cat\":\"c0\",\"user\":{\"a/b~\":[1,2],\"name\":\"n\"}}");
+    check(canonical(*batch[1]) == "{\"cat\":\"c1\"}");
+
+    size_t total = batch.size();
+    while (reader.nextBatch(batch)) {
+        total += batch.size();
+    }
+    check(total == lines.size());
+}
+
+static void test_files_and_errors() {
+    std::vector<std::string> lines = records();
+    Compression format = compressionSupported(Compression::Gzip) ? Compression::Gzip : Compression::None;
+    {
+        std::unique_ptr<ColumnarWriter> writer = ColumnarWriter::open("columnar.jscb", format, 128);
+        for (const std::string& line : lines) {
+            writer->write(Parser::parseText(line));
+        }
+        writer->close();
+    }
+    ColumnarReader reader = ColumnarReader::open("columnar.jscb");
+    ValuePtr record;
+    size_t count = 0;
+    while (reader.next(record)) {
+        ++count;
+    }
+    check(count == lines.size());
+    std::remove("columnar.jscb");
+
+    // The header is checked on construction, the batches as they are read
+    auto readAll = [](const std::string& bytes) {
+        ColumnarReader broken(std::make_unique<MemorySource>(bytes.data(), bytes.size()));
+        ValuePtr value;
+        while (broken.next(value)) {
+        }
+    };
+    std::string data = encode(lines, 300);
+    for (size_t cut : {size_t(3), data.size() / 2, data.size() - 1}) {
+        check_throws(JsonErrorCode::InvalidFormat, readAll(data.substr(0, cut)));
+    }
+    check_throws(JsonErrorCode::InvalidFormat, readAll("JSON, not columnar"));
+
+    // A null-typed column whose bitmap claims a non-null row has no value for it
+    std::string nulls = encode({"{\"n\": null}"}, 1);
+    check(nulls.back() == 0); // The null bitmap, all set
+    nulls.back() = 1;         // None set
+    check_throws(JsonErrorCode::InvalidFormat, readAll(nulls));
+}
+
+static void run_tests() {
+    test_round_trip();
+    test_columns_and_selection();
+    test_files_and_errors();
+}
@@ -0,0 +1,65 @@
+#include "compact.hpp"
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+/* A tree whose nodes are interleaved with garbage allocations */
+static ValuePtr scatteredTree(std::vector<ValuePtr>& garbage) {
+    JsonArray records;
+    for (int i = 0; i < 2000; ++i) {
+        JsonObject record;
+        record.keys()["id"] = makeRef<JsonValue>(static_cast<int64_t>(i));
+        garbage.push_back(makeRef<JsonValue>(std::string(200, 'g')));
+        record.keys()["name"] = makeRef<JsonValue>("name " + std::to_string(i));
+        garbage.push_back(makeRef<JsonValue>(std::string(300, 'g')));
+        JsonArray tags;
+        tags.data().push_back(makeRef<JsonValue>(i % 2 == 0));
+        tags.data().push_back(makeRef<JsonValue>(std::string(40, 't')));
+        record.keys()["tags"] = makeRef<JsonValue>(std::move(tags));
+        records.data().push_back(makeRef<JsonValue>(std::move(record)));
+    }
+    return makeRef<JsonValue>(std::move(records));
+}
+
+static void test_compact() {
+    std::vector<ValuePtr> garbage;
+    ValuePtr root = scatteredTree(garbage);
+    garbage.clear();
+    const std::string before = canonical(*root);
+
+    // Held from outside: must stay the very same node
+    ValuePtr outside = Parser::parseText("{\"shared\": true}");
+    std::get<std::unique_ptr<JsonArray>>(root->raw_variant())->data().push_back(outside);
+    const std::string withShared = canonical(*root);
+    check(withShared != before);
+
+    CompactionReport report = compact(*root);
+    check(canonical(*root) == withShared);
+    check(report.before.nodes == report.after.nodes);
+    check(report.after.nodes == analyzeLayout(*root).nodes);
+    check(report.after.fragmentation() < report.before.fragmentation());
+    check(report.after.pages <= report.before.pages);
+    check(report.arenaBytes > 0 && report.arenaBlocks > 0);
+    check(JsonPointer("/2000").resolve(*root) == outside.get());
+
+    // The compacted tree is still an ordinary mutable tree
+    JsonValue* name = const_cast<JsonValue*>(JsonPointer("/5/name").resolve(*root));
+    name->asString() += " changed";
+    check(JsonPointer("/5/name").resolve(*root)->asString() == "name 5 changed");
+}
+
+static void test_layout_stats() {
+    ValuePtr single = makeRef<JsonValue>(int64_t(1));
+    LayoutStats stats = analyzeLayout(*single);
+    check(stats.nodes == 1 && stats.pages == 1 && stats.pageSwitches == 0);
+    check(stats.fragmentation() == 0.0);
+}
+
+static void run_tests() {
+    test_compact();
+    test_layout_stats();
+}
@@ -0,0 +1,164 @@
+#include "compression.hpp"
+#include "io.hpp"
+#include "ndjson.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace jsson;
+
+static uint32_t crc32(const std::string& data) {
+    uint32_t crc = 0xffffffff;
+    for (unsigned char c : data) {
+        crc ^= c;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void putLE(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+/* One gzip member holding @p data in stored (uncompressed) deflate blocks */
+static void gzipMember(std::string& out, const std::string& data) {
+    out += std::string("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+    size_t pos = 0;
+    do {
+        size_t n = std::min<size_t>(data.size() - pos, 65535);
+        out += static_cast<char>(pos + n == data.size() ? 1 : 0); // BFINAL, BTYPE 00
+        putLE(out, n, 2);
+        putLE(out, ~n & 0xffff, 2);
+        out.append(data, pos, n);
+        pos += n;
+    } while (pos < data.size());
+    putLE(out, crc32(data), 4);
+    putLE(out, data.size() & 0xffffffff, 4);
+}
+
+/* One zstd frame holding @p data in raw blocks */
+static void zstdFrame(std::string& out, const std::string& data) {
+    out += std::string("\x28\xb5\x2f\xfd", 4);
+    out += static_cast<char>(0xa0); // single segment, 4-byte content size
+    putLE(out, data.size(), 4);
+    size_t pos = 0;
+    do {
+        size_t n = std::min<size_t>(data.size() - pos, 128 * 1024);
+        putLE(out, (n << 3) | (pos + n == data.size() ? 1 : 0), 3); // Raw_Block
+        out.append(data, pos, n);
+        pos += n;
+    } while (pos < data.size());
+}
+
+/*
+ * @p text cut into blocks of @p blockSize, one gzip member or zstd frame
+ * each.  Stored blocks keep the test independent of any compressor while
+ * exercising the multi-member framing the reader has to follow.
+ */
+static std::string compress(const std::string& text, Compression format, size_t blockSize) {
+    std::string compressed;
+    for (size_t pos = 0; pos < text.size(); pos += blockSize) {
+        std::string block = text.substr(pos, blockSize);
+        if (format == Compression::Gzip) {
+            gzipMember(compressed, block);
+        } else {
+            zstdFrame(compressed, block);
+        }
+    }
+    return compressed;
+}
+
+static std::string readAll(InputSource& source, size_t chunk) {
+    std::string result;
+    std::string buffer(chunk, '\0');
+    while (size_t n = source.read(&buffer[0], buffer.size())) {
+        result.append(buffer.data(), n);
+    }
+    return result;
+}
+
+static std::string sampleText() {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"record " + std::to_string(i * 7) + "\"}\n";
+    }
+    return text;
+}
+
+static void test_round_trip(Compression format) {
+    const std::string text = sampleText();
+    // Odd compressed block and ring sizes put block edges mid-record
+    const std::string compressed = compress(text, format, 10007);
+    check(detectCompression(reinterpret_cast<const unsigned char*>(compressed.data()),
+                            compressed.size()) == format);
+    for (size_t ringBlock : {size_t(333), size_t(4096), DecompressingSource::kDefaultBlockSize}) {
+        DecompressingSource source(std::make_unique<MemorySource>(compressed.data(), compressed.size()),
+                                   format, ringBlock, 3);
+        check(readAll(source, 1000) == text);
+    }
+}
+
+static void test_open_input(Compression format) {
+    const std::string path = std::string("compressed_input.") + compressionName(format);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << compress("{\"a\": [1, 2, 3], \"b\": \"x\"}", format, 7);
+    }
+    ValuePtr value = Parser::parse(path);
+    check(at(*value, "/a")->toString() == "[1, 2, 3]");
+    check(at(*value, "/b")->asString() == "x");
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << compress(sampleText(), format, 65536);
+    }
+    NdjsonReader reader = NdjsonReader::open(path);
+    size_t count = 0;
+    for (ValuePtr record; reader.next(record); ++count) {
+        check(at(*record, "/id")->asNumber() == static_cast<double>(count));
+    }
+    check(count == 20000);
+    std::remove(path.c_str());
+}
+
+static void test_truncated(Compression format) {
+    std::string compressed = compress(sampleText(), format, 1 << 20);
+    compressed.resize(compressed.size() / 2);
+    check_throws(JsonErrorCode::PrematureEndOfInput, {
+        DecompressingSource source(std::make_unique<MemorySource>(compressed.data(), compressed.size()),
+                                   format);
+        readAll(source, 4096);
+    });
+}
+
+static void test_plain_passthrough() {
+    const std::string path = "compressed_input.json";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "[true, null]";
+    }
+    check(Parser::parse(path)->toString() == "[true, null]");
+    std::remove(path.c_str());
+}
+
+static void run_tests() {
+    for (Compression format : {Compression::Gzip, Compression::Zstd}) {
+        if (!compressionSupported(format)) {
+            check_throws(JsonErrorCode::InvalidFormat,
+                         DecompressingSource(std::make_unique<MemorySource>("", 0), format));
+            continue;
+        }
+        test_round_trip(format);
+        test_open_input(format);
+        test_truncated(format);
+    }
+    test_plain_passthrough();
+}
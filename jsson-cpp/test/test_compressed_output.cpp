@@ -0,0 +1,127 @@
+#include "compression.hpp"
+#include "dump.hpp"
+#include "io.hpp"
+#include "ndjson.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+
+using namespace jsson;
+
+/* Collects the bytes written to it */
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(std::string& out) : out_(out) {}
+    void write(const char* data, size_t size) override { out_.append(data, size); }
+
+private:
+    std::string& out_;
+};
+
+static std::string decompress(const std::string& compressed, Compression format) {
+    DecompressingSource source(std::make_unique<MemorySource>(compressed.data(), compressed.size()),
+                               format);
+    std::string result;
+    char buffer[4096];
+    while (size_t n = source.read(buffer, sizeof(buffer))) {
+        result.append(buffer, n);
+    }
+    return result;
+}
+
+static void test_block_boundaries(Compression format) {
+    std::string expected;
+    for (int i = 0; i < 5000; ++i) {
+        expected += "line " + std::to_string(i) + " " + std::string(i % 97, 'x') + "\n";
+    }
+    // Writes of every size, straddling the 1000-byte compression blocks
+    std::string compressed;
+    {
+        CompressingSink sink(std::make_unique<StringSink>(compressed), format, 3, 0, 1000);
+        size_t pos = 0;
+        for (size_t size = 1; pos < expected.size(); size = size * 3 % 2999 + 1) {
+            size = std::min(size, expected.size() - pos);
+            sink.write(expected.data() + pos, size);
+            pos += size;
+            if (pos % 7 == 0) {
+                sink.flush();
+            }
+        }
+        sink.close();
+    }
+    check(compressed.size() < expected.size());
+    check(decompress(compressed, format) == expected);
+}
+
+static void test_ndjson_round_trip(Compression format) {
+    const std::string path = std::string("compressed_output.ndjson.") + compressionName(format);
+    {
+        auto writer = NdjsonWriter::open(path, format, 2);
+        for (int i = 0; i < 3000; ++i) {
+            writer->write(Parser::parseText("{\"i\": " + std::to_string(i) + ", \"r\": 0.1}"));
+        }
+        check(writer->count() == 3000);
+        writer->close();
+    }
+    NdjsonReader reader = NdjsonReader::open(path);
+    int count = 0;
+    for (ValuePtr record; reader.next(record); ++count) {
+        check(at(*record, "/i")->asNumber() == count);
+        check(at(*record, "/r")->asNumber() == 0.1);
+    }
+    check(count == 3000);
+    std::remove(path.c_str());
+}
+
+/* Control characters and reals survive a write and read back */
+static void test_exact_records() {
+    const std::string text("quote\" backslash\\ \b\f\n\r\t \x01\x1f\0 end", 31);
+    const double reals[] = {0.1, 1.0 / 3, 1e300, -2.5e-300, 9007199254740993.0,
+                            std::numeric_limits<double>::max(), 1.0};
+
+    std::string out;
+    {
+        NdjsonWriter writer(std::make_unique<StringSink>(out));
+        writer.write(makeRef<JsonValue>(text));
+        for (double real : reals) {
+            writer.write(makeRef<JsonValue>(real));
+        }
+        writer.close();
+    }
+    check(out.find('\x01') == std::string::npos && out.find('\t') == std::string::npos);
+    check(out.find("\\u0001") != std::string::npos && out.find("\\u001f") != std::string::npos);
+
+    NdjsonReader reader(std::make_unique<MemorySource>(out.data(), out.size()));
+    ValuePtr value;
+    check(reader.next(value) && value->asString() == text);
+    for (double real : reals) {
+        check(reader.next(value) && value->asNumber() == real);
+    }
+    // Reals stay reals
+    check(value->toString() == "1.0");
+    check(!reader.next(value));
+}
+
+static void test_dump_to_sink() {
+    std::string out;
+    StringSink sink(out);
+    JsonDumper().dump(Parser::parseText("[1, \"two\", [3.5]]"), sink);
+    check(out == "[1, \"two\", [3.5]]");
+}
+
+static void run_tests() {
+    for (Compression format : {Compression::Gzip, Compression::Zstd}) {
+        if (!compressionSupported(format)) {
+            check_throws(JsonErrorCode::InvalidFormat, openOutput("unsupported.out", format));
+            check(!std::ifstream("unsupported.out"));
+            continue;
+        }
+        test_block_boundaries(format);
+        test_ndjson_round_trip(format);
+    }
+    test_exact_records();
+    test_dump_to_sink();
+}
@@ -0,0 +1,154 @@
+#include "concurrent_object.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jsson;
+
+static const int kThreads = 8;
+static const int kRounds = 2000;
+
+static void test_single_thread() {
+    ConcurrentObject object;
+    check(!object.get("a"));
+    check(object.set("a", makeRef<JsonValue>(1)));
+    check(!object.set("a", makeRef<JsonValue>(2)));
+    check(object.get("a")->asNumber() == 2);
+
+    check(object.set("n", ValuePtr()));
+    check(object.get("n") && object.get("n")->isNull()); // null handle stores JSON null
+
+    ValuePtr current = object.get("a");
+    check(!object.compareAndSet("a", makeRef<JsonValue>(2), makeRef<JsonValue>(3)));
+    check(object.compareAndSet("a", current, makeRef<JsonValue>(3)));
+    check(object.get("a")->asNumber() == 3);
+    check(object.compareAndSet("b", ValuePtr(), makeRef<JsonValue>(4))); // expected absent
+    check(object.compareAndSet("b", object.get("b"), ValuePtr()));       // desired absent
+    check(!object.get("b"));
+
+    check(!object.update("a", [](const JsonValue*) { return ValuePtr(); }));
+    check(!object.get("a") && object.size() == 1);
+    check(object.erase("n") && !object.erase("n") && object.size() == 0);
+
+    JsonObject source;
+    source["x"] = JsonValue(std::string("y"));
+    ConcurrentObject copy(source, 4);
+    check(copy.get("x")->asStringView() == "y");
+}
+
+static void test_concurrent_updates() {
+    ConcurrentObject object;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kRounds; ++i) {
+                // A shared counter, bumped with update()
+                object.update("counter", [](const JsonValue* current) {
+                    return makeRef<JsonValue>(current ? current->asNumber() + 1 : 1.0);
+                });
+                // Another, bumped with a compare-and-set retry loop
+                for (;;) {
+                    ValuePtr seen = object.get("cas");
+                    double next = seen ? seen->asNumber() + 1 : 1.0;
+                    if (object.compareAndSet("cas", seen, makeRef<JsonValue>(next))) {
+                        break;
+                    }
+                }
+                // Private keys, created and dropped
+                std::string key = "t" + std::to_string(t) + "/" + std::to_string(i % 50);
+                object.set(key, makeRef<JsonValue>(i));
+                if (i % 3 == 0) {
+                    object.erase(key);
+                }
+            }
+        });
+    }
+
+    // Readers keep values alive while writers replace them
+    std::atomic<bool> stop(false);
+    std::thread reader([&] {
+        double last = 0;
+        while (!stop.load()) {
+            ValuePtr value = object.get("counter");
+            if (value) {
+                check(value->asNumber() >= last);
+                last = value->asNumber();
+            }
+        }
+    });
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    stop = true;
+    reader.join();
+
+    check(object.get("counter")->asNumber() == kThreads * kRounds);
+    check(object.get("cas")->asNumber() == kThreads * kRounds);
+
+    JsonObject snapshot = object.snapshot();
+    check(snapshot.keys().size() == object.size());
+    for (int t = 0; t < kThreads; ++t) {
+        for (int k = 0; k < 50; ++k) {
+            // The last write to key k was round kRounds - 50 + k
+            int last = kRounds - 50 + k;
+            auto found = snapshot.keys().find("t" + std::to_string(t) + "/" + std::to_string(k));
+            check((found != snapshot.keys().end()) == (last % 3 != 0));
+            if (found != snapshot.keys().end()) {
+                check(found->second->asNumber() == last);
+            }
+        }
+    }
+}
+
+/* true if every node under @p value has an atomic reference count */
+static bool allAtomic(const JsonValue& value) {
+    if (!value.hasAtomicRefCount()) {
+        return false;
+    }
+    const auto& data = value.raw_variant();
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+        for (const auto& entry : (*object)->keys()) {
+            if (!allAtomic(*entry.second)) return false;
+        }
+    } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+        for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+            if (!allAtomic(*it.value())) return false;
+        }
+    } else if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+        for (const auto& element : (*array)->data()) {
+            if (!allAtomic(*element)) return false;
+        }
+    }
+    return true;
+}
+
+static void test_publish_whole_subtree() {
+    ParseOptions options;
+    options.atomicRefCounts = false;
+    options.orderedObjectMinSize = 2;
+    const char* text = "{\"a\": [1, {\"b\": [true]}], \"o\": {\"x\": {}, \"y\": [null]}}";
+
+    ConcurrentObject object;
+    ValuePtr value = Parser::parseText(text, options);
+    check(!allAtomic(*value));
+    object.set("k", value);
+    check(allAtomic(*value));
+
+    ValuePtr desired = Parser::parseText(text, options);
+    check(object.compareAndSet("k", value, desired));
+    check(allAtomic(*desired));
+
+    ValuePtr updated = object.update("k", [&](const JsonValue*) {
+        return Parser::parseText(text, options);
+    });
+    check(allAtomic(*updated));
+}
+
+static void run_tests() {
+    test_single_thread();
+    test_concurrent_updates();
+    test_publish_whole_subtree();
+}
@@ -0,0 +1,117 @@
+#include "json_pointer.hpp"
+#include "ndjson.hpp"
+#include "parser.hpp"
+#include "sort.hpp"
+#include "util.hpp"
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(std::string& out) : out_(out) {}
+    void write(const char* data, size_t size) override { out_.append(data, size); }
+
+private:
+    std::string& out_;
+};
+
+static const char* kScratch = "external_sort.scratch";
+
+/* Records with keys of every kind, some missing, and irregular spacing */
+static std::vector<std::string> records() {
+    std::mt19937_64 random(124);
+    std::vector<std::string> lines;
+    for (int i = 0; i < 20000; ++i) {
+        std::string key;
+        switch (random() % 6) {
+        case 0: key = std::to_string(int64_t(random() % 1000) - 500); break;
+        case 1: key = std::to_string((random() % 1000) / 7.0); break;
+        case 2: key = "\"s" + std::to_string(random() % 500) + "\\\"x\""; break;
+        case 3: key = "null"; break;
+        case 4: key = "\"" + std::string(20 + random() % 10, char('a' + random() % 3)) + "\""; break;
+        default: break;
+        }
+        lines.push_back("{\"seq\":" + std::to_string(i) + (key.empty() ? "" : ",\"k\":" + key) +
+                        ",  \"pad\":\"xxxxxxxxxxxxxxxx\"}");
+    }
+    return lines;
+}
+
+static std::vector<std::string> sorted(const std::vector<std::string>& lines,
+                                       const ExternalSortOptions& options, size_t& count) {
+    std::string input;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        input += lines[i] + (i % 1000 == 0 ? "\n\n" : "\n"); // blank lines are skipped
+    }
+    std::string output;
+    {
+        NdjsonReader in(std::make_unique<MemorySource>(input.data(), input.size()));
+        NdjsonWriter out(std::make_unique<StringSink>(output));
+        count = sortNdjson(in, out, JsonPointer("/k"), options);
+        out.close();
+    }
+    std::vector<std::string> result;
+    for (size_t pos = 0, end; (end = output.find('\n', pos)) != std::string::npos; pos = end + 1) {
+        result.push_back(output.substr(pos, end - pos));
+    }
+    return result;
+}
+
+static void test_matches_sort_by() {
+    std::vector<std::string> lines = records();
+    std::filesystem::create_directories(kScratch);
+    for (SortOrder order : {SortOrder::Ascending, SortOrder::Descending}) {
+        // The in-memory order sortBy() gives, with equal keys in input order
+        JsonArray reference;
+        for (const std::string& line : lines) {
+            reference.data().push_back(Parser::parseText(line));
+        }
+        sortBy(reference, JsonPointer("/k"), order, 1);
+
+        for (size_t memoryLimit : {size_t(256) << 20, size_t(200000)}) {
+            ExternalSortOptions options;
+            options.order = order;
+            options.memoryLimit = memoryLimit;
+            options.scratchDir = kScratch;
+            options.maxFanIn = 3; // several merge passes
+            options.threads = 3;
+            size_t count = 0;
+            std::vector<std::string> got = sorted(lines, options, count);
+            check(count == lines.size() && got.size() == lines.size());
+            for (size_t i = 0; i < got.size(); ++i) {
+                size_t seq = size_t(JsonPointer("/seq").resolve(*reference.data()[i])->asNumber());
+                check(got[i] == lines[seq]); // copied byte for byte
+            }
+            check(std::filesystem::is_empty(kScratch));
+        }
+    }
+}
+
+static void test_errors_and_empty() {
+    ExternalSortOptions options;
+    options.scratchDir = kScratch;
+    options.memoryLimit = 64;
+    std::string output;
+    {
+        std::string input = "{\"k\": 1}\n{\"k\": 2}\n\n{\"k\":\n";
+        NdjsonReader in(std::make_unique<MemorySource>(input.data(), input.size()));
+        NdjsonWriter out(std::make_unique<StringSink>(output));
+        check_throws(JsonErrorCode::PrematureEndOfInput, sortNdjson(in, out, JsonPointer("/k"), options));
+    }
+    check(std::filesystem::is_empty(kScratch));
+
+    NdjsonReader in(std::make_unique<MemorySource>("", 0));
+    NdjsonWriter out(std::make_unique<StringSink>(output));
+    check(sortNdjson(in, out, JsonPointer("/k"), options) == 0);
+    std::filesystem::remove_all(kScratch);
+}
+
+static void run_tests() {
+    test_matches_sort_by();
+    test_errors_and_empty();
+}
@@ -0,0 +1,68 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace jsson;
+
+static std::unique_ptr<char[]> copyOf(const std::string& text) {
+    std::unique_ptr<char[]> buf(new char[text.size()]);
+    std::memcpy(buf.get(), text.data(), text.size());
+    return buf;
+}
+
+static void test_strings_in_buffer() {
+    const std::string text =
+        "{\"plain\": \"hello\", \"k\\u0065y\": \"tab\\there \\u00e9 \\\"q\\\"\", \"a\": [\"x\\/y\", 2]}";
+    std::unique_ptr<char[]> owned = copyOf(text);
+    const char* begin = owned.get();
+    const char* end = begin + text.size();
+    ValuePtr root = Parser::parseInSitu(std::move(owned), text.size());
+
+    const JsonValue* plain = JsonPointer("/plain").resolve(*root);
+    const JsonValue* escaped = JsonPointer("/key").resolve(*root); // key unescaped too
+    const JsonValue* element = JsonPointer("/a/0").resolve(*root);
+    check(plain && escaped && element);
+    check(plain->isRawString() && escaped->isRawString());
+    check(plain->asStringView() == "hello");
+    check(escaped->asStringView() == "tab\there \xc3\xa9 \"q\"");
+    check(element->asStringView() == "x/y");
+
+    // Values view the buffer itself, already unescaped
+    for (const JsonValue* value : {plain, escaped, element}) {
+        std::string_view view = value->asStringView();
+        check(view.data() >= begin && view.data() + view.size() <= end);
+    }
+
+    // Unescaped values are escaped again when dumped
+    check(canonical(*root) == canonical(*Parser::parseText(text)));
+}
+
+static void test_lifetime() {
+    const std::string text = "[\"a\\nb\", {\"s\": \"\\u0001\"}]";
+    ValuePtr element;
+    {
+        ValuePtr root = Parser::parseInSitu(copyOf(text), text.size());
+        element = makeRef<JsonValue>(*JsonPointer("/1/s").resolve(*root));
+        check(JsonPointer("/0").resolve(*root)->asStringView() == "a\nb");
+    }
+    // A copied value keeps the buffer alive once the document is gone
+    check(element->asStringView() == "\x01");
+    check(element->toString() == "\"\\u0001\"");
+}
+
+static void test_errors() {
+    const std::string bad = "[\"ok\", \"bad \\q\"]";
+    check_throws(JsonErrorCode::InvalidSyntax, Parser::parseInSitu(copyOf(bad), bad.size()));
+    const std::string truncated = "{\"a\": \"unterminated";
+    check_throws(JsonErrorCode::PrematureEndOfInput,
+                 Parser::parseInSitu(copyOf(truncated), truncated.size()));
+}
+
+static void run_tests() {
+    test_strings_in_buffer();
+    test_lifetime();
+    test_errors();
+}
@@ -0,0 +1,189 @@
+#include "join.hpp"
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(std::string& out) : out_(out) {}
+    void write(const char* data, size_t size) override { out_.append(data, size); }
+
+private:
+    std::string& out_;
+};
+
+static const char* kScratch = "join.scratch";
+
+static std::string ndjson(const std::vector<std::string>& lines) {
+    std::string text;
+    for (const std::string& line : lines) {
+        text += line + "\n";
+    }
+    return text;
+}
+
+static std::vector<std::string> join(const std::vector<std::string>& build,
+                                     const std::vector<std::string>& probe,
+                                     const JoinOptions& options, const char* key = "/user_id") {
+    const std::string buildText = ndjson(build), probeText = ndjson(probe);
+    std::string output;
+    size_t count;
+    {
+        NdjsonReader buildIn(std::make_unique<MemorySource>(buildText.data(), buildText.size()));
+        NdjsonReader probeIn(std::make_unique<MemorySource>(probeText.data(), probeText.size()));
+        NdjsonWriter out(std::make_unique<StringSink>(output));
+        count = hashJoin(buildIn, JsonPointer(key), probeIn, JsonPointer(key), out, options);
+        out.close();
+    }
+    std::vector<std::string> lines;
+    for (size_t pos = 0, end; (end = output.find('\n', pos)) != std::string::npos; pos = end + 1) {
+        lines.push_back(output.substr(pos, end - pos));
+    }
+    check(lines.size() == count);
+    return lines;
+}
+
+static void test_splicing_and_keys() {
+    JoinOptions options;
+    options.type = JoinType::Left;
+    std::vector<std::string> build = {
+        "{\"k\": 1.0, \"b\": \"x\\u0041\",  \"n\": 1e2}",
+        "{ \"k\" : \"1\", \"s\": true }",
+        "{\"k\": {\"y\": [1, 2], \"x\": null}, \"obj\": 1}",
+        "{\"k\": 1, \"b\": \"second\", \"b\": \"dup\", \"c\": {}}",
+        "{\"k\": null, \"never\": 1}",
+    };
+    std::vector<std::string> probe = {
+        "{\"a\": 1.50, \"k\": 1}",
+        "  {\"k\": \"1\"}  ",
+        "{\"k\": {\"x\": null, \"y\": [1, 2.0]}}",
+        "{\"k\": null}",
+        "{\"k\": 2, \"keep\": \"\\n\"}",
+        "{}",
+    };
+    std::vector<std::string> expected = {
+        // 1 matches 1.0, members keep their exact text, the probe's own win
+        "{\"a\": 1.50, \"k\": 1,\"b\": \"x\\u0041\",\"n\": 1e2}",
+        "{\"a\": 1.50, \"k\": 1,\"b\": \"second\",\"c\": {}}",
+        // "1" matches only the string key
+        "{\"k\": \"1\",\"s\": true}",
+        // objects match regardless of member order, 2.0 equals 2
+        "{\"k\": {\"x\": null, \"y\": [1, 2.0]},\"obj\": 1}",
+        // null and missing keys never match; Left join copies them
+        "{\"k\": null}",
+        "{\"k\": 2, \"keep\": \"\\n\"}",
+        "{}",
+    };
+    check(join(build, probe, options, "/k") == expected);
+
+    options.type = JoinType::Inner;
+    std::vector<std::string> inner = join(build, probe, options, "/k");
+    check(inner.size() == 4 && std::equal(inner.begin(), inner.end(), expected.begin()));
+
+    // "/0" finds the key in both, but an array cannot be joined
+    check_throws(JsonErrorCode::WrongType, join({"{\"0\": 1}"}, {"[1]"}, options, "/0"));
+    check_throws(JsonErrorCode::WrongType, join({"[1]"}, {"{\"0\": 1}"}, options, "/0"));
+}
+
+static void test_against_reference() {
+    std::mt19937_64 random(125);
+    std::vector<std::string> users, events;
+    for (int u = 0; u < 1500; ++u) {
+        users.push_back("{\"user_id\":" + std::to_string(u) + ",\"name\":\"n" + std::to_string(u) +
+                        "\",\"event\":\"shadowed\"}");
+        if (u % 100 == 0) {
+            users.push_back("{\"user_id\":" + std::to_string(u) + ",\"name\":\"dup\",\"tier\":2}");
+        }
+    }
+    users.push_back("{\"user_id\":null,\"name\":\"nullkey\"}");
+    users.push_back("{\"name\":\"nokey\"}");
+    users.push_back("{\"user_id\":\"7\",\"name\":\"stringkey\"}");
+    for (int i = 0; i < 10000; ++i) {
+        unsigned r = random() % 20;
+        std::string id = r == 0 ? "" : r == 1 ? ",\"user_id\":null"
+                                              : ",\"user_id\":" + std::to_string(random() % 1800);
+        events.push_back("{\"seq\":" + std::to_string(i) + id + ",\"event\":\"e" +
+                         std::to_string(random() % 5) + "\"}");
+    }
+
+    // Merged member sets, in probe order and then build order
+    std::multimap<double, std::string> byKey;
+    for (const std::string& user : users) {
+        ValuePtr value = Parser::parseText(user);
+        const JsonValue* key = JsonPointer("/user_id").resolve(*value);
+        if (key && key->isNumber()) {
+            byKey.emplace(key->asNumber(), user);
+        }
+    }
+    std::vector<std::string> inner, left;
+    for (const std::string& event : events) {
+        ValuePtr value = Parser::parseText(event);
+        const JsonValue* key = JsonPointer("/user_id").resolve(*value);
+        bool matched = false;
+        if (key && key->isNumber()) {
+            auto range = byKey.equal_range(key->asNumber());
+            for (auto it = range.first; it != range.second; ++it) {
+                ValuePtr joined = Parser::parseText(event);
+                ValuePtr user = Parser::parseText(it->second);
+                auto& members = std::get<std::unique_ptr<JsonObject>>(joined->raw_variant())->keys();
+                for (auto& member : std::get<std::unique_ptr<JsonObject>>(user->raw_variant())->keys()) {
+                    members.emplace(member.first, member.second);
+                }
+                inner.push_back(canonical(*joined));
+                left.push_back(canonical(*joined));
+                matched = true;
+            }
+        }
+        if (!matched) {
+            left.push_back(canonical(*value));
+        }
+    }
+
+    std::filesystem::create_directories(kScratch);
+    for (JoinType type : {JoinType::Inner, JoinType::Left}) {
+        std::vector<std::string> expected = type == JoinType::Inner ? inner : left;
+        for (size_t memoryLimit : {size_t(256) << 20, size_t(20000), size_t(2000)}) {
+            JoinOptions options;
+            options.type = type;
+            options.memoryLimit = memoryLimit;
+            options.scratchDir = kScratch;
+            options.threads = 3;
+            std::vector<std::string> got;
+            for (const std::string& line : join(users, events, options)) {
+                got.push_back(canonical(*Parser::parseText(line)));
+            }
+            check(std::filesystem::is_empty(kScratch));
+            if (memoryLimit == (size_t(256) << 20)) {
+                check(got == expected); // in memory: probe order
+            } else {
+                // Grace hash join: grouped by partition
+                std::vector<std::string> sortedExpected = expected;
+                std::sort(got.begin(), got.end());
+                std::sort(sortedExpected.begin(), sortedExpected.end());
+                check(got == sortedExpected);
+            }
+        }
+    }
+
+    JoinOptions options;
+    options.scratchDir = kScratch;
+    options.memoryLimit = 2000;
+    check_throws(JsonErrorCode::PrematureEndOfInput,
+                 join(users, {"{\"user_id\":1}", "{\"user_id\":"}, options));
+    check(std::filesystem::is_empty(kScratch));
+    std::filesystem::remove_all(kScratch);
+}
+
+static void run_tests() {
+    test_splicing_and_keys();
+    test_against_reference();
+}
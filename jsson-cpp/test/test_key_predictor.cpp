@@ -0,0 +1,156 @@
+#include "json_pointer.hpp"
+#include "ndjson.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <memory>
+#include <string>
+#include <variant>
+
+using namespace jsson;
+
+static void test_match() {
+    KeyOrderPredictor predictor(2);
+    check(!predictor.match(0, 0, "\"id\": 1"));
+    predictor.learn(0, 0, "id");
+    predictor.learn(0, 1, "name");
+    predictor.finish(0, 2);
+    check(predictor.expectedSize(0) == 2 && predictor.expectedSize(1) == 0);
+
+    const std::string* key = predictor.match(0, 0, "\"id\": 1");
+    check(key && *key == "id");
+    check(!predictor.match(0, 0, "\"idx\": 1")); // a longer key is no match
+    check(!predictor.match(0, 0, "\"i\": 1"));
+    check(!predictor.match(0, 0, "\"id"));      // input ends too soon
+    check(predictor.match(0, 1, "\"name\"") != nullptr);
+    check(predictor.hits() == 2 && predictor.misses() == 3);
+
+    // Keys with quotes or escapes, and positions past the limit, are never predicted
+    predictor.learn(1, 0, "a\"b");
+    check(!predictor.match(1, 0, "\"a\\\"b\": 1"));
+    predictor.learn(2, 0, "far");
+    check(!predictor.match(2, 0, "\"far\": 1"));
+
+    predictor.clear();
+    check(!predictor.match(0, 0, "\"id\": 1") && predictor.expectedSize(0) == 0);
+}
+
+static void test_parse_stream() {
+    ParseOptions options;
+    options.keyPredictor = std::make_shared<KeyOrderPredictor>();
+    const KeyOrderPredictor& predictor = *options.keyPredictor;
+
+    const char* first = "{\"id\": 1, \"user\": {\"name\": \"a\", \"age\": 3}, \"tags\": [{\"k\": 1}]}";
+    ValuePtr value = Parser::parseText(first, options);
+    check(predictor.hits() == 0);
+    check(canonical(*value) == canonical(*Parser::parseText(first)));
+
+    // Same shape: every key comes from the prediction
+    const char* same = "{\"id\": 2, \"user\": {\"name\": \"b\", \"age\": 4}, \"tags\": [{\"k\": 2}]}";
+    value = Parser::parseText(same, options);
+    check(predictor.hits() == 6 && predictor.misses() == 0);
+    check(canonical(*value) == canonical(*Parser::parseText(same)));
+
+    // Reordered and renamed keys fall back and still parse correctly
+    const char* changed = "{\"user\": {\"age\": 5, \"nick\": \"c\"}, \"id\": 3, \"tags\": [{\"k\": 3}, {\"q\": 1}]}";
+    value = Parser::parseText(changed, options);
+    check(predictor.misses() > 0);
+    check(canonical(*value) == canonical(*Parser::parseText(changed)));
+    size_t hits = predictor.hits();
+    value = Parser::parseText(changed, options);
+    check(predictor.hits() == hits + 7); // the new shape was learned
+
+    // Escaped keys are unescaped on the general path
+    const char* escaped = "{\"a\\\"b\": 1, \"\\u0041\": 2}";
+    for (int i = 0; i < 2; ++i) {
+        value = Parser::parseText(escaped, options);
+        check(JsonPointer("/a\"b").resolve(*value)->asNumber() == 1);
+        check(JsonPointer("/A").resolve(*value)->asNumber() == 2);
+    }
+    // A literal key equal to the unescaped form of a learned one
+    value = Parser::parseText("{\"x\": 1, \"A\": 3}", options);
+    check(JsonPointer("/A").resolve(*value)->asNumber() == 3);
+}
+
+static void test_prototype() {
+    KeyOrderPredictor predictor;
+    predictor.learn(0, 0, "id");
+    predictor.learn(0, 1, "name");
+    predictor.finish(0, 2);
+    check(predictor.prototype(0) == nullptr); // the shape has to repeat first
+    predictor.finish(0, 2);
+    const JsonObject::Map* prototype = predictor.prototype(0);
+    check(prototype && prototype->size() == 2);
+    check(std::get<int64_t>(prototype->at("name")->raw_variant()) == 1);
+
+    predictor.learn(0, 1, "nick");
+    check(predictor.prototype(0) == nullptr);
+    predictor.finish(0, 2);
+    predictor.finish(0, 1);
+    check(predictor.prototype(0) == nullptr); // shortened
+
+    // Repeated keys get no prototype
+    predictor.learn(1, 0, "k");
+    predictor.learn(1, 1, "k");
+    predictor.finish(1, 2);
+    predictor.finish(1, 2);
+    check(predictor.prototype(1) == nullptr);
+}
+
+static void test_parse_prototype() {
+    ParseOptions options;
+    options.keyPredictor = std::make_shared<KeyOrderPredictor>();
+    const KeyOrderPredictor& predictor = *options.keyPredictor;
+
+    const char* shape = "{\"a\": 1, \"b\": {\"c\": [1, {\"d\": 2}], \"e\": null}, \"f\": \"x\"}";
+    for (int i = 0; i < 3; ++i) {
+        ValuePtr value = Parser::parseText(shape, options);
+        check(canonical(*value) == canonical(*Parser::parseText(shape)));
+    }
+    check(predictor.prototype(0) && predictor.prototype(1) && predictor.prototype(2));
+    check(predictor.hits() == 2 * 6);
+
+    // Every way an object can leave its predicted shape
+    const char* variants[] = {
+        "{\"a\": 2, \"b\": {\"c\": [], \"e\": 1}, \"f\": \"y\"}",   // same shape
+        "{\"a\": 2}",                                            // ends early
+        "{}",
+        "{\"a\": 2, \"z\": 3, \"f\": 4}",                         // miss mid-object
+        "{\"z\": 1, \"a\": 2, \"b\": 3, \"f\": 4}",                // miss first
+        "{\"a\": 2, \"b\": {\"e\": 1, \"c\": 0}, \"f\": 5, \"g\": 6}", // longer, nested reorder
+        "{\"a\": 2, \"a\": 3, \"f\": 4}",                         // duplicate of a placed key
+        "{\"a\": 2, \"b\": 3, \"f\": 4, \"f\": 5}",                // duplicate after the shape
+    };
+    for (const char* text : variants) {
+        for (int i = 0; i < 2; ++i) {
+            ValuePtr value = Parser::parseText(shape, options);
+            value = Parser::parseText(shape, options);
+            check(canonical(*value) == canonical(*Parser::parseText(shape)));
+            value = Parser::parseText(text, options);
+            check(canonical(*value) == canonical(*Parser::parseText(text)));
+        }
+    }
+}
+
+static void test_ndjson_reader() {
+    std::string data;
+    for (int i = 0; i < 100; ++i) {
+        data += "{\"i\": " + std::to_string(i) + ", \"s\": \"v\"}\n";
+    }
+    NdjsonReader reader(std::make_unique<MemorySource>(data.data(), data.size()));
+    check(reader.options().keyPredictor != nullptr);
+    ValuePtr record;
+    int count = 0;
+    while (reader.next(record)) {
+        check(JsonPointer("/i").resolve(*record)->asNumber() == count++);
+    }
+    check(count == 100);
+    check(reader.options().keyPredictor->hits() == 2 * 99);
+}
+
+static void run_tests() {
+    test_match();
+    test_parse_stream();
+    test_prototype();
+    test_parse_prototype();
+    test_ndjson_reader();
+}
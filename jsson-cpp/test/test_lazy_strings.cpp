@@ -0,0 +1,76 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "raw_string.hpp"
+#include "util.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jsson;
+
+static ParseOptions lazy() {
+    ParseOptions options;
+    options.lazyStrings = true;
+    return options;
+}
+
+static void test_views() {
+    std::string text = "{\"plain\": \"hello\", \"esc\\\"key\": \"tab\\there \\u00e9 \\\"q\\\"\", \"n\": 1}";
+    ValuePtr root = Parser::parseText(text, lazy());
+    text.assign(text.size(), 'X'); // the document keeps its own copy of the input
+
+    const JsonValue* plain = JsonPointer("/plain").resolve(*root);
+    const JsonValue* escaped = JsonPointer("/esc\"key").resolve(*root);
+    check(plain && escaped);
+    check(plain->isRawString() && escaped->isRawString());
+    check(plain->asStringView() == "hello");
+    check(escaped->asStringView() == "tab\there \xc3\xa9 \"q\"");
+
+    // Escaped text is dumped verbatim, and compares by its decoded value
+    check(escaped->toString() == "\"tab\\there \\u00e9 \\\"q\\\"\"");
+    check(plain->stringEquals(JsonValue(std::string("hello"))));
+    check(escaped->stringEquals("tab\there \xc3\xa9 \"q\""));
+    check(!escaped->stringEquals(*plain));
+}
+
+static void test_concurrent_decode() {
+    ValuePtr root = Parser::parseText("[\"a\\nb\\u0041\"]", lazy());
+    const JsonValue* value = JsonPointer("/0").resolve(*root);
+    std::vector<const char*> seen(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&, t] { seen[t] = value->asStringView().data(); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const char* data : seen) {
+        check(data == seen[0]); // decoded exactly once
+    }
+    check(value->asStringView() == "a\nbA");
+}
+
+static void test_mutation_and_errors() {
+    ValuePtr root = Parser::parseText("[\"raw\"]", lazy());
+    JsonValue* value = const_cast<JsonValue*>(JsonPointer("/0").resolve(*root));
+    value->asString() += "!";
+    check(!value->isRawString() && value->asStringView() == "raw!");
+
+    // Escapes are still validated up front
+    check_throws(JsonErrorCode::InvalidSyntax, Parser::parseText("[\"bad \\q\"]", lazy()));
+    check_throws(JsonErrorCode::InvalidSyntax, Parser::parseText("[\"bad \\u12\"]", lazy()));
+    check_throws(JsonErrorCode::PrematureEndOfInput, Parser::parseText("[\"open", lazy()));
+}
+
+static void test_raw_control_characters() {
+    // The parser lets raw control characters through; dumps must escape them
+    ValuePtr root = Parser::parseText(std::string("[\"a\tb\x01\"]"), lazy());
+    check(root->toString() == "[\"a\\tb\\u0001\"]");
+}
+
+static void run_tests() {
+    test_views();
+    test_concurrent_decode();
+    test_mutation_and_errors();
+    test_raw_control_characters();
+}
@@ -0,0 +1,66 @@
+#include "parser.hpp"
+#include "util.hpp"
+#include <chrono>
+#include <string>
+
+using namespace jsson;
+
+static std::string nested(size_t depth) {
+    return std::string(depth, '[') + std::string(depth, ']');
+}
+
+static std::string bigArray(size_t count) {
+    std::string text = "[";
+    for (size_t i = 0; i < count; ++i) {
+        text += i ? ",[1,2]" : "[1,2]";
+    }
+    return text + "]";
+}
+
+static void test_exact_limits() {
+    ParseOptions options;
+    options.limits.maxDepth = 10;
+    check(Parser::parseText(nested(10), options));
+    check_throws(JsonErrorCode::DepthLimitExceeded, Parser::parseText(nested(11), options));
+
+    options = ParseOptions();
+    options.limits.maxInputBytes = 8;
+    check(Parser::parseText("[1,2,3]", options));
+    check_throws(JsonErrorCode::InputTooLarge, Parser::parseText("[1,2,3,4]", options));
+
+    options = ParseOptions();
+    options.limits.maxStringLength = 5;
+    check(Parser::parseText("[\"12345\"]", options));
+    check_throws(JsonErrorCode::StringTooLong, Parser::parseText("[\"123456\"]", options));
+    check_throws(JsonErrorCode::StringTooLong, Parser::parseText("{\"123456\": 1}", options));
+}
+
+static void test_checked_limits() {
+    const std::string text = bigArray(10000);
+    check(Parser::parseText(text));
+
+    ParseOptions options;
+    options.limits.maxNodes = 1000;
+    check_throws(JsonErrorCode::TooManyNodes, Parser::parseText(text, options));
+
+    options = ParseOptions();
+    options.limits.maxAllocationBytes = 4096;
+    check_throws(JsonErrorCode::MemoryLimitExceeded, Parser::parseText(text, options));
+
+    options = ParseOptions();
+    options.limits.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    check_throws(JsonErrorCode::DeadlineExceeded, Parser::parseText(text, options));
+
+    options = ParseOptions();
+    auto token = std::make_shared<CancellationToken>();
+    options.limits.cancellation = token;
+    check(Parser::parseText(text, options));
+    token->cancel();
+    check(token->cancelled());
+    check_throws(JsonErrorCode::Cancelled, Parser::parseText(text, options));
+}
+
+static void run_tests() {
+    test_exact_limits();
+    test_checked_limits();
+}
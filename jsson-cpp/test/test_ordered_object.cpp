@@ -0,0 +1,157 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+using Reference = std::map<std::string, double>;
+
+static std::string keyOf(unsigned n) {
+    // Long shared prefixes exercise the per-leaf prefix compression
+    return "user/" + std::to_string(n % 7) + "/item-" + std::to_string(n);
+}
+
+static std::vector<std::string> keysOf(OrderedObject::Range range) {
+    std::vector<std::string> keys;
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        keys.emplace_back(it.key());
+    }
+    return keys;
+}
+
+static std::vector<std::string> keysOf(Reference::const_iterator first,
+                                       Reference::const_iterator last) {
+    std::vector<std::string> keys;
+    for (; first != last; ++first) {
+        keys.push_back(first->first);
+    }
+    return keys;
+}
+
+static void checkSame(const OrderedObject& object, const Reference& reference) {
+    check(object.size() == reference.size());
+    auto expected = reference.begin();
+    for (auto it = object.begin(); it != object.end(); ++it, ++expected) {
+        check(expected != reference.end());
+        check(it.key() == expected->first);
+        check(it.value()->asNumber() == expected->second);
+    }
+    check(expected == reference.end());
+}
+
+static void test_against_map() {
+    OrderedObject object;
+    Reference reference;
+    std::mt19937 random(115);
+    for (int step = 0; step < 40000; ++step) {
+        std::string key = keyOf(random() % 5000);
+        if (random() % 4 == 0) {
+            check(object.erase(key) == (reference.erase(key) == 1));
+        } else {
+            double value = step;
+            check(object.insert(key, makeRef<JsonValue>(value)) == !reference.count(key));
+            reference[key] = value;
+        }
+    }
+    checkSame(object, reference);
+
+    for (unsigned n = 0; n < 5000; n += 37) {
+        std::string key = keyOf(n);
+        const ValuePtr* found = object.find(key);
+        check((found != nullptr) == (reference.count(key) == 1));
+        check(object.contains(key) == (found != nullptr));
+
+        auto lower = object.lower_bound(key);
+        auto expected = reference.lower_bound(key);
+        check((lower == object.end()) == (expected == reference.end()));
+        if (expected != reference.end()) {
+            check(lower.key() == expected->first);
+        }
+        auto upper = object.upper_bound(key);
+        expected = reference.upper_bound(key);
+        check((upper == object.end()) == (expected == reference.end()));
+        if (expected != reference.end()) {
+            check(upper.key() == expected->first);
+        }
+    }
+
+    check(keysOf(object.range("user/2/", "user/3/item-5")) ==
+          keysOf(reference.lower_bound("user/2/"), reference.lower_bound("user/3/item-5")));
+    check(keysOf(object.prefix("user/4/item-1")) ==
+          keysOf(reference.lower_bound("user/4/item-1"), reference.lower_bound("user/4/item-2")));
+    check(keysOf(object.prefix("nothing")).empty());
+
+    check_throws(JsonErrorCode::ItemNotFound, object.at("missing"));
+    object["missing"];
+    check(object.at("missing").isNull());
+}
+
+static void test_bulk_load_and_copy() {
+    OrderedObject object;
+    Reference reference;
+    for (unsigned n = 0; n < 10000; ++n) {
+        char key[16];
+        std::snprintf(key, sizeof(key), "%08u", n);
+        object.insert(key, makeRef<JsonValue>(double(n)));
+        reference[key] = n;
+    }
+    checkSame(object, reference);
+
+    OrderedObject copy(object);
+    copy.erase("00000000");
+    checkSame(object, reference);
+    check(copy.size() == object.size() - 1 && copy.begin().key() == "00000001");
+}
+
+static void test_paging() {
+    OrderedObject object;
+    for (unsigned n = 0; n < 1000; ++n) {
+        object.insert(keyOf(n), makeRef<JsonValue>(double(n)));
+    }
+    std::vector<std::string> paged;
+    std::optional<std::string> after;
+    size_t pages = 0;
+    do {
+        OrderedObject::Page page = object.listPage(after, 64, "user/3/");
+        for (auto& entry : page.entries) {
+            paged.push_back(entry.first);
+        }
+        after = page.next;
+        // The cursor survives changes between pages
+        object.insert("user/3/item-0000", makeRef<JsonValue>(0.0));
+        object.erase("user/3/item-0000");
+        ++pages;
+    } while (after);
+    check(paged == keysOf(object.prefix("user/3/")));
+    check(pages >= paged.size() / 64);
+}
+
+static void test_parse_and_dump() {
+    ParseOptions options;
+    options.orderedObjectMinSize = 3;
+    ValuePtr root = Parser::parseText("{\"small\": {\"b\": 1, \"a\": 2}, \"c\": 3, \"b\": [4], \"a\": {\"z\": 1, \"y\": 2, \"x\": 3}}", options);
+    check(root->isOrderedObject() && root->isObject());
+    check(!JsonPointer("/small").resolve(*root)->isOrderedObject());
+    check(JsonPointer("/a").resolve(*root)->isOrderedObject());
+    check(JsonPointer("/a/y").resolve(*root)->asNumber() == 2);
+    check(JsonPointer("/b/0").resolve(*root)->asNumber() == 4);
+
+    // Dumps come out in key order
+    const std::string text = root->toString();
+    check(text.find("\"a\"") < text.find("\"b\"") && text.find("\"b\"") < text.find("\"c\""));
+    check(text.find("\"x\"") < text.find("\"y\"") && text.find("\"y\"") < text.find("\"z\""));
+    check(canonical(*root) == canonical(*Parser::parseText(text)));
+}
+
+static void run_tests() {
+    test_against_map();
+    test_bulk_load_and_copy();
+    test_paging();
+    test_parse_and_dump();
+}
@@ -0,0 +1,91 @@
+#include "arena.hpp"
+#include "dump.hpp"
+#include "hashtable.hpp"
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "probes.hpp"
+#include "util.hpp"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jsson;
+
+static void test_macros() {
+    // Arguments are evaluated exactly once, with or without USDT
+    int a = 0, b = 0, c = 0;
+    JSSON_PROBE0(test_none);
+    JSSON_PROBE1(test_one, ++a);
+    JSSON_PROBE2(test_two, ++a, ++b);
+    JSSON_PROBE3(test_three, ++a, ++b, ++c);
+    check(a == 3 && b == 2 && c == 1);
+
+    // Each probe is a single statement
+    if (a == 3)
+        JSSON_PROBE1(test_if, a);
+    else
+        fail("probe broke the if statement");
+}
+
+static void test_probed_paths() {
+    // Parser: start/done on success, error on failure
+    ValuePtr value = Parser::parseText("{\"a\": [1, 2, {\"b\": null}]}");
+    check(JsonPointer("/a/1").resolve(*value)->asNumber() == 2);
+    check_throws(JsonErrorCode::InvalidSyntax, Parser::parseText("{\"a\" 1}"));
+
+    // Dumper and serializer
+    std::string text = value->toString();
+    JsonSerializer serializer(value);
+    std::string pulled;
+    char buffer[8];
+    while (size_t n = serializer.next(buffer, sizeof(buffer))) {
+        pulled.append(buffer, n);
+    }
+    check(pulled == text);
+
+    // Arena blocks
+    NodeArena arena(256);
+    {
+        ArenaScope scope(arena);
+        ValuePtr big = Parser::parseText("[" + std::string(2000, '[') + std::string(2000, ']') + "]");
+        check(big->isArray());
+    }
+    check(arena.blockCount() > 1);
+
+    // HashTable contention and resizes
+    HashTable<int, int> table(1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 5000; ++i) {
+                table.insert(t * 5000 + i, i);
+                table.find(i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    check(table.size() == 20000);
+}
+
+static void test_notes() {
+#ifdef JSSON_HAVE_USDT
+    // The probes are recorded as ELF notes a tracer can find
+    std::ifstream in("/proc/self/exe", std::ios::binary);
+    std::string image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    check(image.find("stapsdt") != std::string::npos);
+    for (const char* name : {"parse_start", "parse_done", "parse_error", "dump_start",
+                             "serialize_chunk", "arena_block", "hashtable_resize"}) {
+        check(image.find(name) != std::string::npos);
+    }
+#endif
+}
+
+static void run_tests() {
+    test_macros();
+    test_probed_paths();
+    test_notes();
+}
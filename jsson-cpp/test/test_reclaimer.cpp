@@ -0,0 +1,100 @@
+#include "json_pointer.hpp"
+#include "reclaimer.hpp"
+#include "util.hpp"
+#include <atomic>
+#include <memory>
+
+using namespace jsson;
+
+static ValuePtr wideArray(size_t size) {
+    JsonArray array;
+    for (size_t i = 0; i < size; ++i) {
+        array.data().push_back(makeRef<JsonValue>(static_cast<int64_t>(i)));
+    }
+    return makeRef<JsonValue>(std::move(array));
+}
+
+/* Sets a flag when destroyed */
+struct Flag {
+    std::shared_ptr<std::atomic<bool>> destroyed;
+    explicit Flag(std::shared_ptr<std::atomic<bool>> d) : destroyed(std::move(d)) {}
+    Flag(Flag&& other) noexcept = default;
+    ~Flag() {
+        if (destroyed) {
+            *destroyed = true;
+        }
+    }
+};
+
+static void test_manual_slices() {
+    Reclaimer reclaimer(Reclaimer::Mode::Manual);
+    reclaimer.retire(wideArray(1000));
+    check(reclaimer.pending() > 0);
+
+    size_t freed = reclaimer.reclaim(100);
+    check(freed > 0 && freed <= 100);
+    check(reclaimer.pending() > 0);
+
+    size_t total = freed;
+    while (size_t n = reclaimer.reclaim(100)) {
+        check(n <= 100);
+        total += n;
+    }
+    check(total == 1001); // the array and its elements
+    check(reclaimer.pending() == 0);
+}
+
+static void test_shared_subtree() {
+    Reclaimer reclaimer(Reclaimer::Mode::Manual);
+    ValuePtr kept = wideArray(10);
+    JsonObject object;
+    object.keys()["kept"] = kept;
+    object.keys()["dropped"] = wideArray(10);
+    ValuePtr root = makeRef<JsonValue>(std::move(object));
+
+    reclaimer.retire(std::move(root));
+    reclaimer.drain();
+    check(reclaimer.pending() == 0);
+    check(JsonPointer("/9").resolve(*kept)->asNumber() == 9);
+}
+
+static void test_deep_tree() {
+    // Recursive destruction would overflow the stack at this depth
+    ValuePtr value = makeRef<JsonValue>(int64_t(0));
+    for (int i = 0; i < 500000; ++i) {
+        JsonArray array;
+        array.data().push_back(std::move(value));
+        value = makeRef<JsonValue>(std::move(array));
+    }
+    Reclaimer reclaimer(Reclaimer::Mode::Manual);
+    reclaimer.retire(std::move(value));
+    reclaimer.drain();
+    check(reclaimer.pending() == 0);
+}
+
+static void test_retire_whole() {
+    auto destroyed = std::make_shared<std::atomic<bool>>(false);
+    {
+        Reclaimer reclaimer(Reclaimer::Mode::Manual);
+        reclaimer.retireWhole(Flag(destroyed));
+        check(!*destroyed);
+        reclaimer.drain();
+        check(*destroyed);
+    }
+
+    // Background: the destructor frees whatever the worker has not reached
+    *destroyed = false;
+    {
+        Reclaimer reclaimer;
+        reclaimer.retire(wideArray(100000));
+        reclaimer.retireWhole(Flag(destroyed));
+    }
+    check(*destroyed);
+}
+
+static void run_tests() {
+    test_manual_slices();
+    test_shared_subtree();
+    test_deep_tree();
+    test_retire_whole();
+}
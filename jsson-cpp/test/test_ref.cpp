@@ -0,0 +1,86 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "ref.hpp"
+#include "util.hpp"
+#include <thread>
+#include <vector>
+
+using namespace jsson;
+
+/* Counts live instances */
+struct Counted {
+    static int live;
+    Counted() { ++live; }
+    ~Counted() { --live; }
+
+private:
+    friend class jsson::Ref<Counted>;
+    RefCount refs_;
+};
+int Counted::live = 0;
+
+static void test_handle() {
+    {
+        Ref<Counted> a = makeRef<Counted>();
+        check(a.use_count() == 1 && Counted::live == 1);
+        Ref<Counted> b = a;
+        check(a.use_count() == 2 && a == b);
+        Ref<Counted> c = std::move(b);
+        check(!b && a.use_count() == 2);
+        c.reset();
+        check(a.use_count() == 1 && Counted::live == 1);
+        check(sizeof(a) == sizeof(void*));
+    }
+    check(Counted::live == 0);
+}
+
+static void test_value_copies() {
+    ValuePtr value = Parser::parseText("{\"a\": [1, 2], \"b\": \"x\"}");
+    ValuePtr other = value;
+    check(value.use_count() == 2);
+
+    // A copied value starts unreferenced; its children are shared
+    ValuePtr copy = makeRef<JsonValue>(*value);
+    check(copy.use_count() == 1 && value.use_count() == 2);
+    check(JsonPointer("/a/1").resolve(*copy) == JsonPointer("/a/1").resolve(*value));
+}
+
+static void test_plain_counts() {
+    ParseOptions options;
+    options.atomicRefCounts = false;
+    ValuePtr plain = Parser::parseText("{\"a\": [1, {\"b\": null}]}", options);
+    check(!plain->hasAtomicRefCount());
+    check(!JsonPointer("/a/1/b").resolve(*plain)->hasAtomicRefCount());
+
+    options.atomicRefCounts = true;
+    ValuePtr atomic = Parser::parseText("[true]", options);
+    check(atomic->hasAtomicRefCount() && JsonPointer("/0").resolve(*atomic)->hasAtomicRefCount());
+
+    plain->setAtomicRefCount(true);
+    check(plain->hasAtomicRefCount());
+}
+
+static void test_threads() {
+    ValuePtr shared = makeRef<JsonValue>(int64_t(7));
+    shared->setAtomicRefCount(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared] {
+            for (int i = 0; i < 100000; ++i) {
+                ValuePtr copy = shared;
+                check(copy->asNumber() == 7);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    check(shared.use_count() == 1);
+}
+
+static void run_tests() {
+    test_handle();
+    test_value_copies();
+    test_plain_counts();
+    test_threads();
+}
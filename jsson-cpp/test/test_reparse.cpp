@@ -0,0 +1,73 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <string>
+
+using namespace jsson;
+
+static const JsonValue* at(const ValuePtr& root, const char* path) {
+    return JsonPointer(path).resolve(*root);
+}
+
+static void test_same_shape() {
+    const char* text = "{\"price\": 1.5, \"name\": \"widget-long-name\", \"ok\": true, \"tags\": [\"a\", \"b\"], \"n\": null}";
+    ValuePtr root = Parser::parseText(text);
+    const JsonValue* price = at(root, "/price");
+    const JsonValue* name = at(root, "/name");
+    const JsonValue* tag = at(root, "/tags/1");
+    const char* nameData = name->asStringView().data();
+    ValuePtr shared = makeRef<JsonValue>(*root); // shares the children
+
+    check(!Parser::reparseInto(*root, text));
+    check(Parser::reparseInto(*root, "{\"price\": 2.5, \"name\": \"gadget\", \"ok\": false, \"tags\": [\"a\", \"c\"], \"n\": null}"));
+
+    // Same nodes, new values; the string reused its buffer
+    check(at(root, "/price") == price && price->asNumber() == 2.5);
+    check(at(root, "/name") == name && name->asStringView() == "gadget");
+    check(name->asStringView().data() == nameData);
+    check(at(root, "/tags/1") == tag && tag->asStringView() == "c");
+    check(!at(root, "/ok")->asBoolean());
+    check(at(shared, "/price")->asNumber() == 2.5);
+
+    // Member order in the text does not matter
+    check(!Parser::reparseInto(*root, "{\"n\": null, \"tags\": [\"a\", \"c\"], \"ok\": false, \"name\": \"gadget\", \"price\": 2.5}"));
+}
+
+static void test_shape_changes() {
+    ValuePtr root = Parser::parseText("{\"keep\": 1, \"drop\": 2, \"list\": [1, 2, 3], \"kind\": \"s\"}");
+    const char* next = "{\"keep\": 1, \"added\": {\"x\": [true]}, \"list\": [1, 2], \"kind\": [\"now an array\"]}";
+    check(Parser::reparseInto(*root, next));
+    check(canonical(*root) == canonical(*Parser::parseText(next)));
+    check(!at(root, "/drop"));
+
+    check(Parser::reparseInto(*root, "{\"keep\": 1, \"added\": {\"x\": [true]}, \"list\": [1, 2, 3, 4], \"kind\": [\"now an array\"]}"));
+    check(at(root, "/list/3")->asNumber() == 4);
+
+    // Dropping a member alone is a change
+    check(Parser::reparseInto(*root, "{\"keep\": 1, \"added\": {\"x\": [true]}, \"list\": [1, 2, 3, 4]}"));
+    check(Parser::reparseInto(*root, "[1]"));
+    check(root->isArray() && root->toString() == "[1]");
+    check(Parser::reparseInto(*root, "\"scalar\"") && root->asStringView() == "scalar");
+
+    ParseOptions ordered;
+    ordered.orderedObjectMinSize = 2;
+    check(Parser::reparseInto(*root, "{\"b\": 1, \"a\": 2}", ordered));
+    check(root->isOrderedObject() && at(root, "/a")->asNumber() == 2);
+    check(Parser::reparseInto(*root, "{\"b\": 1, \"a\": 3}", ordered) && at(root, "/a")->asNumber() == 3);
+}
+
+static void test_errors() {
+    ValuePtr root = Parser::parseText("{\"a\": 1, \"b\": [1, 2]}");
+    check_throws(JsonErrorCode::InvalidSyntax, Parser::reparseInto(*root, "{\"a\": 2, \"b\": [1,, 2]}"));
+    check(root->isObject());
+
+    ParseOptions options;
+    options.limits.maxDepth = 2;
+    check_throws(JsonErrorCode::DepthLimitExceeded, Parser::reparseInto(*root, "{\"a\": [[1]]}", options));
+}
+
+static void run_tests() {
+    test_same_shape();
+    test_shape_changes();
+    test_errors();
+}
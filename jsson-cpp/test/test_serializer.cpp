@@ -0,0 +1,99 @@
+#include "dump.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+static std::string dumped(const ValuePtr& value) {
+    std::ostringstream out;
+    JsonDumper().dump(value, out);
+    return out.str();
+}
+
+/* Everything the serializer produces, pulled @p cap bytes at a time */
+static std::string pulled(const ValuePtr& value, size_t cap) {
+    JsonSerializer serializer(value);
+    std::string out;
+    std::vector<char> buffer(cap);
+    while (size_t n = serializer.next(buffer.data(), buffer.size())) {
+        check(n <= cap);
+        out.append(buffer.data(), n);
+    }
+    check(serializer.done());
+    return out;
+}
+
+static void test_matches_dumper() {
+    const char* documents[] = {
+        "null", "-12", "0.1", "\"s\"", "[]", "{}", "[[], {}, [[]]]",
+        "{\"a\": [1, 2.5, true, null, \"x\\ny\"], \"b\": {\"c\": {\"d\": []}}, \"e\": \"\\u0001\"}",
+    };
+    for (const char* text : documents) {
+        ValuePtr value = Parser::parseText(text);
+        const std::string expected = dumped(value);
+        for (size_t cap : {size_t(1), size_t(2), size_t(3), size_t(7), size_t(4096)}) {
+            check(pulled(value, cap) == expected);
+        }
+    }
+
+    // Ordered objects and lazy strings take their own paths
+    ParseOptions options;
+    options.orderedObjectMinSize = 2;
+    options.lazyStrings = true;
+    ValuePtr ordered = Parser::parseText("{\"z\": 1, \"a\": \"v\\tw\", \"m\": [\"raw\"]}", options);
+    check(pulled(ordered, 5) == dumped(ordered));
+}
+
+static void test_large_interleaved() {
+    std::string text = "[";
+    for (int i = 0; i < 5000; ++i) {
+        text += (i ? "," : "") + std::string("{\"i\":") + std::to_string(i) + ",\"s\":\"" +
+                std::string(i % 50, 'x') + "\"}";
+    }
+    ValuePtr a = Parser::parseText(text + "]");
+    ValuePtr b = Parser::parseText("{\"other\": " + text + "]}");
+
+    // Two responses advanced in turn, as one thread serving two sockets
+    JsonSerializer first(a), second(b);
+    std::string outA, outB;
+    char buffer[100];
+    while (!first.done() || !second.done()) {
+        outA.append(buffer, first.next(buffer, sizeof(buffer)));
+        outB.append(buffer, second.next(buffer, 37));
+    }
+    check(outA == dumped(a) && outB == dumped(b));
+    check(first.next(buffer, sizeof(buffer)) == 0);
+}
+static void test_long_strings() {
+    // Escapes land on every chunk boundary somewhere in a long string
+    std::string body;
+    for (int i = 0; i < 20000; ++i) {
+        body += i % 7 ? "ab" : "\\n\\\"\\u0001";
+    }
+    std::string text = "{\"" + body + "\": [\"" + body + "\"]}";
+    ValuePtr eager = Parser::parseText(text);
+    ParseOptions options;
+    options.lazyStrings = true;
+    ValuePtr lazy = Parser::parseText(text, options);
+    options.orderedObjectMinSize = 1;
+    ValuePtr ordered = Parser::parseText(text, options);
+    for (const ValuePtr& value : {eager, lazy, ordered}) {
+        const std::string expected = dumped(value);
+        for (size_t cap : {size_t(1), size_t(5), size_t(6), size_t(4096)}) {
+            check(pulled(value, cap) == expected);
+        }
+    }
+
+    // Raw control characters inside a verbatim span are still escaped
+    ValuePtr raw = Parser::parseText(std::string("[\"a\tb\\t\x01\"]"), options);
+    check(pulled(raw, 1) == "[\"a\\tb\\t\\u0001\"]");
+}
+
+static void run_tests() {
+    test_matches_dumper();
+    test_large_interleaved();
+    test_long_strings();
+}
@@ -0,0 +1,104 @@
+#include "parser.hpp"
+#include "simd.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+/* Kernel tables this build has and this CPU can run */
+static std::vector<const SimdKernels*> runnable() {
+    std::vector<const SimdKernels*> tables;
+    for (const SimdKernels* table : {simd::scalarKernels(), simd::sse42Kernels(),
+                                     simd::avx2Kernels(), simd::avx512Kernels()}) {
+        if (table && table->level <= simd::supportedLevel()) {
+            tables.push_back(table);
+        }
+    }
+    return tables;
+}
+
+static void test_kernels_match_scalar() {
+    const SimdKernels& scalar = *simd::scalarKernels();
+    check(scalar.level == SimdLevel::Scalar);
+    // Mostly plain text, with each kind of stop byte now and then
+    const char stops[] = {'"', '\\', '\n', '\r', '\v', '\f', ' ',
+                          '\t', '\x01', '\x1f', '\x80', '\xff', '\x7f'};
+    std::mt19937 random(118);
+    std::vector<char> buffer(300);
+    for (int round = 0; round < 2000; ++round) {
+        for (char& c : buffer) {
+            unsigned r = random() % 64;
+            c = r < sizeof(stops) ? stops[r] : char('a' + r % 26);
+        }
+        if (round % 2) {
+            // Long runs of one class, so whole vectors pass before a stop
+            size_t at = random() % buffer.size();
+            std::fill(buffer.begin(), buffer.begin() + at, round % 4 == 1 ? ' ' : 'x');
+        }
+        size_t offset = random() % 64;
+        size_t size = random() % (buffer.size() - offset);
+        const char* data = buffer.data() + offset;
+        for (const SimdKernels* table : runnable()) {
+            check(table->findQuoteOrBackslash(data, size) == scalar.findQuoteOrBackslash(data, size));
+            check(table->findEscapable(data, size) == scalar.findEscapable(data, size));
+            check(table->asciiPrefix(data, size) == scalar.asciiPrefix(data, size));
+            check(table->whitespacePrefix(data, size) == scalar.whitespacePrefix(data, size));
+        }
+    }
+
+    check(scalar.findQuoteOrBackslash("ab\"c", 4) == 2);
+    check(scalar.findEscapable("ab\x1f" "c", 4) == 2);
+    check(scalar.asciiPrefix("ab\xc3\xa9", 4) == 2);
+    // RFC 8259 whitespace only: \v and \f stop the run
+    check(scalar.whitespacePrefix(" \t\r\n\v\fx", 7) == 4);
+    check(scalar.whitespacePrefix(" \t\r\n\fx", 6) == 4);
+    check(scalar.findEscapable("abc", 3) == 3);
+}
+
+static void test_levels() {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        check(simd::parseLevel(simd::levelName(level)) == level);
+    }
+    check(!simd::parseLevel("mmx"));
+
+    // Requests above the supported level are clamped
+    check(simd::setLevel(SimdLevel::AVX512) == simd::supportedLevel());
+    check(simd::activeLevel() == simd::supportedLevel());
+    check(simd::setLevel(SimdLevel::Scalar) == SimdLevel::Scalar);
+    check(simd::kernels().level == SimdLevel::Scalar);
+}
+
+static void test_parse_and_dump_at_every_level() {
+    std::string text = "{\"long\": \"";
+    for (int i = 0; i < 200; ++i) {
+        text += i % 37 == 0 ? "\\n\\\"\\u00e9" : "abcdefgh";
+    }
+    text += "\", \"ws\":                                                      [1,\n\t\t\t\t\t\t\t\t\t\t\t\t 2],"
+            " \"utf8\": \"\xc3\xa9\xe2\x82\xac plain ascii tail that is long enough to fill a vector\"}";
+
+    simd::setLevel(SimdLevel::Scalar);
+    ValuePtr reference = Parser::parseText(text);
+    const std::string expected = reference->toString();
+    for (const SimdKernels* table : runnable()) {
+        check(simd::setLevel(table->level) == table->level);
+        ValuePtr value = Parser::parseText(text);
+        check(canonical(*value) == canonical(*reference));
+        check(value->toString().size() == expected.size());
+        check(canonical(*Parser::parseText(value->toString())) == canonical(*reference));
+        // Raw control characters are escaped on the way out
+        check(Parser::parseText("[\"tab\there\"]")->toString() == "[\"tab\\there\"]");
+        // Vertical tab and form feed are not JSON whitespace
+        check_throws(JsonErrorCode::InvalidSyntax, Parser::parseText("[1,\v2]"));
+        check_throws(JsonErrorCode::InvalidSyntax, Parser::parseText(std::string(40, ' ') + "\f1"));
+    }
+    simd::setLevel(simd::supportedLevel());
+}
+
+static void run_tests() {
+    test_kernels_match_scalar();
+    test_levels();
+    test_parse_and_dump_at_every_level();
+}
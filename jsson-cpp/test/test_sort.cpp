@@ -0,0 +1,108 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "sort.hpp"
+#include "util.hpp"
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+static ValuePtr record(int64_t seq, ValuePtr key) {
+    JsonObject object;
+    object.keys()["seq"] = makeRef<JsonValue>(seq);
+    if (key) {
+        object.keys()["k"] = std::move(key);
+    }
+    return makeRef<JsonValue>(std::move(object));
+}
+
+static std::vector<int64_t> sequence(const JsonArray& array) {
+    const JsonPointer seq("/seq");
+    std::vector<int64_t> seqs;
+    for (const ValuePtr& element : array.data()) {
+        seqs.push_back(static_cast<int64_t>(seq.resolve(*element)->asNumber()));
+    }
+    return seqs;
+}
+
+static void test_mixed_order() {
+    // One key per rank, listed in reverse of the documented order
+    const char* keys[] = {"{}", "[]", "\"b\"", "\"a\"", "2.5", "2", "-1", "true", "false", "null"};
+    JsonArray array;
+    int64_t seq = 0;
+    for (const char* key : keys) {
+        array.data().push_back(record(seq++, Parser::parseText(key)));
+    }
+    array.data().push_back(record(seq++, nullptr));
+    sortBy(array, JsonPointer("/k"));
+    check((sequence(array) == std::vector<int64_t>{10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0}));
+
+    sortBy(array, JsonPointer("/k"), SortOrder::Descending);
+    check((sequence(array) == std::vector<int64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+}
+
+static void test_exact_numbers() {
+    // Above 2^53 doubles and int64s interleave; a lossy comparison ties them
+    JsonArray array;
+    array.data().push_back(record(0, makeRef<JsonValue>(int64_t(9007199254740993))));
+    array.data().push_back(record(1, makeRef<JsonValue>(9007199254740992.0)));
+    array.data().push_back(record(2, makeRef<JsonValue>(int64_t(9007199254740992))));
+    array.data().push_back(record(3, makeRef<JsonValue>(9223372036854775808.0)));
+    array.data().push_back(record(4, makeRef<JsonValue>(int64_t(INT64_MAX))));
+    array.data().push_back(record(5, makeRef<JsonValue>(-9223372036854775808.0)));
+    array.data().push_back(record(6, makeRef<JsonValue>(int64_t(INT64_MIN))));
+    array.data().push_back(record(7, makeRef<JsonValue>(-0.5)));
+    array.data().push_back(record(8, makeRef<JsonValue>(int64_t(0))));
+    sortBy(array, JsonPointer("/k"));
+    check((sequence(array) == std::vector<int64_t>{5, 6, 7, 8, 1, 2, 0, 4, 3}));
+}
+
+static JsonArray bigArray(size_t size) {
+    JsonArray array;
+    for (size_t i = 0; i < size; ++i) {
+        uint64_t h = i * 0x9E3779B97F4A7C15ull;
+        ValuePtr key;
+        switch (h >> 62) {
+            case 0: key = makeRef<JsonValue>(static_cast<int64_t>(h % 1000)); break;
+            case 1: key = makeRef<JsonValue>(static_cast<double>(h % 1000) / 2); break;
+            case 2: key = makeRef<JsonValue>("s" + std::to_string(h % 500)); break;
+            default: break;
+        }
+        array.data().push_back(record(static_cast<int64_t>(i), key));
+    }
+    return array;
+}
+
+static void test_parallel_matches_serial() {
+    for (SortOrder order : {SortOrder::Ascending, SortOrder::Descending}) {
+        JsonArray serial = bigArray(50000);
+        JsonArray parallel = bigArray(50000);
+        sortBy(serial, JsonPointer("/k"), order, 1);
+        sortBy(parallel, JsonPointer("/k"), order, 8);
+        std::vector<int64_t> expected = sequence(serial);
+        check(sequence(parallel) == expected);
+
+        // Stable: equal keys keep ascending seq in both directions
+        const JsonPointer key("/k");
+        for (size_t i = 1; i < serial.data().size(); ++i) {
+            const JsonValue* a = key.resolve(*serial.data()[i - 1]);
+            const JsonValue* b = key.resolve(*serial.data()[i]);
+            bool same = (!a && !b) || (a && b && a->toString() == b->toString());
+            check(!same || expected[i - 1] < expected[i]);
+        }
+
+        JsonArray source = bigArray(50000);
+        for (size_t k : {size_t(0), size_t(1), size_t(100), size_t(60000)}) {
+            JsonArray top = topK(source, JsonPointer("/k"), k, order, 8);
+            std::vector<int64_t> prefix(expected.begin(), expected.begin() + std::min(k, expected.size()));
+            check(sequence(top) == prefix);
+        }
+        check(sequence(source).front() == 0); // topK leaves its input alone
+    }
+}
+
+static void run_tests() {
+    test_mixed_order();
+    test_exact_numbers();
+    test_parallel_matches_serial();
+}
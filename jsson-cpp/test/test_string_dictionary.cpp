@@ -0,0 +1,82 @@
+#include "parser.hpp"
+#include "string_dictionary.hpp"
+#include "util.hpp"
+#include <string>
+
+using namespace jsson;
+
+static void test_dictionary() {
+    StringDictionary dictionary(false);
+    InternedString a = dictionary.intern("alpha");
+    InternedString b = dictionary.intern(std::string("al") + "pha");
+    check(a.entry == b.entry && a.str() == "alpha");
+    check(dictionary.size() == 1 && dictionary.lookups() == 2 && dictionary.hits() == 1);
+    check(dictionary.find("alpha").entry == a.entry);
+    check(!dictionary.find("beta").entry);
+
+    dictionary.intern("beta");
+    check(dictionary.purge() == 1); // only "alpha" is still referenced
+    check(dictionary.size() == 1);
+    a = b = InternedString();
+    check(dictionary.purge() == 1 && dictionary.size() == 0);
+}
+
+static std::string records(size_t count) {
+    std::string text = "[";
+    for (size_t i = 0; i < count; ++i) {
+        text += i ? ", " : "";
+        text += "{\"status\": \"active\", \"id\": \"id-" + std::to_string(i) + "\"}";
+    }
+    return text + "]";
+}
+
+static void test_parse_interning() {
+    ParseOptions options;
+    options.interning = StringInterning::On;
+    options.dictionary = std::make_shared<StringDictionary>();
+    ValuePtr first = Parser::parseText(records(10), options);
+    ValuePtr second = Parser::parseText("{\"s\": \"active\", \"long\": \"" + std::string(100, 'x') + "\"}",
+                                        options);
+
+    const JsonValue* a = at(*first, "/0/status");
+    const JsonValue* b = at(*first, "/9/status");
+    const JsonValue* c = at(*second, "/s");
+    check(a->isInterned() && c->isInterned());
+    check(a->stringEquals(*b) && a->stringEquals(*c) && a->asString() == "active");
+    check(!a->stringEquals(*at(*first, "/0/id")));
+    check(a->asString() == "active" && a->toString() == "\"active\"");
+
+    // Over maxInternLength: owned
+    check(!at(*second, "/long")->isInterned());
+
+    // Writing detaches from the shared entry
+    JsonValue* mutableA = const_cast<JsonValue*>(a);
+    mutableA->asString() = "changed";
+    check(!mutableA->isInterned() && b->asString() == "active");
+}
+
+static void test_auto() {
+    ParseOptions options;
+    options.interning = StringInterning::Auto;
+    options.internSampleSize = 16;
+    options.internMinRepeatRatio = 0.25;
+
+    // Every "active" after the first repeats (7 of 16 samples): interning stays on
+    ValuePtr repeating = Parser::parseText(records(100), options);
+    check(at(*repeating, "/99/status")->isInterned());
+
+    // All distinct: interning is dropped after the sample
+    std::string distinct = "[";
+    for (int i = 0; i < 100; ++i) {
+        distinct += (i ? ", \"v" : "\"v") + std::to_string(i) + "\"";
+    }
+    ValuePtr unique = Parser::parseText(distinct + "]", options);
+    check(!at(*unique, "/99")->isInterned());
+    check(at(*unique, "/99")->asString() == "v99");
+}
+
+static void run_tests() {
+    test_dictionary();
+    test_parse_interning();
+    test_auto();
+}
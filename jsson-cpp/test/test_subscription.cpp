@@ -0,0 +1,137 @@
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "subscription.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+using Id = SubscriptionIndex::Id;
+
+static std::vector<Id> matches(const SubscriptionIndex& index, const char* path) {
+    std::vector<Id> ids;
+    index.match(JsonPointer(path), ids);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static void test_match() {
+    SubscriptionIndex index;
+    auto none = [](const std::vector<JsonPointer>&) {};
+    Id exact = index.subscribe("/users/1/name", none, false);
+    Id wildcard = index.subscribe("/users/*/name", none, false);
+    Id subtree = index.subscribe("/users/2", none, true);
+    Id everything = index.subscribe("", none, true);
+    check(index.size() == 4);
+
+    check((matches(index, "/users/1/name") == std::vector<Id>{exact, wildcard, everything}));
+    check((matches(index, "/users/2/name") == std::vector<Id>{wildcard, subtree, everything}));
+    // Descendants of watched patterns only notify with watchDescendants
+    check((matches(index, "/users/1/name/first") == std::vector<Id>{everything}));
+    check((matches(index, "/users/2/age") == std::vector<Id>{subtree, everything}));
+    // Replacing an ancestor notifies everything below it
+    check((matches(index, "/users") == std::vector<Id>{exact, wildcard, subtree, everything}));
+    check((matches(index, "/other") == std::vector<Id>{everything}));
+
+    check(index.unsubscribe(wildcard) && !index.unsubscribe(wildcard));
+    check((matches(index, "/users/3/name") == std::vector<Id>{everything}));
+    check(index.size() == 3);
+
+    // Escaped tokens are matched unescaped
+    Id escaped = index.subscribe("/a~1b/~0", none, false);
+    check((matches(index, "/a~1b/~0") == std::vector<Id>{everything, escaped}));
+
+    check_throws(JsonErrorCode::InvalidFormat, index.subscribe("no-slash", none));
+}
+
+static void test_transaction_batches() {
+    SubscriptionIndex index;
+    std::map<std::string, std::vector<std::vector<std::string>>> calls;
+    auto recorder = [&](const char* name) {
+        return [&calls, name](const std::vector<JsonPointer>& changes) {
+            std::vector<std::string> paths;
+            for (const JsonPointer& change : changes) {
+                paths.push_back(change.toString());
+            }
+            calls[name].push_back(paths);
+        };
+    };
+    index.subscribe("/items/*/price", recorder("prices"), false);
+    index.subscribe("/items", recorder("items"), true);
+    index.subscribe("/meta", recorder("meta"), true);
+
+    ValuePtr root = Parser::parseText("{\"items\": [{\"price\": 1}, {\"price\": 2}], \"meta\": {}}");
+    {
+        Transaction transaction(*root, index);
+        transaction.set(JsonPointer("/items/0/price"), makeRef<JsonValue>(5));
+        transaction.set(JsonPointer("/items/1/price"), makeRef<JsonValue>(6));
+        transaction.set(JsonPointer("/items/0/price"), makeRef<JsonValue>(7)); // same path again
+        transaction.append(JsonPointer("/items"), Parser::parseText("{\"price\": 3}"));
+        check(transaction.pending() == 3);
+        check(calls.empty()); // nothing until commit
+    }
+    check(JsonPointer("/items/0/price").resolve(*root)->asNumber() == 7);
+    check(JsonPointer("/items/2/price").resolve(*root)->asNumber() == 3);
+
+    // One call per subscription per batch, with its paths in batch order
+    check(calls["prices"].size() == 1 && calls["items"].size() == 1 && !calls.count("meta"));
+    // The appended element carries a price too, so it concerns "prices"
+    check((calls["prices"][0] ==
+           std::vector<std::string>{"/items/0/price", "/items/1/price", "/items/2"}));
+    check((calls["items"][0] ==
+           std::vector<std::string>{"/items/0/price", "/items/1/price", "/items/2"}));
+
+    Transaction transaction(*root, index);
+    check(transaction.erase(JsonPointer("/items/1")));
+    check(!transaction.erase(JsonPointer("/missing")));
+    transaction.touch(JsonPointer("/meta/x"));
+    check_throws(JsonErrorCode::ItemNotFound, transaction.set(JsonPointer("/nope/x"), ValuePtr()));
+    check_throws(JsonErrorCode::IndexOutOfRange,
+                 transaction.set(JsonPointer("/items/9"), makeRef<JsonValue>(1)));
+    transaction.commit();
+    check(transaction.pending() == 0);
+    check(calls["prices"].size() == 2 && calls["meta"].size() == 1);
+    // Erasing an element shifts the rest, so the whole array is reported
+    check((calls["prices"][1] == std::vector<std::string>{"/items"}));
+    check(JsonPointer("/items/1/price").resolve(*root)->asNumber() == 3);
+}
+
+static void test_pruning() {
+    SubscriptionIndex index;
+    auto none = [](const std::vector<JsonPointer>&) {};
+    Id shared = index.subscribe("/a/b", none);
+    check(index.nodeCount() == 2);
+
+    // Churn over distinct patterns leaves only the nodes still in use
+    for (int i = 0; i < 1000; ++i) {
+        std::string session = "/a/b/sessions/" + std::to_string(i);
+        Id first = index.subscribe(session + "/*/state", none);
+        Id second = index.subscribe(session, none);
+        check(index.unsubscribe(first) && index.unsubscribe(second));
+    }
+    check(index.nodeCount() == 2);
+
+    // A node other patterns pass through, or end at, stays
+    Id deep = index.subscribe("/a/b/c/*", none);
+    Id inner = index.subscribe("/a/b/c", none);
+    check(index.nodeCount() == 4);
+    check(index.unsubscribe(deep) && index.nodeCount() == 3);
+    check((matches(index, "/a/b/c") == std::vector<Id>{shared, inner}));
+    check(index.unsubscribe(shared) && index.nodeCount() == 3);
+    check(index.unsubscribe(inner) && index.nodeCount() == 0);
+    check(matches(index, "/a/b/c").empty());
+
+    // The root itself is never pruned
+    Id root = index.subscribe("", none);
+    check(index.unsubscribe(root) && index.nodeCount() == 0);
+    check(index.subscribe("/x", none) && index.nodeCount() == 1);
+}
+
+static void run_tests() {
+    test_match();
+    test_transaction_batches();
+    test_pruning();
+}
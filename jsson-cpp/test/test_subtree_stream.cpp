@@ -0,0 +1,79 @@
+#include "io.hpp"
+#include "json_pointer.hpp"
+#include "parser.hpp"
+#include "subtree_stream.hpp"
+#include "util.hpp"
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+static const char kDocument[] =
+    "{\"meta\": {\"note\": \"skip ] } \\\" this\", \"items\": [0]},"
+    " \"items\": [{\"id\": 1, \"tags\": [\"a\"]}, {\"id\": 2, \"tags\": []}, 3, \"four\", null],"
+    " \"groups\": {\"x\": {\"items\": [10]}, \"y\": {\"items\": [20, 21]}}}";
+
+/* All matches of @p pattern, with their paths, read @p chunk bytes at a time */
+static std::vector<std::string> matches(std::string_view pattern, size_t chunk,
+                                        std::vector<std::string>* paths = nullptr) {
+    SubtreeStream stream(std::make_unique<MemorySource>(kDocument, sizeof(kDocument) - 1),
+                         pattern, ParseOptions(), chunk);
+    std::vector<std::string> found;
+    for (ValuePtr value; stream.next(value);) {
+        found.push_back(value->toString());
+        if (paths) {
+            paths->push_back(stream.path());
+        }
+    }
+    return found;
+}
+
+static void test_patterns() {
+    // Tiny chunks put every token across a read boundary
+    for (size_t chunk : {size_t(1), size_t(7), SubtreeStream::kDefaultChunkSize}) {
+        std::vector<std::string> paths;
+        std::vector<std::string> items = matches("/items/*", chunk, &paths);
+        check(items.size() == 5);
+        check(items[1] == "{\"id\": 2, \"tags\": []}" || items[1] == "{\"tags\": [], \"id\": 2}");
+        check(items[2] == "3" && items[3] == "\"four\"" && items[4] == "null");
+        check((paths == std::vector<std::string>{"/items/0", "/items/1", "/items/2", "/items/3",
+                                                 "/items/4"}));
+
+        paths.clear();
+        std::vector<std::string> nested = matches("/groups/*/items/*", chunk, &paths);
+        check((nested == std::vector<std::string>{"10", "20", "21"}));
+        check((paths == std::vector<std::string>{"/groups/x/items/0", "/groups/y/items/0",
+                                                 "/groups/y/items/1"}));
+
+        check((matches("/meta/note", chunk) == std::vector<std::string>{"\"skip ] } \\\" this\""}));
+        check(matches("/missing/*", chunk).empty());
+        check(matches("", chunk).size() == 1);
+    }
+}
+
+static void test_offset_and_errors() {
+    std::string text = "[1, 2, 3]";
+    SubtreeStream stream(std::make_unique<MemorySource>(text.data(), text.size()), "/*");
+    check(stream.forEach([](const ValuePtr&) {}) == 3);
+    check(stream.offset() == text.size());
+
+    std::string broken = "{\"items\": [1, {\"a\": ]}";
+    SubtreeStream bad(std::make_unique<MemorySource>(broken.data(), broken.size()), "/items/*");
+    ValuePtr value;
+    check(bad.next(value) && value->toString() == "1");
+    bool threw = false;
+    try {
+        bad.next(value);
+    } catch (const JsonError&) {
+        threw = true;
+    }
+    check(threw);
+
+    check_throws(JsonErrorCode::InvalidFormat,
+                 SubtreeStream(std::make_unique<MemorySource>(text.data(), text.size()), "items"));
+}
+
+static void run_tests() {
+    test_patterns();
+    test_offset_and_errors();
+}
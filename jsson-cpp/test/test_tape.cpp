@@ -0,0 +1,88 @@
+#include "tape.hpp"
+#include "util.hpp"
+#include <string>
+#include <vector>
+
+using namespace jsson;
+
+static void test_scalars() {
+    TapeDocument doc = TapeDocument::parse(
+        "[null, true, false, 42, -7, 2.5, \"text\", \"esc\\n\\u00e9\"]");
+    TapeArray array = doc.root().asArray();
+    check(array.size() == 8);
+    check(array.at(0).isNull());
+    check(array.at(1).asBoolean() && !array.at(2).asBoolean());
+    check(array.at(3).isInteger() && array.at(3).asInt64() == 42);
+    check(array.at(4).asNumber() == -7.0);
+    check(!array.at(5).isInteger() && array.at(5).asNumber() == 2.5);
+    check(array.at(6).asString() == "text");
+    check(array.at(7).asString() == "esc\n\xc3\xa9");
+}
+
+static void test_navigation() {
+    TapeDocument doc = TapeDocument::parse(
+        "{\"a\": {\"deep\": [1, [2, 3], {\"x\": 4}]}, \"b\": [], \"c\": \"last\"}");
+    TapeObject root = doc.root().asObject();
+    check(root.size() == 3);
+
+    std::vector<std::string> keys;
+    for (TapeObject::Member member : root) {
+        keys.emplace_back(member.key);
+    }
+    check((keys == std::vector<std::string>{"a", "b", "c"}));
+
+    // nextSibling skips whole subtrees
+    TapeRef a = root.at("a");
+    check(a.nextSibling().isString() && a.nextSibling().asString() == "b");
+    TapeArray deep = a.asObject().at("deep").asArray();
+    check(deep.size() == 3);
+    check(deep.at(1).asArray().at(1).asInt64() == 3);
+    check(deep.at(2).asObject().at("x").asInt64() == 4);
+
+    check(root.at("b").asArray().empty());
+    check(root.at("c").asString() == "last");
+    check(!root.find_field("missing"));
+    check_throws(JsonErrorCode::ItemNotFound, root.at("missing"));
+}
+
+static void test_wrong_type() {
+    TapeDocument doc = TapeDocument::parse("[\"s\", 1, true]");
+    TapeArray array = doc.root().asArray();
+    check_throws(JsonErrorCode::WrongType, array.at(0).asNumber());
+    check_throws(JsonErrorCode::WrongType, array.at(1).asString());
+    check_throws(JsonErrorCode::WrongType, array.at(2).asInt64());
+
+    // A scalar root is the last value on the tape: nothing may be read past it
+    TapeDocument scalar = TapeDocument::parse("true");
+    check_throws(JsonErrorCode::WrongType, scalar.root().asNumber());
+    check(TapeDocument::parse("12").root().asNumber() == 12.0);
+}
+
+static void test_container_words() {
+    std::string text = "[";
+    for (int i = 0; i < 70000; ++i) {
+        text += i ? ",[1]" : "[1]";
+    }
+    TapeDocument doc = TapeDocument::parse(text + ", {\"k\": 2}]");
+    TapeArray array = doc.root().asArray();
+    check(array.size() == 70001);
+    check(array.at(70000).asObject().size() == 1);
+
+    // The start word points past the end word, which holds the count
+    uint64_t start = doc.word(doc.root().index()) & TapeDocument::kPayloadMask;
+    check(start == doc.tapeSize() - 1);
+    check((doc.word(start - 1) & TapeDocument::kPayloadMask) == 70001);
+}
+
+static void test_invalid() {
+    check_throws(JsonErrorCode::PrematureEndOfInput, TapeDocument::parse("[1, 2"));
+    check_throws(JsonErrorCode::InvalidSyntax, TapeDocument::parse("{\"a\" 1}"));
+}
+
+static void run_tests() {
+    test_scalars();
+    test_navigation();
+    test_wrong_type();
+    test_container_words();
+    test_invalid();
+}
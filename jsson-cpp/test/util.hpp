@@ -0,0 +1,116 @@
+#ifndef JSSON_TEST_UTIL_HPP
+#define JSSON_TEST_UTIL_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "error.hpp"
+#include "json_value.hpp"
+
+#define failhdr std::cerr << __FILE__ << ":" << __LINE__ << ": "
+
+#define fail(msg)                                                                        \
+    do {                                                                                 \
+        failhdr << msg << std::endl;                                                     \
+        std::exit(1);                                                                    \
+    } while (0)
+
+#define check(cond_)                                                                     \
+    do {                                                                                 \
+        if (!(cond_)) {                                                                  \
+            fail("check failed: " #cond_);                                               \
+        }                                                                                \
+    } while (0)
+
+/* Expects expr_ to throw JsonError with code code_ */
+#define check_throws(code_, expr_)                                                       \
+    do {                                                                                 \
+        try {                                                                            \
+            expr_;                                                                       \
+        } catch (const jsson::JsonError& e_) {                                           \
+            if (e_.code().value() != static_cast<int>(code_)) {                          \
+                failhdr << "code: " << e_.code().value() << " != "                       \
+                        << static_cast<int>(code_) << " (" << e_.what() << ")"           \
+                        << std::endl;                                                    \
+                std::exit(1);                                                            \
+            }                                                                            \
+            break;                                                                       \
+        }                                                                                \
+        fail("no exception from " #expr_);                                               \
+    } while (0)
+
+/* Resolve a "/"-separated path of member names and array indices; nullptr if absent */
+inline const jsson::JsonValue* at(const jsson::JsonValue& root, const std::string& path) {
+    const jsson::JsonValue* value = &root;
+    size_t pos = 0;
+    while (value && pos < path.size()) {
+        size_t end = path.find('/', pos + 1);
+        std::string token = path.substr(pos + 1, end == std::string::npos ? end : end - pos - 1);
+        pos = end == std::string::npos ? path.size() : end;
+        const auto& data = value->raw_variant();
+        value = nullptr;
+        if (auto object = std::get_if<std::unique_ptr<jsson::JsonObject>>(&data)) {
+            auto found = (*object)->keys().find(token);
+            if (found != (*object)->keys().end()) {
+                value = found->second.get();
+            }
+        } else if (auto array = std::get_if<std::unique_ptr<jsson::JsonArray>>(&data)) {
+            size_t index = std::stoul(token);
+            if (index < (*array)->data().size()) {
+                value = (*array)->data()[index].get();
+            }
+        }
+    }
+    return value;
+}
+
+/* Dump of @p value with object members sorted by key, for comparing trees */
+inline std::string canonical(const jsson::JsonValue& value) {
+    using namespace jsson;
+    const auto& data = value.raw_variant();
+    if (auto array = std::get_if<std::unique_ptr<JsonArray>>(&data)) {
+        std::string out = "[";
+        for (const ValuePtr& element : (*array)->data()) {
+            out += out.size() > 1 ? "," : "";
+            out += canonical(*element);
+        }
+        return out + "]";
+    }
+    std::vector<std::pair<std::string, std::string>> members;
+    if (auto object = std::get_if<std::unique_ptr<JsonObject>>(&data)) {
+        for (const auto& member : (*object)->keys()) {
+            members.emplace_back(JsonValue(member.first).toString(), canonical(*member.second));
+        }
+    } else if (auto ordered = std::get_if<std::unique_ptr<OrderedObject>>(&data)) {
+        for (auto it = (*ordered)->begin(); it != (*ordered)->end(); ++it) {
+            members.emplace_back(JsonValue(std::string(it.key())).toString(), canonical(*it.value()));
+        }
+    } else {
+        return value.toString();
+    }
+    std::sort(members.begin(), members.end());
+    std::string out = "{";
+    for (const auto& member : members) {
+        out += out.size() > 1 ? "," : "";
+        out += member.first + ":" + member.second;
+    }
+    return out + "}";
+}
+
+static void run_tests();
+
+int main() {
+    try {
+        run_tests();
+    } catch (const std::exception& e) {
+        std::cerr << "uncaught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#endif